@@ -0,0 +1,316 @@
+/**
+ * @file AsyncSnapshotWriter.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements AsyncSnapshotWriter: a class that writes binary snapshot files
+ * on a background thread.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef ASYNCSNAPSHOTWRITER_H
+#define ASYNCSNAPSHOTWRITER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include "SnapshotWriter.h"
+
+/**
+ * @brief What AsyncSnapshotWriter does with a new frame when its queue is full.
+ * 
+ */
+enum class BackpressurePolicy {
+    /**
+     * @brief Wait until the background thread has written a frame.
+     * 
+     */
+    Block,
+
+    /**
+     * @brief Discard the new frame.
+     * 
+     */
+    Drop
+};
+
+/**
+ * @brief Struct describing a frame queued by AsyncSnapshotWriter.
+ * 
+ */
+struct QueuedSnapshotFrame {
+
+    /**
+     * @brief Values of every field, in the order of the header.
+     * 
+     */
+    std::vector<double> values;
+
+    /**
+     * @brief Id of each particle, empty if the file stores no ids.
+     * 
+     */
+    std::vector<uint64_t> ids;
+
+    /**
+     * @brief Number of particles on the frame.
+     * 
+     */
+    size_t particles = 0;
+};
+
+/**
+ * @brief This class writes the frames of a SnapshotWriter on a background thread.
+ * 
+ * writeFrame() copies the frame into a ring buffer of queueDepth slots and returns, while
+ * the background thread serializes the queued frames, in order, and writes them to the file.
+ * The destructor writes every queued frame and flushes the file before returning.
+ * 
+ */
+class AsyncSnapshotWriter {
+public:
+
+    /**
+     * @brief Construct a new AsyncSnapshotWriter object and start its background thread.
+     * 
+     * @param writer: The writer that the frames are written to. Must not be used by anyone
+     * else while this object exists.
+     * @param queueDepth: Number of frames that can wait to be written.
+     * @param policy: What to do with a new frame when the queue is full.
+     */
+    AsyncSnapshotWriter(SnapshotWriterPtr writer, int queueDepth,
+        BackpressurePolicy policy = BackpressurePolicy::Block) {
+        this->writer = writer;
+        this->policy = policy;
+        this->slots = std::vector<QueuedSnapshotFrame>(queueDepth < 1 ? 1 : queueDepth);
+        this->thread = std::thread(&AsyncSnapshotWriter::run, this);
+    }
+
+    /**
+     * @brief Destructor for the AsyncSnapshotWriter class. Writes every queued frame and
+     * flushes the file.
+     * 
+     */
+    ~AsyncSnapshotWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_one();
+        thread.join();
+        writer->flush();
+    }
+
+    AsyncSnapshotWriter(const AsyncSnapshotWriter&) = delete;
+    AsyncSnapshotWriter& operator=(const AsyncSnapshotWriter&) = delete;
+
+    /**
+     * @brief Queues one frame of the number of particles given to the writer, to a file that
+     * stores no ids.
+     * 
+     * @param values: One array per field, in the order of the header, each holding
+     * numberOfParticles * components values laid out particle by particle. The values are
+     * copied before this returns.
+     * @return true if the frame was queued.
+     * @return false if it was dropped because the queue was full.
+     */
+    bool writeFrame(const std::vector<const double *>& values) {
+        return writeFrame(values, writer->getNumberOfParticles(), nullptr);
+    }
+
+    /**
+     * @brief Queues one frame to be written.
+     * 
+     * @param values: One array per field, in the order of the header, each holding
+     * particles * components values laid out particle by particle.
+     * @param particles: Number of particles on the frame.
+     * @param ids: Id of each particle, required if the file stores ids and ignored otherwise.
+     * The values and the ids are copied before this returns.
+     * @return true if the frame was queued.
+     * @return false if it was dropped because the queue was full.
+     */
+    bool writeFrame(const std::vector<const double *>& values, size_t particles, const uint64_t *ids) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (count == slots.size()) {
+            if (policy == BackpressurePolicy::Drop) {
+                droppedFrames++;
+                return false;
+            }
+            written.wait(lock, [this] { return count < slots.size(); });
+        }
+
+        // The slot is not visible to the background thread until count is increased.
+        QueuedSnapshotFrame& slot = slots[(head + count) % slots.size()];
+        size_t offset = 0;
+
+        slot.particles = particles;
+        for (size_t field = 0; field < values.size(); field++) {
+            const size_t size = getFieldSize(field, particles);
+            slot.values.resize(offset + size);
+            std::memcpy(slot.values.data() + offset, values[field], size * sizeof(double));
+            offset += size;
+        }
+
+        if (writer->storesIds() && ids) {
+            slot.ids.assign(ids, ids + particles);
+        } else {
+            slot.ids.clear();
+        }
+
+        count++;
+        lock.unlock();
+        queued.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Waits until every queued frame was written and flushes the file.
+     * 
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        written.wait(lock, [this] { return count == 0; });
+        writer->flush();
+    }
+
+    /**
+     * @brief Number of frames dropped because the queue was full.
+     * 
+     * @return size_t representing the number of dropped frames.
+     */
+    size_t getDroppedFrames() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return droppedFrames;
+    }
+
+protected:
+
+    /**
+     * @brief The writer that the frames are written to.
+     * 
+     */
+    SnapshotWriterPtr writer;
+
+    /**
+     * @brief What to do with a new frame when the queue is full.
+     * 
+     */
+    BackpressurePolicy policy;
+
+    /**
+     * @brief Ring buffer of queued frames.
+     * 
+     */
+    std::vector<QueuedSnapshotFrame> slots;
+
+    /**
+     * @brief Slot of the oldest queued frame.
+     * 
+     */
+    size_t head = 0;
+
+    /**
+     * @brief Number of queued frames, including the one being written.
+     * 
+     */
+    size_t count = 0;
+
+    /**
+     * @brief Number of frames dropped because the queue was full.
+     * 
+     */
+    size_t droppedFrames = 0;
+
+    /**
+     * @brief If true, the background thread writes the queued frames and stops.
+     * 
+     */
+    bool stopping = false;
+
+    /**
+     * @brief Guards the ring buffer.
+     * 
+     */
+    std::mutex mutex;
+
+    /**
+     * @brief Signaled when a frame is queued or the writer is stopping.
+     * 
+     */
+    std::condition_variable queued;
+
+    /**
+     * @brief Signaled when a frame was written.
+     * 
+     */
+    std::condition_variable written;
+
+    /**
+     * @brief The background thread.
+     * 
+     */
+    std::thread thread;
+
+    /**
+     * @brief Number of values of a field on one frame.
+     * 
+     * @param field: Index of the field.
+     * @param particles: Number of particles on the frame.
+     * @return size_t representing the number of values.
+     */
+    size_t getFieldSize(size_t field, size_t particles) const {
+        return particles * writer->getFields()[field].components;
+    }
+
+    /**
+     * @brief Loop of the background thread.
+     * 
+     */
+    void run() {
+        std::vector<const double *> values;
+
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [this] { return count > 0 || stopping; });
+
+            if (count == 0) {
+                return;
+            }
+
+            // The oldest slot stays counted while it is written, so it is never overwritten.
+            const QueuedSnapshotFrame& slot = slots[head];
+            lock.unlock();
+
+            size_t offset = 0;
+            values.resize(writer->getFields().size());
+
+            for (size_t field = 0; field < values.size(); field++) {
+                values[field] = slot.values.data() + offset;
+                offset += getFieldSize(field, slot.particles);
+            }
+
+            writer->writeFrame(values, slot.particles, slot.ids.empty() ? nullptr : slot.ids.data());
+
+            lock.lock();
+            head = (head + 1) % slots.size();
+            count--;
+            lock.unlock();
+            written.notify_all();
+        }
+    }
+};
+
+/**
+ * @brief std::shared_ptr to the AsyncSnapshotWriter class.
+ * 
+ */
+typedef std::shared_ptr<AsyncSnapshotWriter> AsyncSnapshotWriterPtr;
+
+#endif // ASYNCSNAPSHOTWRITER_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+/**
+ * @file BinarySerialization.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements helpers to write and read values to binary streams.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef BINARYSERIALIZATION_H
+#define BINARYSERIALIZATION_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Writes a trivially copyable value to a binary stream, in native byte order. Structs
+ * are written field by field instead, so their padding bytes never reach the stream.
+ * 
+ * @tparam T: type of the value.
+ * @param stream: The stream to write to.
+ * @param value: The value to be written.
+ */
+template<typename T>
+inline void writeBinary(std::ostream& stream, const T& value) {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/**
+ * @brief Writes a list of trivially copyable values to a binary stream, preceded by its size.
+ * 
+ * @tparam T: type of the values.
+ * @param stream: The stream to write to.
+ * @param values: The list to be written.
+ */
+template<typename T>
+inline void writeBinary(std::ostream& stream, const std::vector<T>& values) {
+    writeBinary(stream, static_cast<uint64_t>(values.size()));
+    stream.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+/**
+ * @brief Writes a string to a binary stream, preceded by its size.
+ * 
+ * @param stream: The stream to write to.
+ * @param value: The string to be written.
+ */
+inline void writeBinary(std::ostream& stream, const std::string& value) {
+    writeBinary(stream, static_cast<uint64_t>(value.size()));
+    stream.write(value.data(), value.size());
+}
+
+/**
+ * @brief Reads a trivially copyable value from a binary stream.
+ * 
+ * @tparam T: type of the value.
+ * @param stream: The stream to read from.
+ * @param value: The value that will be read.
+ * @return true if the value was read.
+ * @return false otherwise.
+ */
+template<typename T>
+inline bool readBinary(std::istream& stream, T& value) {
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+/**
+ * @brief Reads a list of trivially copyable values, written by writeBinary, from a binary stream.
+ * 
+ * @tparam T: type of the values.
+ * @param stream: The stream to read from.
+ * @param values: The list that will be read.
+ * @param maxSize: Largest size accepted, so a corrupt size is rejected before it is allocated.
+ * @return true if the list was read.
+ * @return false otherwise.
+ */
+template<typename T>
+inline bool readBinary(std::istream& stream, std::vector<T>& values, uint64_t maxSize = UINT64_MAX) {
+    uint64_t size;
+    if (!readBinary(stream, size) || size > maxSize) {
+        return false;
+    }
+    values.resize(size);
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(values.data()), size * sizeof(T)));
+}
+
+/**
+ * @brief Reads a string, written by writeBinary, from a binary stream.
+ * 
+ * @param stream: The stream to read from.
+ * @param value: The string that will be read.
+ * @param maxSize: Largest size accepted, so a corrupt size is rejected before it is allocated.
+ * @return true if the string was read.
+ * @return false otherwise.
+ */
+inline bool readBinary(std::istream& stream, std::string& value, uint64_t maxSize = UINT64_MAX) {
+    uint64_t size;
+    if (!readBinary(stream, size) || size > maxSize) {
+        return false;
+    }
+    value.resize(size);
+    return static_cast<bool>(stream.read(&value[0], size));
+}
+
+#endif // BINARYSERIALIZATION_H
\ No newline at end of file
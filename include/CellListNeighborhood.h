@@ -0,0 +1,305 @@
+/**
+ * @file CellListNeighborhood.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the compact Cell List Neighborhood for 2D and 3D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef CELLLISTNEIGHBORHOOD_H
+#define CELLLISTNEIGHBORHOOD_H
+
+#include <vector>
+#include <memory>
+#include <eigen3/Eigen/Dense>
+#include "ParticleNeighborhood2D.h"
+
+/**
+ * @brief Class describing a compact cell list neighborhood, templated on the number of
+ * spatial dimensions.
+ * 
+ * The particles are bucketed into cells with a counting sort: the number of particles on each
+ * cell is counted, a prefix sum over the counts gives where each cell starts, and the particle
+ * indices are then stored contiguously per cell, in increasing index order. Every step works on
+ * fixed chunks of particles, so the build is parallel, race free and its result does not depend
+ * on the number of threads. Neighbor lists are stored on one flat buffer with a fixed number of
+ * slots per particle.
+ * 
+ * The query visits the 3^Dimension cells around the cell of each particle, 9 in 2D and 27 in
+ * 3D, through offsets on the linear cell index computed once per grid resolution. The methods
+ * are not virtual, so the solver steps templated on the neighborhood inline getNeighbors.
+ * 
+ * @tparam Dimension: number of spatial dimensions, 2 or 3.
+ */
+template <int Dimension>
+class CellListNeighborhoodT {
+public:
+
+    /**
+     * @brief Vector of the particle positions.
+     * 
+     */
+    typedef Eigen::Matrix<double, Dimension, 1> Vector;
+
+    /**
+     * @brief View over the neighbors of a particle. It holds no coordinates, so the 2D
+     * struct serves every dimension.
+     * 
+     */
+    typedef NeighborList2D NeighborList;
+
+    /**
+     * @brief Default constructor for the CellListNeighborhoodT class.
+     * 
+     */
+    CellListNeighborhoodT();
+
+    /**
+     * @brief Destructor for the CellListNeighborhoodT class.
+     * 
+     */
+    ~CellListNeighborhoodT();
+
+    /**
+     * @brief Set the resolution of the grid.
+     * 
+     * @param size: Size of the grid on each dimension.
+     * @param kernelRadius: Kernel radius.
+     */
+    void setGridResolution(const Vector& size, double kernelRadius);
+
+    /**
+     * @brief Get a view over the neighbors of the given particle, valid until the next build.
+     * 
+     * @param origin: Index of the particle.
+     * @return NeighborList representing the neighbors of the particle.
+     */
+    NeighborList getNeighbors(const int origin) const {
+        return NeighborList{&_neighbors[(size_t) origin * _maxNeighbors],
+            &_distances[(size_t) origin * _maxNeighbors], _numNeighbors[origin]};
+    }
+
+    /**
+     * @brief Loop through all neighbor particles of the given particle, invoking callback on
+     * each neighbor. The callback is a template parameter, so it is inlined.
+     * 
+     * @tparam Callback: callable taking the neighbor index and its distance.
+     * @param origin: Index of the particle.
+     * @param callback: Callback invoked on each neighbor.
+     */
+    template <typename Callback>
+    void forEachNeighbor(const int origin, const Callback& callback) const {
+        const NeighborList neighbors = getNeighbors(origin);
+
+        for (int k = 0; k < neighbors.size; k++) {
+            callback(neighbors.indices[k], neighbors.distances[k]);
+        }
+    }
+
+    /**
+     * @brief Builds the neighorhood's iternal structure.
+     * 
+     * @param points: array of all points that will be part of the neighborhood.
+     */
+    void build(const std::vector<Vector>& points);
+
+    /**
+     * @brief Get the Distances of a particle to it's neighbors.
+     * 
+     * @param index: index of the particle to get the distances of.
+     * @return std::vector<double> represeting the list of distances.
+     */
+    std::vector<double> getDistances(int index) const;
+
+    /**
+     * @brief Enables or disables sorting each neighborhood by particle index after a build.
+     * Sorted neighborhoods are visited in the same order as an all-pairs loop.
+     * 
+     * @param sortByIndex: true to sort the neighborhoods by particle index.
+     */
+    void setSortByIndex(bool sortByIndex);
+
+    /**
+     * @brief Enables or disables half neighbor lists, where each pair of particles is
+     * stored once, on the neighborhood of the particle with the lowest index.
+     * 
+     * @param halfNeighborList: true to store each pair once.
+     */
+    void setHalfNeighborList(bool halfNeighborList);
+
+    /**
+     * @brief Checks if each pair of particles is stored once.
+     * 
+     * @return true if the neighborhood stores half neighbor lists.
+     * @return false if each pair is stored on the neighborhoods of both particles.
+     */
+    bool isHalfNeighborList() const;
+
+    /**
+     * @brief Get the number of particles whose neighborhood exceeded its slots on the
+     * last build. Only counted when built with SPH_INSTRUMENTATION.
+     * 
+     * @return size_t representing the number of truncated neighborhoods.
+     */
+    size_t getTruncatedCount() const;
+
+    /**
+     * @brief Set the number of neighbors stored for each particle, starting on the next
+     * build.
+     * 
+     * @param maxNeighbors: The number of neighbor slots of each particle.
+     */
+    void setMaxNeighbors(int maxNeighbors);
+
+    /**
+     * @brief Get the number of neighbors stored for each particle.
+     * 
+     * @return int representing the number of neighbor slots of each particle.
+     */
+    int getMaxNeighbors() const;
+
+    /**
+     * @brief Default number of neighbors stored for a particle. The 3D query covers a sphere
+     * instead of a disk, so it gets twice the slots.
+     * 
+     */
+    const static int MAX_NEIGHBORS = Dimension == 2 ? 64 : 128;
+
+private:
+
+    /**
+     * @brief Cell of each particle.
+     * 
+     */
+    std::vector<int> _particleCells;
+
+    /**
+     * @brief Index where each cell starts on _cellParticles. Has one entry more than the
+     * number of cells, so the particles of cell c are in [_cellStart[c], _cellStart[c + 1]).
+     * 
+     */
+    std::vector<int> _cellStart;
+
+    /**
+     * @brief Number of particles on each cell.
+     * 
+     */
+    std::vector<int> _cellCounts;
+
+    /**
+     * @brief Particle indices stored contiguously per cell.
+     * 
+     */
+    std::vector<int> _cellParticles;
+
+    /**
+     * @brief Number of particles of each chunk on each cell, laid out chunk by chunk. After
+     * the prefix sum it holds where each chunk writes its particles inside each cell.
+     * 
+     */
+    std::vector<int> _chunkCounts;
+
+    /**
+     * @brief Offset of each cell visited by the query from the cell of the particle, on the
+     * linear cell index. The first dimension varies slowest and the last one fastest.
+     * 
+     */
+    std::vector<int> _neighborCellOffsets;
+
+    /**
+     * @brief Number of neighbor slots of each particle.
+     * 
+     */
+    int _maxNeighbors = MAX_NEIGHBORS;
+
+    /**
+     * @brief Neighbor indices, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<int> _neighbors;
+
+    /**
+     * @brief Distance to each neighbor, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<double> _distances;
+
+    /**
+     * @brief Number of neighbors of each particle.
+     * 
+     */
+    std::vector<int> _numNeighbors;
+
+    /**
+     * @brief Number of cells of the grid on each dimension.
+     * 
+     */
+    int _cells[Dimension];
+
+    /**
+     * @brief Step of the linear cell index along each dimension.
+     * 
+     */
+    int _strides[Dimension];
+
+    /**
+     * @brief The cize of each grid cell.
+     * 
+     */
+    double _cellSize = 1.0;
+
+    /**
+     * @brief Number of cells on the grid.
+     * 
+     */
+    int _numCells = 0;
+
+    /**
+     * @brief If true, each neighborhood is sorted by particle index after a build.
+     * 
+     */
+    bool _sortByIndex = false;
+
+    /**
+     * @brief If true, each pair of particles is stored once.
+     * 
+     */
+    bool _halfNeighborList = false;
+
+    /**
+     * @brief Number of truncated neighborhoods on the last build.
+     * 
+     */
+    size_t _truncatedCount = 0;
+
+    /**
+     * @brief Buckets the particles into the cells with a counting sort.
+     * 
+     * @param points: array of all points that will be part of the neighborhood.
+     */
+    void sortIntoCells(const std::vector<Vector>& points);
+
+    /**
+     * @brief Sorts the neighbors of a particle by particle index.
+     * 
+     * @param index: Index of the particle.
+     */
+    void sortNeighborhood(int index);
+};
+
+/**
+ * @brief Compact cell list neighborhood for 3D particle systems.
+ * 
+ */
+typedef CellListNeighborhoodT<3> CellListNeighborhood3D;
+
+/**
+ * @brief std::shared_ptr to the CellListNeighborhood3D class.
+ * 
+ */
+typedef std::shared_ptr<CellListNeighborhood3D> CellListNeighborhood3DPtr;
+
+#endif
\ No newline at end of file
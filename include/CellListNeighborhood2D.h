@@ -0,0 +1,146 @@
+/**
+ * @file CellListNeighborhood2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the compact Cell List Neighborhood for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef CELLLISTNEIGHBORHOOD2D_H
+#define CELLLISTNEIGHBORHOOD2D_H
+
+#include <vector>
+#include <memory>
+#include <eigen3/Eigen/Dense>
+#include "ParticleNeighborhood2D.h"
+#include "CellListNeighborhood.h"
+
+/**
+ * @brief Class describing a compact cell list neighborhood for 2D particle systems. It exposes
+ * CellListNeighborhoodT<2>, which holds the counting sort and the query, through the
+ * ParticleNeighborhood2D interface used by the 2D solvers.
+ * 
+ */
+class CellListNeighborhood2D: public ParticleNeighborhood2D {
+public:
+
+    /**
+     * @brief Default constructor for the CellListNeighborhood2D class.
+     * 
+     */
+    CellListNeighborhood2D();
+
+    /**
+     * @brief Destructor for the CellListNeighborhood2D class.
+     * 
+     */
+    ~CellListNeighborhood2D();
+
+    /**
+     * @brief Set the resolution of the grid.
+     * 
+     * @param width: Width of the grid.
+     * @param height: Height of the grid.
+     * @param kernelRadius: Kernel radius.
+     */
+    void setGridResolution(int width, int height, double kernelRadius) override;
+
+    /**
+	 * @brief Loop through all neighbor particles of the given particle,
+	 * invoking a call to callback on each neighbor.
+	 * 
+	 * @param origin: Index of the particle that will have it's neighborhood
+	 * looped through.
+	 * @param callback: Callback function to be invoked on each neighbor.
+	 */
+    void forEachNearbyPoint(
+		const int origin,
+		const ForEachNearbyPointFunc& callback) const override;
+
+    /**
+     * @brief Get a view over the neighbors of the given particle, valid until the next build.
+     * 
+     * @param origin: Index of the particle.
+     * @return NeighborList2D representing the neighbors of the particle.
+     */
+    NeighborList2D getNeighbors(const int origin) const override;
+
+    /**
+	 * @brief Builds the neighorhood's iternal structure.
+	 * 
+	 * @param points: array of all points that will be part of the neighborhood.
+	 */
+	void build(const std::vector<Eigen::Vector2d>& points) override;
+
+    /**
+	 * @brief Get the Distances of a particle to it's neighbors.
+	 * 
+	 * @param index: index of the particle to get the distances of.
+	 * @return std::vector<double> represeting the list of distances.
+	 */
+    std::vector<double> getDistances(int index) override;
+
+    /**
+     * @brief Enables or disables sorting each neighborhood by particle index after a build.
+     * Sorted neighborhoods are visited in the same order as an all-pairs loop.
+     * 
+     * @param sortByIndex: true to sort the neighborhoods by particle index.
+     */
+    void setSortByIndex(bool sortByIndex) override;
+
+    /**
+     * @brief Enables or disables half neighbor lists, where each pair of particles is
+     * stored once, on the neighborhood of the particle with the lowest index.
+     * 
+     * @param halfNeighborList: true to store each pair once.
+     */
+    void setHalfNeighborList(bool halfNeighborList) override;
+
+    /**
+     * @brief Checks if each pair of particles is stored once.
+     * 
+     * @return true if the neighborhood stores half neighbor lists.
+     * @return false if each pair is stored on the neighborhoods of both particles.
+     */
+    bool isHalfNeighborList() const override;
+
+    /**
+     * @brief Set the number of neighbors stored for each particle, starting on the next
+     * build.
+     * 
+     * @param maxNeighbors: The number of neighbor slots of each particle.
+     */
+    void setMaxNeighbors(int maxNeighbors) override;
+
+    /**
+     * @brief Get the number of neighbors stored for each particle.
+     * 
+     * @return int representing the number of neighbor slots of each particle.
+     */
+    int getMaxNeighbors() const override;
+
+    /**
+     * @brief Default number of neighbors stored for a particle.
+     * 
+     */
+    const static int MAX_NEIGHBORS = CellListNeighborhoodT<2>::MAX_NEIGHBORS;
+
+private:
+
+    /**
+     * @brief The cell list all calls are forwarded to.
+     * 
+     */
+    CellListNeighborhoodT<2> _cellList;
+};
+
+/**
+ * @brief std::shared_ptr to the CellListNeighborhood2D class.
+ * 
+ */
+typedef std::shared_ptr<CellListNeighborhood2D> CellListNeighborhood2DPtr;
+
+#endif
\ No newline at end of file
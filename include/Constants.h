@@ -21,6 +21,12 @@
  */
 const static Eigen::Vector2d G2D(0.0, -9.8);
 
+/**
+ * @brief Gravity in 3D, with y pointing up as in 2D.
+ * 
+ */
+const static Eigen::Vector3d G3D(0.0, -9.8, 0.0);
+
 /**
  * @brief Rest density of the system.
  * 
@@ -39,12 +45,6 @@ const static double ELASTIC_REST_DENSITY = 45.0;
  */
 const static double GAS_CONSTANT = 2000.0;
 
-/**
- * @brief Maximum number of particles in the system.
- * 
- */
-const static int MAX_PARTICLES2D = 75*75;
-
 /**
  * @brief Mass of a particle.
  * 
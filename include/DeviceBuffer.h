@@ -0,0 +1,148 @@
+/**
+ * @file DeviceBuffer.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements DeviceBuffer: an array allocated on an OpenMP offload device.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef DEVICEBUFFER_H
+#define DEVICEBUFFER_H
+
+#include <cstddef>
+#include <omp.h>
+
+/**
+ * @brief Class that owns an array on an OpenMP offload device, allocated with
+ * omp_target_alloc. Its pointer is only valid inside target regions of the same device, passed
+ * with is_device_ptr, and the values are copied with upload and download. On the host device,
+ * which runs the target regions when no accelerator is available, the array lives on the host.
+ * 
+ * @tparam T: type of the values.
+ */
+template <typename T>
+class DeviceBuffer {
+public:
+
+    /**
+     * @brief Construct a new, empty DeviceBuffer object.
+     * 
+     */
+    DeviceBuffer() { }
+
+    /**
+     * @brief Destructor for DeviceBuffer, which frees the array.
+     * 
+     */
+    ~DeviceBuffer() {
+        release();
+    }
+
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+    /**
+     * @brief Resizes the array to hold size values on a device. The values are lost, and the
+     * array is only reallocated when it grows or moves to another device.
+     * 
+     * @param size: Number of values.
+     * @param device: Number of the device, as given by omp_get_default_device().
+     */
+    void resize(size_t size, int device) {
+        if (size > _capacity || device != _device) {
+            release();
+            _data = static_cast<T *>(omp_target_alloc(size * sizeof(T), device));
+            _capacity = size;
+            _device = device;
+        }
+
+        _size = size;
+    }
+
+    /**
+     * @brief Copies values from the host to the start of the array.
+     * 
+     * @param values: The values on the host.
+     * @param count: Number of values, at most the size of the array.
+     */
+    void upload(const T *values, size_t count) {
+        if (count > 0) {
+            omp_target_memcpy(_data, values, count * sizeof(T), 0, 0, _device, omp_get_initial_device());
+        }
+    }
+
+    /**
+     * @brief Copies values from the start of the array to the host.
+     * 
+     * @param values: Receives the values on the host.
+     * @param count: Number of values, at most the size of the array.
+     */
+    void download(T *values, size_t count) const {
+        if (count > 0) {
+            omp_target_memcpy(values, _data, count * sizeof(T), 0, 0, omp_get_initial_device(), _device);
+        }
+    }
+
+    /**
+     * @brief Get the array on the device.
+     * 
+     * @return T* pointing to the first value, only valid on the device.
+     */
+    T* data() {
+        return _data;
+    }
+
+    /**
+     * @brief Get the number of values of the array.
+     * 
+     * @return size_t representing the number of values.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+private:
+
+    /**
+     * @brief The array on the device.
+     * 
+     */
+    T *_data = nullptr;
+
+    /**
+     * @brief Number of values of the array.
+     * 
+     */
+    size_t _size = 0;
+
+    /**
+     * @brief Number of values allocated.
+     * 
+     */
+    size_t _capacity = 0;
+
+    /**
+     * @brief Device of the array, -1 before the first allocation.
+     * 
+     */
+    int _device = -1;
+
+    /**
+     * @brief Frees the array.
+     * 
+     */
+    void release() {
+        if (_data != nullptr) {
+            omp_target_free(_data, _device);
+        }
+
+        _data = nullptr;
+        _capacity = 0;
+        _size = 0;
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,365 @@
+/**
+ * @file DeviceVSphSolver2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the Viscoelastic SPH solver for 2D systems that runs its solver steps on
+ * an OpenMP offload device.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef DEVICEVSPHSOLVER2D_H
+#define DEVICEVSPHSOLVER2D_H
+
+#include "VSphSolver2D.h"
+#include "DeviceBuffer.h"
+#include <eigen3/Eigen/Dense>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Class that implements the Viscoelastic SPH solver for 2D systems on an OpenMP offload
+ * device, such as a GPU when the compiler is configured for it (-foffload with GCC,
+ * -fopenmp-targets with Clang). Without an offload device the same kernels run on the host.
+ * 
+ * The positions, velocities and every per-step attribute stay resident on the device across
+ * solver steps and updates. Each step runs the external forces, integration, neighborhood
+ * build, densities, projection, correction and boundaries as device kernels. The grid is
+ * built on the device with a counting sort of the particles by cell, and the neighbors are
+ * visited in the order of GridNeighborhood2D, so the results match VSphSolver2D.
+ * 
+ * Positions are only copied back to the host when getPositions is called, such as by the
+ * renderer, and every attribute is copied back when the update writes the output file or
+ * synchronize is called. Emitters, sinks and spatial sorts run on the host, so the updates
+ * that run them copy the particles back and forth; with a reorder interval, only the updates
+ * that sort do. Symmetric pairs and colliders are rejected by their setters, since the device
+ * kernels visit full neighbor lists and only apply the walls, and the instrumentation only
+ * records the timings and step counts.
+ * 
+ */
+class DeviceVSphSolver2D : public VSphSolver2D
+{
+public:
+
+    /**
+     * @brief Construct a new DeviceVSphSolver2D object with a given number of particles, on
+     * the default offload device.
+     * 
+     * @param numberOfParticles: Number of particles to added to the system.
+     * @param fileName: Name of the file to write the simulation data to. Empty to disable writing.
+     */
+    DeviceVSphSolver2D(int numberOfParticles, std::string fileName = "");
+
+    /**
+     * @brief Destructor for DeviceVSphSolver2D.
+     * 
+     */
+    ~DeviceVSphSolver2D();
+
+    /**
+     * @brief Perform one time step for the system on the device.
+     * 
+     */
+    void update() override;
+
+    /**
+     * @brief Get the positions of each particle, copying them back from the device if they
+     * changed since the last copy.
+     * 
+     * @return const std::vector<Eigen::Vector2d>& representing the positions of each particle.
+     */
+    const std::vector<Eigen::Vector2d>& getPositions() override;
+
+    /**
+     * @brief Get the particle system data, copying every attribute back from the device first.
+     * 
+     * @return SphParticleSystemData2DPtr representing the particle system data.
+     */
+    SphParticleSystemData2DPtr getParticleSystemData() override;
+
+    /**
+     * @brief Copies every attribute back from the device, so the particle system data can be
+     * read on the host, or saved on a checkpoint.
+     * 
+     */
+    void synchronize();
+
+    /**
+     * @brief Saves a checkpoint, copying every attribute back from the device first.
+     * 
+     * @param fileName: Name of the checkpoint file.
+     * @return true if the checkpoint was written.
+     * @return false otherwise.
+     */
+    bool saveCheckpoint(const std::string& fileName) override;
+
+    /**
+     * @brief Restores a checkpoint, copying every attribute back from the device first so a
+     * failed restore keeps the current state. The particles are uploaded again on the next
+     * update.
+     * 
+     * @param fileName: Name of the checkpoint file.
+     * @return true if the checkpoint was read.
+     * @return false otherwise, leaving the solver unchanged.
+     */
+    bool loadCheckpoint(const std::string& fileName) override;
+
+    /**
+     * @brief Rejects colliders, which the device kernels do not apply.
+     * 
+     * @param collider: The collider.
+     * @return false.
+     */
+    bool addCollider(SdfCollider2DPtr collider) override;
+
+    /**
+     * @brief Rejects symmetric pairs, which the device kernels do not run.
+     * 
+     * @param symmetricPairs: true to evaluate each pair once.
+     * @return true if symmetricPairs is false.
+     * @return false otherwise.
+     */
+    bool setSymmetricPairs(bool symmetricPairs) override;
+
+    /**
+     * @brief Checks if the steps run on an offload device.
+     * 
+     * @return true if the steps run on an accelerator.
+     * @return false if they run on the host.
+     */
+    bool isOnDevice();
+
+    /**
+     * @brief Get the number of times the positions were copied back from the device.
+     * 
+     * @return size_t representing the number of copies.
+     */
+    size_t getPositionDownloads();
+
+    /**
+     * @brief Maximum number of neighbors stored for a particle, as in GridNeighborhood2D.
+     * 
+     */
+    const static int MAX_NEIGHBORS = 64;
+
+protected:
+
+    /**
+     * @brief Run one solver step on the device.
+     * 
+     * @param timer: The timer of the update, which receives the time of each phase.
+     */
+    void step(PhaseTimer& timer) override;
+
+    /**
+     * @brief Get the largest squared speed of a particle, reduced on the device.
+     * 
+     * @return double representing the squared speed.
+     */
+    double computeMaxSpeedSquared() override;
+
+    /**
+     * @brief Reads the parameters written by writeState from a binary stream, marking the
+     * particles on the host as the current ones, to be uploaded again.
+     * 
+     * @param stream: The stream to read from.
+     * @return true if every parameter was read.
+     * @return false otherwise.
+     */
+    bool readState(std::istream& stream) override;
+
+private:
+
+    /**
+     * @brief Number of the device the steps run on.
+     * 
+     */
+    int _device = 0;
+
+    /**
+     * @brief Number of particles on the device, -1 if they must be uploaded again.
+     * 
+     */
+    int _deviceParticles = -1;
+
+    /**
+     * @brief Number of cells along the x axis.
+     * 
+     */
+    int _gridWidth = 0;
+
+    /**
+     * @brief Number of cells along the y axis.
+     * 
+     */
+    int _gridHeight = 0;
+
+    /**
+     * @brief If true, the positions on the host match the ones on the device.
+     * 
+     */
+    bool _positionsOnHost = true;
+
+    /**
+     * @brief If true, every attribute on the host matches the device.
+     * 
+     */
+    bool _stateOnHost = true;
+
+    /**
+     * @brief Number of times the positions were copied back from the device.
+     * 
+     */
+    size_t _positionDownloads = 0;
+
+    /**
+     * @brief Positions, two components per particle.
+     * 
+     */
+    DeviceBuffer<double> _positions;
+
+    /**
+     * @brief Velocities, two components per particle.
+     * 
+     */
+    DeviceBuffer<double> _velocities;
+
+    /**
+     * @brief Positions before the integration, two components per particle.
+     * 
+     */
+    DeviceBuffer<double> _lastPositions;
+
+    /**
+     * @brief Projected positions, two components per particle.
+     * 
+     */
+    DeviceBuffer<double> _projectedPositions;
+
+    /**
+     * @brief Densities of each particle.
+     * 
+     */
+    DeviceBuffer<double> _densities;
+
+    /**
+     * @brief Near densities of each particle.
+     * 
+     */
+    DeviceBuffer<double> _densityVariations;
+
+    /**
+     * @brief Pressures of each particle.
+     * 
+     */
+    DeviceBuffer<double> _pressures;
+
+    /**
+     * @brief Near pressures of each particle.
+     * 
+     */
+    DeviceBuffer<double> _pressureVariations;
+
+    /**
+     * @brief Cell of each particle.
+     * 
+     */
+    DeviceBuffer<int> _cellIndices;
+
+    /**
+     * @brief Number of particles of each cell, then where the next particle of each cell is
+     * written during the sort.
+     * 
+     */
+    DeviceBuffer<int> _cellCounts;
+
+    /**
+     * @brief Index where each cell starts on _cellParticles, with one entry more than the
+     * number of cells.
+     * 
+     */
+    DeviceBuffer<int> _cellStarts;
+
+    /**
+     * @brief Particle indices sorted by cell, in increasing index order within each cell.
+     * 
+     */
+    DeviceBuffer<int> _cellParticles;
+
+    /**
+     * @brief Neighbor indices, MAX_NEIGHBORS slots per particle.
+     * 
+     */
+    DeviceBuffer<int> _neighbors;
+
+    /**
+     * @brief Distance to each neighbor, MAX_NEIGHBORS slots per particle.
+     * 
+     */
+    DeviceBuffer<double> _distances;
+
+    /**
+     * @brief Number of neighbors of each particle.
+     * 
+     */
+    DeviceBuffer<int> _numNeighbors;
+
+    /**
+     * @brief Allocates the device arrays and copies the particles to the device.
+     * 
+     */
+    void upload();
+
+    /**
+     * @brief Adds the gravity to the velocities on the device.
+     * 
+     */
+    void applyExternalForcesOnDevice();
+
+    /**
+     * @brief Moves the particles by their velocities on the device.
+     * 
+     */
+    void integrateOnDevice();
+
+    /**
+     * @brief Sorts the particles by cell and finds the neighbors of each particle on the
+     * device.
+     * 
+     */
+    void buildNeighborhoodOnDevice();
+
+    /**
+     * @brief Computes the densities and pressures on the device.
+     * 
+     */
+    void computeDensityPressureOnDevice();
+
+    /**
+     * @brief Projects the positions on the device.
+     * 
+     */
+    void projectOnDevice();
+
+    /**
+     * @brief Corrects the positions and velocities on the device.
+     * 
+     */
+    void correctOnDevice();
+
+    /**
+     * @brief Enforces the boundaries on the device.
+     * 
+     */
+    void enforceBoundaryOnDevice();
+};
+
+/**
+ * @brief std::shared_ptr for DeviceVSphSolver2D.
+ * 
+ */
+typedef std::shared_ptr<DeviceVSphSolver2D> DeviceVSphSolver2DPtr;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,333 @@
+/**
+ * @file DistributedVSphSolver2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the domain decomposed Viscoelastic SPH solver for 2D systems, which runs
+ * one slab of the domain on each MPI rank.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef DISTRIBUTEDVSPHSOLVER2D_H
+#define DISTRIBUTEDVSPHSOLVER2D_H
+
+/**
+ * @brief The distributed solver is compiled only when SPH_MPI is defined, with an MPI
+ * compiler wrapper such as mpicxx. Otherwise this header declares nothing.
+ * 
+ */
+#ifdef SPH_MPI
+
+#include "VSphSolver2D.h"
+#include <eigen3/Eigen/Dense>
+#include <mpi.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Class that implements the Viscoelastic SPH solver for 2D systems on several MPI
+ * ranks. The domain is cut into vertical slabs, one per rank, and each rank runs the steps
+ * of VSphSolver2D on the particles of its slab, with its own SphParticleSystemData2D and
+ * GridNeighborhood2D.
+ * 
+ * Before the neighborhood build, every particle closer than one kernel radius to another
+ * slab is sent to that rank as a ghost. Ghosts are stored on the attribute arrays past
+ * numberOfParticles, so the neighborhood sees them but the density, projection and
+ * correction loops only visit the owned particles. After the densities are computed, the
+ * pressures of the ghosts are refreshed from their owners before the projection, and the
+ * ghosts are dropped after the correction. Particles that left the slab of their rank then
+ * migrate, with every attribute, to the owner of their new position. Every few updates the
+ * slabs are moved so each rank owns about the same number of particles.
+ * 
+ * Each particle keeps its global id on the "globalIds" attribute. Emitters, sinks, spatial
+ * sorts and symmetric pairs are rejected by their setters, since the ghosts past the owned
+ * particles would be emitted into, sorted or scattered into. File output is not supported
+ * either, and every rank must construct the solver with the same arguments. Halo exchanges
+ * are timed with the neighborhood builds, pressure exchanges with the densities and
+ * migrations with the integration.
+ * 
+ */
+class DistributedVSphSolver2D : public VSphSolver2D
+{
+public:
+
+    /**
+     * @brief Construct a new DistributedVSphSolver2D object. Every rank builds the block of
+     * particles of VSphSolver2D and keeps the ones of its slab. Collective over the
+     * communicator.
+     * 
+     * @param numberOfParticles: Number of particles of the whole system.
+     * @param communicator: Communicator of the ranks that share the domain.
+     */
+    DistributedVSphSolver2D(int numberOfParticles, MPI_Comm communicator = MPI_COMM_WORLD);
+
+    /**
+     * @brief Destructor for DistributedVSphSolver2D.
+     * 
+     */
+    ~DistributedVSphSolver2D();
+
+    /**
+     * @brief Perform one time step for the system, rebalancing the slabs first when the
+     * rebalance interval has passed. Collective over the communicator.
+     * 
+     */
+    void update() override;
+
+    /**
+     * @brief Set the number of updates between two rebalances of the slabs.
+     * 
+     * @param rebalanceInterval: Number of updates, 0 to keep the slabs fixed.
+     */
+    void setRebalanceInterval(int rebalanceInterval);
+
+    /**
+     * @brief Rejects spatial sorts, which are not supported.
+     * 
+     * @param reorderInterval: Number of updates between two sorts.
+     * @return true if the interval is 0.
+     * @return false otherwise.
+     */
+    bool setReorderInterval(int reorderInterval) override;
+
+    /**
+     * @brief Rejects emitters, which are not supported.
+     * 
+     * @param emitter: The emitter.
+     * @return false.
+     */
+    bool addEmitter(ParticleEmitter2DPtr emitter) override;
+
+    /**
+     * @brief Rejects sinks, which are not supported.
+     * 
+     * @param sink: The sink.
+     * @return false.
+     */
+    bool addSink(ParticleSink2DPtr sink) override;
+
+    /**
+     * @brief Rejects symmetric pairs, which would scatter into the ghosts past the owned
+     * particles.
+     * 
+     * @param symmetricPairs: true to evaluate each pair once.
+     * @return true if symmetricPairs is false.
+     * @return false otherwise.
+     */
+    bool setSymmetricPairs(bool symmetricPairs) override;
+
+    /**
+     * @brief Move the slabs so each rank owns about the same number of particles, and migrate
+     * the particles to their new owners. Collective over the communicator.
+     * 
+     */
+    void rebalance();
+
+    /**
+     * @brief Gathers the positions of every particle on one rank, in global id order.
+     * Collective over the communicator.
+     * 
+     * @param positions: Receives the positions on the root rank, untouched on the others.
+     * @param root: Rank that receives the positions.
+     * @return true on the root rank.
+     * @return false on the other ranks.
+     */
+    bool gatherPositions(std::vector<Eigen::Vector2d>& positions, int root = 0);
+
+    /**
+     * @brief Get the rank of this process on the communicator.
+     * 
+     * @return int representing the rank.
+     */
+    int getRank();
+
+    /**
+     * @brief Get the number of ranks that share the domain.
+     * 
+     * @return int representing the number of ranks.
+     */
+    int getNumberOfRanks();
+
+    /**
+     * @brief Get the number of particles owned by this rank.
+     * 
+     * @return size_t representing the number of particles.
+     */
+    size_t getNumberOfOwnedParticles();
+
+    /**
+     * @brief Get the number of ghosts received by the last halo exchange.
+     * 
+     * @return size_t representing the number of ghosts.
+     */
+    size_t getNumberOfGhosts();
+
+    /**
+     * @brief Get the number of particles of the whole system.
+     * 
+     * @return size_t representing the number of particles.
+     */
+    size_t getGlobalNumberOfParticles();
+
+    /**
+     * @brief Get the slab of a rank along the x axis. The first and the last slabs are
+     * unbounded outwards.
+     * 
+     * @param rank: The rank.
+     * @return Eigen::Vector2d representing the lowest and the highest x of the slab.
+     */
+    Eigen::Vector2d getSlab(int rank);
+
+    /**
+     * @brief Number of bins of the histogram of x positions the slabs are cut on.
+     * 
+     */
+    const static int REBALANCE_BINS = 1024;
+
+protected:
+
+    /**
+     * @brief Run one solver step, exchanging the ghosts around the neighborhood build and
+     * the projection, and migrating the particles after the correction.
+     * 
+     * @param timer: The timer of the update, which receives the time of each phase.
+     */
+    void step(PhaseTimer& timer) override;
+
+    /**
+     * @brief Pick the size of the next adaptive step, the smallest of the ranks, so every
+     * rank runs the same steps.
+     * 
+     * @param remainingTime: Simulated time, in seconds, left in the update.
+     * @return double representing the size of the next step, in seconds.
+     */
+    double computeTimeStepSize(double remainingTime) override;
+
+private:
+
+    /**
+     * @brief Communicator of the ranks that share the domain.
+     * 
+     */
+    MPI_Comm _communicator;
+
+    /**
+     * @brief Rank of this process.
+     * 
+     */
+    int _rank = 0;
+
+    /**
+     * @brief Number of ranks.
+     * 
+     */
+    int _numberOfRanks = 1;
+
+    /**
+     * @brief Number of particles of the whole system.
+     * 
+     */
+    size_t _globalNumberOfParticles = 0;
+
+    /**
+     * @brief Cuts between consecutive slabs, in increasing order. Rank r owns the particles
+     * with x in [_slabCuts[r - 1], _slabCuts[r]).
+     * 
+     */
+    std::vector<double> _slabCuts = {};
+
+    /**
+     * @brief Number of updates between two rebalances, 0 to keep the slabs fixed.
+     * 
+     */
+    int _rebalanceInterval = 10;
+
+    /**
+     * @brief Number of updates since the last rebalance.
+     * 
+     */
+    int _updatesSinceRebalance = 0;
+
+    /**
+     * @brief Owned particles sent as ghosts by the last halo exchange, grouped by rank.
+     * 
+     */
+    std::vector<int> _ghostSendIndices = {};
+
+    /**
+     * @brief Number of ghosts sent to each rank by the last halo exchange.
+     * 
+     */
+    std::vector<int> _ghostSendCounts = {};
+
+    /**
+     * @brief Number of ghosts received from each rank by the last halo exchange.
+     * 
+     */
+    std::vector<int> _ghostReceiveCounts = {};
+
+    /**
+     * @brief Number of ghosts stored past the owned particles.
+     * 
+     */
+    size_t _numberOfGhosts = 0;
+
+    /**
+     * @brief Rank that owns a position.
+     * 
+     * @param x: The x coordinate of the position.
+     * @return int representing the rank.
+     */
+    int ownerOf(double x);
+
+    /**
+     * @brief Sends values to every rank and receives theirs. Collective over the communicator.
+     * 
+     * @param sendValues: Values sent, grouped by rank.
+     * @param sendCounts: Number of particles sent to each rank.
+     * @param valuesPerParticle: Number of values of each particle.
+     * @param receiveValues: Receives the values, grouped by rank.
+     * @param receiveCounts: Receives the number of particles received from each rank.
+     */
+    void exchange(const std::vector<double>& sendValues, const std::vector<int>& sendCounts,
+        int valuesPerParticle, std::vector<double>& receiveValues, std::vector<int>& receiveCounts);
+
+    /**
+     * @brief Sends the positions and velocities of the owned particles within one kernel
+     * radius of another slab to its rank, and stores the ghosts received past the owned
+     * particles.
+     * 
+     */
+    void exchangeGhosts();
+
+    /**
+     * @brief Refreshes the pressures and pressure variations of the ghosts from their owners.
+     * 
+     */
+    void exchangeGhostPressures();
+
+    /**
+     * @brief Removes the ghosts stored past the owned particles.
+     * 
+     */
+    void dropGhosts();
+
+    /**
+     * @brief Sends the particles outside the slab of this rank, with every attribute, to the
+     * owners of their positions.
+     * 
+     */
+    void migrateParticles();
+};
+
+/**
+ * @brief std::shared_ptr for DistributedVSphSolver2D.
+ * 
+ */
+typedef std::shared_ptr<DistributedVSphSolver2D> DistributedVSphSolver2DPtr;
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,245 @@
+/**
+ * @file EnsembleRunner.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the runner of ensembles of independent Viscoelastic SPH simulations.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef ENSEMBLERUNNER_H
+#define ENSEMBLERUNNER_H
+
+#include "VSphSolver2D.h"
+#include "WorkStealingScheduler.h"
+#include <eigen3/Eigen/Dense>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Struct with the scene and the physical parameters of one simulation of an ensemble.
+ * The parameters default to the ones of SphParticleSystemData2D.
+ * 
+ */
+struct EnsembleMember {
+
+    /**
+     * @brief Number of particles of the scene.
+     * 
+     */
+    int numberOfParticles = 500;
+
+    /**
+     * @brief Number of updates to run.
+     * 
+     */
+    int numberOfUpdates = 100;
+
+    /**
+     * @brief Stiffness of the pressures.
+     * 
+     */
+    double stiffness = 0.08;
+
+    /**
+     * @brief Stiffness of the near pressures.
+     * 
+     */
+    double stiffnessAtProximity = 0.1;
+
+    /**
+     * @brief Linear term of the viscosity impulses.
+     * 
+     */
+    double linearViscosity = 0.25;
+
+    /**
+     * @brief Quadratic term of the viscosity impulses.
+     * 
+     */
+    double quadraticViscosity = 0.5;
+
+    /**
+     * @brief Surface tension.
+     * 
+     */
+    double surfaceTension = 0.0001;
+
+    /**
+     * @brief Size of the solver steps.
+     * 
+     */
+    TimeStepSettings timeStepSettings;
+
+    /**
+     * @brief Name of the binary snapshot file the simulation is written to. Empty to disable
+     * writing.
+     * 
+     */
+    std::string fileName = "";
+};
+
+/**
+ * @brief Struct with the final state of one simulation of an ensemble, kept once its solver
+ * is released.
+ * 
+ */
+struct EnsembleResult {
+
+    /**
+     * @brief If true, the simulation was run.
+     * 
+     */
+    bool finished = false;
+
+    /**
+     * @brief Positions of each particle after the last update, in id order.
+     * 
+     */
+    std::vector<Eigen::Vector2d> positions = {};
+};
+
+/**
+ * @brief Class that runs an ensemble of independent VSphSolver2D simulations, such as a
+ * parameter sweep, concurrently in one process.
+ * 
+ * Each simulation is a task of a WorkStealingScheduler, and runs every update on the worker
+ * that took it with threadsPerMember OpenMP threads, one by default. Small scenes barely
+ * scale with OpenMP, so running one scene per core gets more updates per core than running
+ * the scenes one after the other on every core. The simulations are handed to the scheduler
+ * from the most expensive one, by particles times updates, so the long ones start first and
+ * the short ones fill the gaps at the end. Each solver is created by the worker that runs it,
+ * so its memory is allocated close to that core, and writes its binary snapshots while it
+ * runs. A solver is released as soon as its simulation finishes, keeping only its result, so
+ * the memory of the ensemble is bounded by the simulations running at the same time.
+ * 
+ */
+class EnsembleRunner {
+public:
+
+    /**
+     * @brief Construct a new EnsembleRunner object.
+     * 
+     * @param numberOfWorkers: Number of simulations run at the same time, 0 for one per
+     * hardware thread.
+     */
+    EnsembleRunner(int numberOfWorkers = 0);
+
+    /**
+     * @brief Destructor for EnsembleRunner.
+     * 
+     */
+    ~EnsembleRunner();
+
+    /**
+     * @brief Adds a simulation to the ensemble.
+     * 
+     * @param member: The scene and parameters of the simulation.
+     * @return int representing the index of the simulation.
+     */
+    int addMember(const EnsembleMember& member);
+
+    /**
+     * @brief Set the fields, frequency, precision and compression of the snapshots of every
+     * simulation.
+     * 
+     * @param outputSettings: The settings of the output.
+     * @return true if every field is an attribute of the VSPH particle system.
+     * @return false otherwise, keeping the previous settings.
+     */
+    bool setOutputSettings(const OutputSettings& outputSettings);
+
+    /**
+     * @brief Set the number of OpenMP threads each simulation runs its loops with.
+     * 
+     * @param threadsPerMember: Number of threads, at least 1.
+     */
+    void setThreadsPerMember(int threadsPerMember);
+
+    /**
+     * @brief Runs every simulation that was not run yet, returning once all of them finished.
+     * 
+     */
+    void run();
+
+    /**
+     * @brief Get the number of simulations of the ensemble.
+     * 
+     * @return int representing the number of simulations.
+     */
+    int getNumberOfMembers();
+
+    /**
+     * @brief Get the number of simulations run at the same time.
+     * 
+     * @return int representing the number of workers.
+     */
+    int getNumberOfWorkers();
+
+    /**
+     * @brief Get the final state of a simulation.
+     * 
+     * @param member: The index of the simulation.
+     * @return const EnsembleResult& representing the result, not finished if the simulation
+     * was not run yet.
+     */
+    const EnsembleResult& getResult(int member);
+
+    /**
+     * @brief Get the number of simulations of the last run taken over by a worker other than
+     * the one they were dealt to.
+     * 
+     * @return size_t representing the number of steals.
+     */
+    size_t getSteals();
+
+private:
+
+    /**
+     * @brief The scheduler that shares the simulations between the workers.
+     * 
+     */
+    WorkStealingScheduler _scheduler;
+
+    /**
+     * @brief The scene and parameters of each simulation.
+     * 
+     */
+    std::vector<EnsembleMember> _members;
+
+    /**
+     * @brief The final state of each simulation.
+     * 
+     */
+    std::vector<EnsembleResult> _results;
+
+    /**
+     * @brief The settings of the output of every simulation.
+     * 
+     */
+    OutputSettings _outputSettings;
+
+    /**
+     * @brief Number of OpenMP threads of each simulation.
+     * 
+     */
+    int _threadsPerMember = 1;
+
+    /**
+     * @brief Creates the solver of a simulation, runs all of its updates and keeps its result.
+     * 
+     * @param member: The index of the simulation.
+     */
+    void runMember(int member);
+};
+
+/**
+ * @brief std::shared_ptr for EnsembleRunner.
+ * 
+ */
+typedef std::shared_ptr<EnsembleRunner> EnsembleRunnerPtr;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+/**
+ * @file FixedOrderSum.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements FixedOrderSum: parallel sums of per-particle values that round
+ * the same for any number of threads.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef FIXEDORDERSUM_H
+#define FIXEDORDERSUM_H
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+/**
+ * @brief Class that sums per-particle values in parallel, in an order that does not depend on
+ * the number of threads. The values are split into blocks of BLOCK_SIZE, each block is summed
+ * in order by one thread, and the sums of the blocks are added in order. An OpenMP reduction
+ * instead adds the values in one partial sum per thread, so its rounding changes with the
+ * number of threads.
+ * 
+ * @tparam T: type of the values.
+ */
+template <typename T>
+class FixedOrderSum {
+public:
+
+    /**
+     * @brief Number of values of each block.
+     * 
+     */
+    const static size_t BLOCK_SIZE = 256;
+
+    /**
+     * @brief Sums the values of count particles.
+     * 
+     * @tparam Value: type of the function that gives the value of a particle.
+     * @param count: Number of particles.
+     * @param value: Function that gives the value of a particle from its index.
+     * @param zero: The value that does not change a sum.
+     * @return T representing the sum.
+     */
+    template <typename Value>
+    T sum(size_t count, const Value& value, const T& zero) {
+        const size_t numberOfBlocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        _blockSums.assign(numberOfBlocks, zero);
+
+        #pragma omp parallel for
+        for (size_t block = 0; block < numberOfBlocks; block++) {
+            const size_t end = std::min(count, (block + 1) * BLOCK_SIZE);
+            T blockSum = zero;
+
+            for (size_t i = block * BLOCK_SIZE; i < end; i++) {
+                blockSum += value(i);
+            }
+
+            _blockSums[block] = blockSum;
+        }
+
+        T result = zero;
+        for (const T& blockSum : _blockSums) {
+            result += blockSum;
+        }
+
+        return result;
+    }
+
+private:
+
+    /**
+     * @brief The sum of each block.
+     * 
+     */
+    std::vector<T> _blockSums;
+};
+
+#endif
\ No newline at end of file
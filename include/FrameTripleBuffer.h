@@ -0,0 +1,116 @@
+/**
+ * @file FrameTripleBuffer.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements FrameTripleBuffer: lock-free hand over of frames from one
+ * producer thread to one consumer thread.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef FRAMETRIPLEBUFFER_H
+#define FRAMETRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * @brief Class that hands frames over from one producer thread to one consumer thread through
+ * three slots, without locks. The producer writes the write slot and publishes it, which
+ * swaps it with the ready slot, and the consumer acquires the ready slot, which swaps it with
+ * the read slot. Neither thread ever waits for the other: the producer always has a slot to
+ * write, the consumer always has the latest published frame, and frames published before the
+ * consumer acquires them are dropped. The class only tracks the slots, so the frames can live
+ * anywhere, such as on the three regions of a vertex buffer.
+ * 
+ */
+class FrameTripleBuffer {
+public:
+
+    /**
+     * @brief Get the slot the producer writes the next frame to.
+     * 
+     * @return int representing the slot, between 0 and 2.
+     */
+    int getWriteSlot() const {
+        return _writeSlot;
+    }
+
+    /**
+     * @brief Publishes the write slot, once the producer wrote its frame, and moves the
+     * producer to the slot of the frame it replaces.
+     * 
+     */
+    void publish() {
+        _writeSlot = _readySlot.exchange(_writeSlot | FRESH, std::memory_order_acq_rel) & SLOT_MASK;
+    }
+
+    /**
+     * @brief Moves the consumer to the latest published frame, if there is a new one.
+     * 
+     * @return true if a new frame was acquired.
+     * @return false if no frame was published since the last acquire.
+     */
+    bool acquire() {
+        if (!(_readySlot.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+
+        _readSlot = _readySlot.exchange(_readSlot, std::memory_order_acq_rel) & SLOT_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Checks if a frame was published since the last acquire.
+     * 
+     * @return true if acquire would move the consumer to a new frame.
+     * @return false otherwise.
+     */
+    bool isFresh() const {
+        return _readySlot.load(std::memory_order_relaxed) & FRESH;
+    }
+
+    /**
+     * @brief Get the slot of the frame the consumer reads.
+     * 
+     * @return int representing the slot, between 0 and 2.
+     */
+    int getReadSlot() const {
+        return _readSlot;
+    }
+
+private:
+
+    /**
+     * @brief Flag of the ready slot set when it holds a frame the consumer did not acquire.
+     * 
+     */
+    static const int FRESH = 4;
+
+    /**
+     * @brief Mask of the slot in the ready slot.
+     * 
+     */
+    static const int SLOT_MASK = 3;
+
+    /**
+     * @brief The slot of the latest published frame, with the FRESH flag.
+     * 
+     */
+    std::atomic<int> _readySlot{1};
+
+    /**
+     * @brief The slot owned by the producer.
+     * 
+     */
+    int _writeSlot = 0;
+
+    /**
+     * @brief The slot owned by the consumer.
+     * 
+     */
+    int _readSlot = 2;
+};
+
+#endif
\ No newline at end of file
@@ -16,6 +16,57 @@
 #include <memory>
 #include "SphSolver2D.h"
 
+/**
+ * @brief Enum class with the ways particles are colored by the vertex buffer renderer.
+ * 
+ */
+enum class ColorMode {
+    Uniform,
+    Density,
+    Velocity
+};
+
+/**
+ * @brief Struct with the settings of the renderer, given before the main loop starts.
+ * 
+ */
+struct RenderSettings {
+
+    /**
+     * @brief If true, the particles are streamed into a vertex buffer, persistently mapped
+     * when the OpenGL context supports buffer storage, instead of being drawn in immediate mode.
+     * 
+     */
+    bool vertexBuffer = false;
+
+    /**
+     * @brief If true, the solver updates on its own thread and hands its frames over to the
+     * renderer through a triple buffer, so neither waits for the other. Only used with
+     * vertexBuffer.
+     * 
+     */
+    bool solverThread = false;
+
+    /**
+     * @brief How the particles are colored. Only used with vertexBuffer.
+     * 
+     */
+    ColorMode colorMode = ColorMode::Uniform;
+
+    /**
+     * @brief Number of particles the vertex buffer holds, 0 for the number of particles when
+     * the main loop starts. Particles past it, such as the ones of emitters, are not drawn.
+     * 
+     */
+    size_t maxParticles = 0;
+};
+
+/**
+ * @brief Number of floats of each vertex written by writeFrame: the position, then the color.
+ * 
+ */
+const static int FLOATS_PER_VERTEX = 5;
+
 /**
  * @brief The SPH solver pointer for 2D particle systems to be rendered.
  * 
@@ -55,4 +106,24 @@ void initGL();
  */
 void setSolver(SphSolver2DPtr solver_);
 
+/**
+ * @brief Set the settings of the renderer.
+ * 
+ * @param settings: The render settings.
+ */
+void setRenderSettings(RenderSettings settings);
+
+/**
+ * @brief Writes the vertices of a frame: the position and color of each particle, in
+ * FLOATS_PER_VERTEX floats. Densities are colored from blue to red up to twice the rest
+ * density, and speeds up to the fastest particle of the frame.
+ * 
+ * @param sphSolver: The solver with the particles.
+ * @param colorMode: How the particles are colored.
+ * @param vertices: Receives the vertices.
+ * @param capacity: Number of vertices vertices can hold.
+ * @return size_t representing the number of vertices written.
+ */
+size_t writeFrame(SphSolver2D& sphSolver, ColorMode colorMode, float *vertices, size_t capacity);
+
 #endif
\ No newline at end of file
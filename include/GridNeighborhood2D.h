@@ -46,47 +46,13 @@ public:
     Neighbor *next = nullptr;
 };
 
-/**
- * @brief Struct describing the neighborhood of a particle.
- * 
- */
-struct Neighborhood {
-public:
-
-    /**
-     * @brief Default costructor of the Neighborhood struct.
-     * 
-     */
-	Neighborhood() : neighbors(MAX_NEIGHBORS), distances(MAX_NEIGHBORS), numNeighbors(0) {}
-
-    /**
-     * @brief List of neighbors of the particle.
-     * 
-     */
-	std::vector<const Neighbor *> neighbors;
-
-    /**
-     * @brief The distance to each neighbor on the neighbors list.
-     * 
-     */
-	std::vector<double> distances;
-
-    /**
-     * @brief Number of neighbors of the particle.
-     * 
-     */
-	int numNeighbors;
-
-    /**
-     * @brief Maximum number of neighbors for a particle.
-     * 
-     */
-	const static int MAX_NEIGHBORS = 64;
-};
-
 /**
  * @brief Class describing the Grid Neighborhood for 2D particle systems.
  * 
+ * Its capacity follows the number of points given to build(), so particles can be added and
+ * removed between builds. The neighbors of every particle are stored in one flat buffer,
+ * with _maxNeighbors slots per particle, that grows geometrically and is never shrunk.
+ * 
  */
 class GridNeighborhood2D: public ParticleNeighborhood2D {
 public:
@@ -104,12 +70,12 @@ public:
     ~GridNeighborhood2D();
 
     /**
-     * @brief Initializes the GridNeighborhood2D class with a
+     * @brief Initializes the GridNeighborhood2D class with room for a
      * predefined number of particles.
      * 
-     * @param numParticles Number of particles in the system.
+     * @param numberOfPoints Number of particles in the system.
      */
-    GridNeighborhood2D(const int numberOfpoints);
+    GridNeighborhood2D(const int numberOfPoints);
 
     /**
      * @brief Set the resolution of the grid.
@@ -132,6 +98,14 @@ public:
 		const int origin,
 		const ForEachNearbyPointFunc& callback) const override;
 
+    /**
+     * @brief Get a view over the neighbors of the given particle, valid until the next build.
+     * 
+     * @param origin: Index of the particle.
+     * @return NeighborList2D representing the neighbors of the particle.
+     */
+    NeighborList2D getNeighbors(const int origin) const override;
+
     /**
 	 * @brief Builds the neighorhood's iternal structure.
 	 * 
@@ -147,6 +121,44 @@ public:
 	 */
     std::vector<double> getDistances(int index) override;
 
+    /**
+     * @brief Enables or disables sorting each neighborhood by particle index after a build.
+     * Sorted neighborhoods are visited in the same order as an all-pairs loop.
+     * 
+     * @param sortByIndex: true to sort the neighborhoods by particle index.
+     */
+    void setSortByIndex(bool sortByIndex) override;
+
+    /**
+     * @brief Enables or disables half neighbor lists, where each pair of particles is
+     * stored once, on the neighborhood of the particle with the lowest index.
+     * 
+     * @param halfNeighborList: true to store each pair once.
+     */
+    void setHalfNeighborList(bool halfNeighborList) override;
+
+    /**
+     * @brief Checks if each pair of particles is stored once.
+     * 
+     * @return true if the neighborhood stores half neighbor lists.
+     * @return false if each pair is stored on the neighborhoods of both particles.
+     */
+    bool isHalfNeighborList() const override;
+
+    /**
+     * @brief Reserves room for the given number of particles, so builds with up to that many
+     * particles do not allocate.
+     * 
+     * @param numberOfPoints: Number of particles.
+     */
+    void reserve(int numberOfPoints);
+
+    /**
+     * @brief Default number of neighbors stored for a particle.
+     * 
+     */
+    const static int MAX_NEIGHBORS = 64;
+
 private:
     /**
      * @brief Neighbors sorted according to particle index.
@@ -167,10 +179,22 @@ private:
     std::vector<Eigen::Vector2i> _gridIndices;
 
     /**
-     * @brief List containing the neighborhood of each particle.
+     * @brief Neighbor indices, _maxNeighbors slots per particle.
      * 
      */
-    std::vector<Neighborhood> _neighborhoods;
+    std::vector<int> _neighbors;
+
+    /**
+     * @brief Distance to each neighbor, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<double> _distances;
+
+    /**
+     * @brief Number of neighbors of each particle.
+     * 
+     */
+    std::vector<int> _numNeighbors;
 
     /**
      * @brief Width of the grid.
@@ -196,6 +220,32 @@ private:
      * 
      */
     int _numCells = 100;
+
+    /**
+     * @brief If true, each neighborhood is sorted by particle index after a build.
+     * 
+     */
+    bool _sortByIndex = false;
+
+    /**
+     * @brief If true, each pair of particles is stored once.
+     * 
+     */
+    bool _halfNeighborList = false;
+
+    /**
+     * @brief Sorts the neighbors of a particle by particle index.
+     * 
+     * @param index: Index of the particle whose neighbors are sorted.
+     */
+    void sortNeighborhood(int index);
+
+    /**
+     * @brief Grows the buffers to hold the given number of particles.
+     * 
+     * @param numberOfPoints: Number of particles.
+     */
+    void resize(int numberOfPoints);
 };
 
 /**
@@ -0,0 +1,249 @@
+/**
+ * @file HashNeighborhood2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the spatial hash Neighborhood for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef HASHNEIGHBORHOOD2D_H
+#define HASHNEIGHBORHOOD2D_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <eigen3/Eigen/Dense>
+#include "ParticleNeighborhood2D.h"
+
+/**
+ * @brief Class describing a spatial hash neighborhood for 2D particle systems.
+ * 
+ * The plane is divided into unbounded cells of one kernel radius, and each cell is hashed into
+ * a table with twice as many buckets as particles, rounded up to a power of two. The particles
+ * are bucketed with a counting sort, in increasing index order, so the memory follows the
+ * number of particles instead of the area of the domain, and particles outside the view are
+ * neither clamped nor piled into the border cells. Cells hashed to the same bucket are told
+ * apart by the cell stored for each particle. Neighbor lists are stored on one flat buffer
+ * with a fixed number of slots per particle.
+ * 
+ */
+class HashNeighborhood2D: public ParticleNeighborhood2D {
+public:
+
+    /**
+     * @brief Default constructor for the HashNeighborhood2D class.
+     * 
+     */
+    HashNeighborhood2D();
+
+    /**
+     * @brief Destructor for the HashNeighborhood2D class.
+     * 
+     */
+    ~HashNeighborhood2D();
+
+    /**
+     * @brief Set the size of the cells. The cells are unbounded, so the width and the height
+     * are ignored.
+     * 
+     * @param width: Width of the view, unused.
+     * @param height: Height of the view, unused.
+     * @param kernelRadius: Kernel radius.
+     */
+    void setGridResolution(int width, int height, double kernelRadius) override;
+
+    /**
+     * @brief Loop through all neighbor particles of the given particle,
+     * invoking a call to callback on each neighbor.
+     * 
+     * @param origin: Index of the particle that will have it's neighborhood
+     * looped through.
+     * @param callback: Callback function to be invoked on each neighbor.
+     */
+    void forEachNearbyPoint(
+        const int origin,
+        const ForEachNearbyPointFunc& callback) const override;
+
+    /**
+     * @brief Get a view over the neighbors of the given particle, valid until the next build.
+     * 
+     * @param origin: Index of the particle.
+     * @return NeighborList2D representing the neighbors of the particle.
+     */
+    NeighborList2D getNeighbors(const int origin) const override;
+
+    /**
+     * @brief Builds the neighorhood's iternal structure.
+     * 
+     * @param points: array of all points that will be part of the neighborhood.
+     */
+    void build(const std::vector<Eigen::Vector2d>& points) override;
+
+    /**
+     * @brief Get the Distances of a particle to it's neighbors.
+     * 
+     * @param index: index of the particle to get the distances of.
+     * @return std::vector<double> represeting the list of distances.
+     */
+    std::vector<double> getDistances(int index) override;
+
+    /**
+     * @brief Enables or disables sorting each neighborhood by particle index after a build.
+     * Sorted neighborhoods are visited in the same order as an all-pairs loop.
+     * 
+     * @param sortByIndex: true to sort the neighborhoods by particle index.
+     */
+    void setSortByIndex(bool sortByIndex) override;
+
+    /**
+     * @brief Enables or disables half neighbor lists, where each pair of particles is
+     * stored once, on the neighborhood of the particle with the lowest index.
+     * 
+     * @param halfNeighborList: true to store each pair once.
+     */
+    void setHalfNeighborList(bool halfNeighborList) override;
+
+    /**
+     * @brief Checks if each pair of particles is stored once.
+     * 
+     * @return true if the neighborhood stores half neighbor lists.
+     * @return false if each pair is stored on the neighborhoods of both particles.
+     */
+    bool isHalfNeighborList() const override;
+
+    /**
+     * @brief Get the number of buckets of the hash table of the last build.
+     * 
+     * @return size_t representing the number of buckets.
+     */
+    size_t getNumberOfBuckets() const;
+
+    /**
+     * @brief Default number of neighbors stored for a particle.
+     * 
+     */
+    const static int MAX_NEIGHBORS = 64;
+
+    /**
+     * @brief Largest cell coordinate, in absolute value. Farther particles are kept on the
+     * outermost cells, so the coordinates of the cells around them do not overflow.
+     * 
+     */
+    const static int MAX_CELL_COORDINATE = 1 << 30;
+
+private:
+
+    /**
+     * @brief Cell of each particle.
+     * 
+     */
+    std::vector<Eigen::Vector2i> _particleCells;
+
+    /**
+     * @brief Bucket of each particle.
+     * 
+     */
+    std::vector<int> _particleBuckets;
+
+    /**
+     * @brief Index where each bucket starts on _bucketParticles. Has one entry more than the
+     * number of buckets, so the particles of bucket b are in [_bucketStart[b], _bucketStart[b + 1]).
+     * 
+     */
+    std::vector<int> _bucketStart;
+
+    /**
+     * @brief Where the next particle of each bucket is written during a build.
+     * 
+     */
+    std::vector<int> _bucketOffsets;
+
+    /**
+     * @brief Particle indices stored contiguously per bucket.
+     * 
+     */
+    std::vector<int> _bucketParticles;
+
+    /**
+     * @brief Neighbor indices, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<int> _neighbors;
+
+    /**
+     * @brief Distance to each neighbor, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<double> _distances;
+
+    /**
+     * @brief Number of neighbors of each particle.
+     * 
+     */
+    std::vector<int> _numNeighbors;
+
+    /**
+     * @brief The cize of each cell.
+     * 
+     */
+    double _cellSize = 1.0;
+
+    /**
+     * @brief Number of buckets minus one. The number of buckets is a power of two.
+     * 
+     */
+    uint32_t _bucketMask = 0;
+
+    /**
+     * @brief If true, each neighborhood is sorted by particle index after a build.
+     * 
+     */
+    bool _sortByIndex = false;
+
+    /**
+     * @brief If true, each pair of particles is stored once.
+     * 
+     */
+    bool _halfNeighborList = false;
+
+    /**
+     * @brief Computes the cell of a point.
+     * 
+     * @param point: The point.
+     * @return Eigen::Vector2i representing the coordinates of the cell.
+     */
+    Eigen::Vector2i cellOf(const Eigen::Vector2d& point) const;
+
+    /**
+     * @brief Hashes a cell into a bucket of the table.
+     * 
+     * @param cell: The coordinates of the cell.
+     * @return int representing the bucket.
+     */
+    int bucketOf(const Eigen::Vector2i& cell) const;
+
+    /**
+     * @brief Buckets the particles into the hash table with a counting sort.
+     * 
+     * @param points: array of all points that will be part of the neighborhood.
+     */
+    void sortIntoBuckets(const std::vector<Eigen::Vector2d>& points);
+
+    /**
+     * @brief Sorts the neighbors of a particle by particle index.
+     * 
+     * @param index: Index of the particle.
+     */
+    void sortNeighborhood(int index);
+};
+
+/**
+ * @brief std::shared_ptr to the HashNeighborhood2D class.
+ * 
+ */
+typedef std::shared_ptr<HashNeighborhood2D> HashNeighborhood2DPtr;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,229 @@
+/**
+ * @file ParticleAttributes.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the registry of named per-particle attributes for 2D and 3D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef PARTICLEATTRIBUTES_H
+#define PARTICLEATTRIBUTES_H
+
+#include <eigen3/Eigen/Dense>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class that stores named per-particle attributes of a particle system.
+ * Every attribute holds one contiguous array with one value per particle, and all
+ * attributes grow together when a particle is added.
+ * 
+ * @tparam Dimension: number of components of the vector attributes, 2 or 3.
+ */
+template <int Dimension>
+class ParticleAttributesT {
+public:
+
+    /**
+     * @brief Vector of the vector attributes.
+     * 
+     */
+    typedef Eigen::Matrix<double, Dimension, 1> Vector;
+
+    /**
+     * @brief Default constructor for ParticleAttributesT.
+     * 
+     */
+    ParticleAttributesT();
+
+    /**
+     * @brief Destructor for ParticleAttributesT.
+     * 
+     */
+    ~ParticleAttributesT();
+
+    /**
+     * @brief Number of particles stored on each attribute.
+     * 
+     * @return size_t representing the number of particles.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Registers a new scalar attribute. If an attribute with the same name already
+     * exists, it is kept as is.
+     * 
+     * @param name: Name of the attribute.
+     * @param defaultValue: Value given to the attribute of newly added particles.
+     * @return std::vector<double>& representing the values of the attribute.
+     */
+    std::vector<double>& addScalarAttribute(const std::string& name, double defaultValue = 0.0);
+
+    /**
+     * @brief Registers a new vector attribute. If an attribute with the same name already
+     * exists, it is kept as is.
+     * 
+     * @param name: Name of the attribute.
+     * @param defaultValue: Value given to the attribute of newly added particles.
+     * @return std::vector<Vector>& representing the values of the attribute.
+     */
+    std::vector<Vector>& addVectorAttribute(const std::string& name,
+        const Vector& defaultValue = Vector::Zero());
+
+    /**
+     * @brief Checks if a scalar attribute is registered.
+     * 
+     * @param name: Name of the attribute.
+     * @return true if the attribute is registered.
+     * @return false if the attribute is not registered.
+     */
+    bool hasScalarAttribute(const std::string& name) const;
+
+    /**
+     * @brief Checks if a vector attribute is registered.
+     * 
+     * @param name: Name of the attribute.
+     * @return true if the attribute is registered.
+     * @return false if the attribute is not registered.
+     */
+    bool hasVectorAttribute(const std::string& name) const;
+
+    /**
+     * @brief Get the values of a scalar attribute. Throws std::out_of_range if the
+     * attribute is not registered.
+     * 
+     * @param name: Name of the attribute.
+     * @return std::vector<double>& representing the values of the attribute.
+     */
+    std::vector<double>& getScalarAttribute(const std::string& name);
+
+    /**
+     * @brief Get the values of a vector attribute. Throws std::out_of_range if the
+     * attribute is not registered.
+     * 
+     * @param name: Name of the attribute.
+     * @return std::vector<Vector>& representing the values of the attribute.
+     */
+    std::vector<Vector>& getVectorAttribute(const std::string& name);
+
+    /**
+     * @brief Get the names of all scalar attributes.
+     * 
+     * @return std::vector<std::string> representing the names, in alphabetical order.
+     */
+    std::vector<std::string> getScalarAttributeNames() const;
+
+    /**
+     * @brief Get the names of all vector attributes.
+     * 
+     * @return std::vector<std::string> representing the names, in alphabetical order.
+     */
+    std::vector<std::string> getVectorAttributeNames() const;
+
+    /**
+     * @brief Appends one particle to every attribute, using each attribute's default value.
+     * 
+     */
+    void addParticle();
+
+    /**
+     * @brief Resizes every attribute to hold size particles. New particles get each
+     * attribute's default value.
+     * 
+     * @param size: The new number of particles.
+     */
+    void resize(size_t size);
+
+    /**
+     * @brief Removes one particle from every attribute in constant time, by moving the last
+     * particle into its slot.
+     * 
+     * @param index: Slot of the particle to be removed.
+     */
+    void removeParticle(size_t index);
+
+    /**
+     * @brief Reserves room for size particles on every attribute, so adding particles up to
+     * that number does not reallocate.
+     * 
+     * @param size: The number of particles.
+     */
+    void reserve(size_t size);
+
+    /**
+     * @brief Permutes every attribute so that the particle stored at order[k] moves to slot k.
+     * 
+     * @param order: Permutation of the particle slots, with size() entries.
+     */
+    void reorder(const std::vector<size_t>& order);
+
+private:
+
+    /**
+     * @brief Struct describing a scalar attribute.
+     * 
+     */
+    struct ScalarAttribute {
+        std::vector<double> values;
+        double defaultValue;
+    };
+
+    /**
+     * @brief Struct describing a vector attribute.
+     * 
+     */
+    struct VectorAttribute {
+        std::vector<Vector> values;
+        Vector defaultValue;
+    };
+
+    /**
+     * @brief Scalar attributes by name. std::map keeps references to the values stable.
+     * 
+     */
+    std::map<std::string, ScalarAttribute> _scalarAttributes;
+
+    /**
+     * @brief Vector attributes by name. std::map keeps references to the values stable.
+     * 
+     */
+    std::map<std::string, VectorAttribute> _vectorAttributes;
+
+    /**
+     * @brief Number of particles stored on each attribute.
+     * 
+     */
+    size_t _size = 0;
+};
+
+/**
+ * @brief Registry of the attributes of a 2D particle system.
+ * 
+ */
+typedef ParticleAttributesT<2> ParticleAttributes2D;
+
+/**
+ * @brief Registry of the attributes of a 3D particle system.
+ * 
+ */
+typedef ParticleAttributesT<3> ParticleAttributes3D;
+
+/**
+ * @brief View a list of vectors as one contiguous array of Dimension * size() doubles,
+ * laid out as x0, y0, x1, y1, ... This lets element-wise loops run over a flat stream
+ * that the compiler can vectorize.
+ * 
+ * @tparam Dimension: number of components of the vectors.
+ * @param values: The list of vectors.
+ * @return double* pointing to the first component.
+ */
+template <int Dimension>
+inline double* flatData(std::vector<Eigen::Matrix<double, Dimension, 1>>& values) {
+    return reinterpret_cast<double *>(values.data());
+}
+
+#endif // PARTICLEATTRIBUTES_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+/**
+ * @file ParticleEmitter2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the particle emitter for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef PARTICLEEMITTER2D_H
+#define PARTICLEEMITTER2D_H
+
+#include <memory>
+#include <cstdint>
+#include <eigen3/Eigen/Dense>
+#include "SphParticleSystemData2D.h"
+
+/**
+ * @brief Class describing an inflow boundary: a segment that emits rows of particles with a
+ * given velocity. A new row is emitted each time the previous one has travelled the particle
+ * spacing, so the emitted fluid keeps the spacing in both directions.
+ * 
+ */
+class ParticleEmitter2D {
+public:
+
+    /**
+     * @brief Construct a new ParticleEmitter2D object.
+     * 
+     * @param start: First end of the emitting segment.
+     * @param end: Second end of the emitting segment.
+     * @param velocity: Velocity of the emitted particles.
+     * @param spacing: Distance between emitted particles, along the segment and between rows.
+     * @param maxParticles: Maximum number of particles emitted over the whole run.
+     */
+    ParticleEmitter2D(Eigen::Vector2d start, Eigen::Vector2d end, Eigen::Vector2d velocity,
+        double spacing, size_t maxParticles = SIZE_MAX);
+
+    /**
+     * @brief Destructor for the ParticleEmitter2D class.
+     * 
+     */
+    ~ParticleEmitter2D();
+
+    /**
+     * @brief Emits the rows of particles due over a time step.
+     * 
+     * @param data: The particle system that receives the particles.
+     * @param timeStepSize: The time, in seconds, advanced since the last emission.
+     * @return size_t representing the number of emitted particles.
+     */
+    size_t emit(SphParticleSystemData2D& data, double timeStepSize);
+
+    /**
+     * @brief Get the number of particles emitted so far.
+     * 
+     * @return size_t representing the number of emitted particles.
+     */
+    size_t getEmittedCount();
+
+private:
+
+    /**
+     * @brief First end of the emitting segment.
+     * 
+     */
+    Eigen::Vector2d _start;
+
+    /**
+     * @brief Second end of the emitting segment.
+     * 
+     */
+    Eigen::Vector2d _end;
+
+    /**
+     * @brief Velocity of the emitted particles.
+     * 
+     */
+    Eigen::Vector2d _velocity;
+
+    /**
+     * @brief Distance between emitted particles.
+     * 
+     */
+    double _spacing;
+
+    /**
+     * @brief Maximum number of particles emitted over the whole run.
+     * 
+     */
+    size_t _maxParticles;
+
+    /**
+     * @brief Number of particles emitted so far.
+     * 
+     */
+    size_t _emittedCount = 0;
+
+    /**
+     * @brief Distance travelled by the last emitted row. A row is only emitted once the
+     * distance reaches the spacing, so particles are not emitted on top of each other.
+     * 
+     */
+    double _travelled;
+};
+
+/**
+ * @brief std::shared_ptr to the ParticleEmitter2D class.
+ * 
+ */
+typedef std::shared_ptr<ParticleEmitter2D> ParticleEmitter2DPtr;
+
+#endif // PARTICLEEMITTER2D_H
\ No newline at end of file
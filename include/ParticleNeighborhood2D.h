@@ -17,9 +17,65 @@
 #include <eigen3/Eigen/Dense>
 #include <memory>
 
+/**
+ * @brief Types of neighborhood structures that can be selected when building a particle system.
+ * 
+ */
+enum class NeighborhoodType {
+	/**
+	 * @brief Uniform grid threading a linked list of neighbors through its cells (GridNeighborhood2D).
+	 * 
+	 */
+	Grid,
+
+	/**
+	 * @brief Compact cell list built with a counting sort (CellListNeighborhood2D).
+	 * 
+	 */
+	CellList,
+
+	/**
+	 * @brief Spatial hash over unbounded cells, for sparse scenes on large domains (HashNeighborhood2D).
+	 * 
+	 */
+	Hash
+};
+
+/**
+ * @brief Struct describing a view over the neighbors of a particle: the indices of the
+ * neighbors and the distance to each of them, stored contiguously.
+ * 
+ */
+struct NeighborList2D {
+
+	/**
+	 * @brief Indices of the neighbors on the ParticleSystemData class's list of particles.
+	 * 
+	 */
+	const int *indices;
+
+	/**
+	 * @brief Distance to each neighbor.
+	 * 
+	 */
+	const double *distances;
+
+	/**
+	 * @brief Number of neighbors.
+	 * 
+	 */
+	int size;
+};
+
 /**
  * @brief Class that implements the base particle neighborhood for 2D particle systems.
  * 
+ * Threading model: build() may use OpenMP internally and must be called outside of parallel
+ * regions. forEachNearbyPoint() and forEachNeighbor() never open parallel regions: the
+ * neighbors of a particle are always visited serially, on the calling thread. They are meant
+ * to be called from per-particle parallel loops where each iteration only writes to the
+ * entries of its own particle, so the callbacks need no synchronization.
+ * 
  */
 class ParticleNeighborhood2D
 {
@@ -59,6 +115,33 @@ public:
 		const int origin,
 		const ForEachNearbyPointFunc& callback) const = 0;
 
+	/**
+	 * @brief Get a view over the neighbors of the given particle, valid until the next build.
+	 * 
+	 * @param origin: Index of the particle.
+	 * @return NeighborList2D representing the neighbors of the particle.
+	 */
+	virtual NeighborList2D getNeighbors(const int origin) const = 0;
+
+	/**
+	 * @brief Loop through all neighbor particles of the given particle, invoking callback
+	 * on each neighbor. Unlike forEachNearbyPoint, there is a single virtual call per
+	 * particle and the callback can be inlined, so this is the path used by the solvers.
+	 * 
+	 * @tparam Callback: callable type taking the neighbor index and distance.
+	 * @param origin: Index of the particle that will have it's neighborhood
+	 * looped through. 
+	 * @param callback: Callback function to be invoked on each neighbor. 
+	 */
+	template <typename Callback>
+	void forEachNeighbor(const int origin, const Callback& callback) const {
+		const NeighborList2D neighbors = getNeighbors(origin);
+
+		for (int k = 0; k < neighbors.size; k++) {
+			callback(neighbors.indices[k], neighbors.distances[k]);
+		}
+	}
+
 	/**
 	 * @brief Builds the neighorhood's iternal structure.
 	 * 
@@ -82,6 +165,78 @@ public:
 	 * @param kernelRadius: the kernel radius.
 	 */
 	virtual void setGridResolution(int width, int height, double kernelRadius) = 0;
+
+	/**
+	 * @brief Enables or disables sorting each neighborhood by particle index after a build.
+	 * Sorted neighborhoods are visited in the same order as an all-pairs loop.
+	 * 
+	 * @param sortByIndex: true to sort the neighborhoods by particle index.
+	 */
+	virtual void setSortByIndex(bool sortByIndex) = 0;
+
+	/**
+	 * @brief Enables or disables half neighbor lists. With half lists, each pair of particles
+	 * is stored once, on the neighborhood of the particle with the lowest index, and loops
+	 * over neighbors must apply every contribution to both particles of the pair.
+	 * 
+	 * @param halfNeighborList: true to store each pair once.
+	 */
+	virtual void setHalfNeighborList(bool halfNeighborList) = 0;
+
+	/**
+	 * @brief Checks if each pair of particles is stored once.
+	 * 
+	 * @return true if the neighborhood stores half neighbor lists.
+	 * @return false if each pair is stored on the neighborhoods of both particles.
+	 */
+	virtual bool isHalfNeighborList() const = 0;
+
+	/**
+	 * @brief Get the number of particles that had more neighbors than the neighborhood can
+	 * store on the last build, and lost some of them. Only counted when compiled with
+	 * SPH_INSTRUMENTATION, otherwise always 0.
+	 * 
+	 * @return size_t representing the number of truncated neighborhoods.
+	 */
+	virtual size_t getTruncatedCount() const;
+
+	/**
+	 * @brief Set the number of neighbors stored for each particle, starting on the next
+	 * build. Queries wider than the kernel, such as the candidates of VerletNeighborhood2D,
+	 * need more slots to keep every neighbor.
+	 * 
+	 * @param maxNeighbors: The number of neighbor slots of each particle.
+	 */
+	virtual void setMaxNeighbors(int maxNeighbors);
+
+	/**
+	 * @brief Get the number of neighbors stored for each particle.
+	 * 
+	 * @return int representing the number of neighbor slots of each particle.
+	 */
+	virtual int getMaxNeighbors() const;
+
+	/**
+	 * @brief Discards anything kept from a previous build, so the next build starts over.
+	 * Called when particles are added, removed or moved to other slots. Does nothing by
+	 * default.
+	 * 
+	 */
+	virtual void invalidate();
+
+protected:
+
+	/**
+	 * @brief Number of truncated neighborhoods on the last build.
+	 * 
+	 */
+	size_t _truncatedCount = 0;
+
+	/**
+	 * @brief Number of neighbor slots of each particle.
+	 * 
+	 */
+	int _maxNeighbors = 64;
 };
 
 /**
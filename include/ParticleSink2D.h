@@ -0,0 +1,90 @@
+/**
+ * @file ParticleSink2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the particle sink for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef PARTICLESINK2D_H
+#define PARTICLESINK2D_H
+
+#include <vector>
+#include <memory>
+#include <eigen3/Eigen/Dense>
+#include "SphParticleSystemData2D.h"
+
+/**
+ * @brief Class describing an outflow boundary: an axis aligned box that removes every
+ * particle inside it.
+ * 
+ */
+class ParticleSink2D {
+public:
+
+    /**
+     * @brief Construct a new ParticleSink2D object.
+     * 
+     * @param min: Corner of the box with the lowest coordinates.
+     * @param max: Corner of the box with the highest coordinates.
+     */
+    ParticleSink2D(Eigen::Vector2d min, Eigen::Vector2d max);
+
+    /**
+     * @brief Destructor for the ParticleSink2D class.
+     * 
+     */
+    ~ParticleSink2D();
+
+    /**
+     * @brief Removes every particle inside the box.
+     * 
+     * @param data: The particle system the particles are removed from.
+     * @return size_t representing the number of removed particles.
+     */
+    size_t absorb(SphParticleSystemData2D& data);
+
+    /**
+     * @brief Get the number of particles removed so far.
+     * 
+     * @return size_t representing the number of removed particles.
+     */
+    size_t getAbsorbedCount();
+
+private:
+
+    /**
+     * @brief Corner of the box with the lowest coordinates.
+     * 
+     */
+    Eigen::Vector2d _min;
+
+    /**
+     * @brief Corner of the box with the highest coordinates.
+     * 
+     */
+    Eigen::Vector2d _max;
+
+    /**
+     * @brief Number of particles removed so far.
+     * 
+     */
+    size_t _absorbedCount = 0;
+
+    /**
+     * @brief Slots of the particles to be removed, kept between calls to avoid allocations.
+     * 
+     */
+    std::vector<size_t> _indices;
+};
+
+/**
+ * @brief std::shared_ptr to the ParticleSink2D class.
+ * 
+ */
+typedef std::shared_ptr<ParticleSink2D> ParticleSink2DPtr;
+
+#endif // PARTICLESINK2D_H
\ No newline at end of file
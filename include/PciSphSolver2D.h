@@ -0,0 +1,244 @@
+/**
+ * @file PciSphSolver2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the predictive-corrective incompressible SPH (PCISPH) solver for 2D
+ * particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef PCISPHSOLVER2D_H
+#define PCISPHSOLVER2D_H
+
+#include "SphSolver2D.h"
+#include "FixedOrderSum.h"
+#include <eigen3/Eigen/Dense>
+#include <vector>
+
+/**
+ * @brief Struct describing when the pressure correction of PciSphSolver2D stops.
+ * 
+ */
+struct PressureSolverSettings {
+
+    /**
+     * @brief Average relative compression of the predicted densities over the rest density
+     * that ends the iterations. The average converges in a few iterations, where the largest
+     * compression, found on the particles pressed against the boundaries, needs dozens.
+     * 
+     */
+    double densityErrorTolerance = 0.01;
+
+    /**
+     * @brief Number of iterations that always run, even below the tolerance.
+     * 
+     */
+    int minIterations = 3;
+
+    /**
+     * @brief Number of iterations after which the step goes on above the tolerance.
+     * 
+     */
+    int maxIterations = 50;
+};
+
+/**
+ * @brief Class that implements the predictive-corrective incompressible SPH solver of
+ * Solenthaler and Pajarola for 2D particle systems.
+ * 
+ * Instead of the stiff equation of state of the base solver, each step predicts the
+ * positions and densities of the particles and corrects their pressures until the densities
+ * are, on average, within a tolerance of the rest density. The corrected pressures are kept
+ * on the "correctedPressures" attribute as the first guess of the next step. The viscosity
+ * and gravity forces are the ones of the base solver, and the projected positions, density
+ * variations and pressure variations of the particle system hold the predicted positions,
+ * the predicted density errors and the last pressure corrections.
+ * 
+ */
+class PciSphSolver2D : public SphSolver2D
+{
+public:
+
+    /**
+     * @brief Construct a new PciSphSolver2D object with a block of particles at half the
+     * kernel radius from each other, resting on the floor.
+     * 
+     * @param numberOfParticles: Number of particles to added to the system.
+     * @param fileName: Name of the file to write the simulation data to. Empty to disable writing.
+     * @param neighborhoodType: Type of neighborhood structure used to find neighbor particles.
+     */
+    PciSphSolver2D(int numberOfParticles, std::string fileName = "",
+        NeighborhoodType neighborhoodType = NeighborhoodType::Grid);
+
+    /**
+     * @brief Destructor for PciSphSolver2D.
+     * 
+     */
+    ~PciSphSolver2D();
+
+    /**
+     * @brief Perform one time step for the system, updating the parameters of each aprticle.
+     * 
+     */
+    void update() override;
+
+    /**
+     * @brief Set the precision of the solver steps. Only double precision is supported, since
+     * the pressure correction steps have no single precision attributes.
+     * 
+     * @param precision: The precision.
+     * @return true if the precision is SolverPrecision::Double.
+     * @return false otherwise.
+     */
+    bool setPrecision(SolverPrecision precision) override;
+
+    /**
+     * @brief Set the size of the time steps, and the pressure correction factor that follows it.
+     * 
+     * @param timeStepSizeInSeconds: The size of the time steps.
+     */
+    void setTimeStepSize(double timeStepSizeInSeconds);
+
+    /**
+     * @brief Set when the pressure correction stops.
+     * 
+     * @param settings: The pressure solver settings.
+     */
+    void setPressureSolverSettings(const PressureSolverSettings& settings);
+
+    /**
+     * @brief Get the number of pressure correction iterations run by the last update.
+     * 
+     * @return int representing the number of iterations.
+     */
+    int getPressureIterations();
+
+    /**
+     * @brief Get the average relative compression of the predicted densities over the rest
+     * density on the last iteration of the last update.
+     * 
+     * @return double representing the density error.
+     */
+    double getDensityError();
+
+protected:
+
+    /**
+     * @brief Name of the solver stored on checkpoints.
+     * 
+     * @return std::string representing the name of the solver.
+     */
+    std::string getCheckpointName() override;
+
+    /**
+     * @brief Writes the parameters of the solver to a binary stream.
+     * 
+     * @param stream: The stream to write to.
+     */
+    void writeState(std::ostream& stream) override;
+
+    /**
+     * @brief Reads the parameters written by writeState from a binary stream.
+     * 
+     * @param stream: The stream to read from.
+     * @return true if the parameters were read.
+     * @return false otherwise.
+     */
+    bool readState(std::istream& stream) override;
+
+private:
+
+    /**
+     * @brief When the pressure correction stops.
+     * 
+     */
+    PressureSolverSettings _pressureSolverSettings;
+
+    /**
+     * @brief Factor from a density error to the pressure that corrects it, computed on a
+     * particle with a full neighborhood.
+     * 
+     */
+    double _pressureCorrectionFactor = 0.0;
+
+    /**
+     * @brief Number of pressure correction iterations run by the last update.
+     * 
+     */
+    int _pressureIterations = 0;
+
+    /**
+     * @brief Density error of the last iteration of the last update.
+     * 
+     */
+    double _densityError = 0.0;
+
+    /**
+     * @brief Acceleration of each particle caused by the pressures.
+     * 
+     */
+    std::vector<Eigen::Vector2d> _pressureAccelerations;
+
+    /**
+     * @brief Kernel gradient of each neighbor of each particle at the start of the step, in
+     * the order of the neighbor lists.
+     * 
+     */
+    std::vector<Eigen::Vector2d> _kernelGradients;
+
+    /**
+     * @brief Offset of the first neighbor of each particle on _kernelGradients.
+     * 
+     */
+    std::vector<size_t> _gradientOffsets;
+
+    /**
+     * @brief Sum of the density errors in the deterministic mode.
+     * 
+     */
+    FixedOrderSum<double> _densityErrorSum;
+
+    /**
+     * @brief Computes the rest density and the pressure correction factor on a particle
+     * surrounded by a full neighborhood at the initial spacing.
+     * 
+     */
+    void computePressureCorrectionFactor();
+
+    /**
+     * @brief Computes the kernel gradient of each neighbor of each particle.
+     * 
+     */
+    void computeKernelGradients();
+
+    /**
+     * @brief Predicts the velocities and positions of the particles under the current
+     * pressure accelerations, keeping the positions inside the boundaries.
+     * 
+     */
+    void predictPositions();
+
+    /**
+     * @brief Computes the densities at the predicted positions and corrects the pressures.
+     * 
+     * @return double representing the average relative compression.
+     */
+    double correctPressures();
+
+    /**
+     * @brief Computes the acceleration of each particle caused by the pressures.
+     * 
+     */
+    void computePressureAccelerations();
+};
+
+/**
+ * @brief std::shared_ptr for PciSphSolver2D.
+ * 
+ */
+typedef std::shared_ptr<PciSphSolver2D> PciSphSolver2DPtr;
+
+#endif // PCISPHSOLVER2D_H
\ No newline at end of file
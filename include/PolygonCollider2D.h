@@ -0,0 +1,75 @@
+/**
+ * @file PolygonCollider2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the polygon collider for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef POLYGONCOLLIDER2D_H
+#define POLYGONCOLLIDER2D_H
+
+#include "SdfCollider2D.h"
+
+/**
+ * @brief Class describing a static obstacle shaped as a simple polygon, convex or not. The exact
+ * signed distance of the polygon is sampled into the grid of SdfCollider2D once, on
+ * construction, so lookups do not depend on the number of vertices.
+ * 
+ */
+class PolygonCollider2D : public SdfCollider2D {
+public:
+
+    /**
+     * @brief Construct a new PolygonCollider2D object.
+     * 
+     * @param vertices: The vertices of the polygon, in order along its border. The collider is
+     * invalid with fewer than 3 vertices.
+     * @param cellSize: Distance between the nodes of the sampled grid.
+     * @param margin: Distance the sampled box reaches past the polygon, at least one particle
+     * radius.
+     */
+    PolygonCollider2D(const std::vector<Eigen::Vector2d>& vertices, double cellSize, double margin);
+
+    /**
+     * @brief Destructor for the PolygonCollider2D class.
+     * 
+     */
+    ~PolygonCollider2D();
+
+    /**
+     * @brief Computes the exact signed distance of a point to a polygon: the distance to its
+     * closest edge, negative inside the polygon by the even-odd rule.
+     * 
+     * @param vertices: The vertices of the polygon, in order along its border.
+     * @param position: The point.
+     * @return double representing the signed distance.
+     */
+    static double signedDistance(const std::vector<Eigen::Vector2d>& vertices, const Eigen::Vector2d& position);
+
+    /**
+     * @brief Get the vertices of the polygon.
+     * 
+     * @return const std::vector<Eigen::Vector2d>& representing the vertices.
+     */
+    const std::vector<Eigen::Vector2d>& getVertices() const;
+
+private:
+
+    /**
+     * @brief The vertices of the polygon, in order along its border.
+     * 
+     */
+    std::vector<Eigen::Vector2d> _vertices;
+};
+
+/**
+ * @brief std::shared_ptr for PolygonCollider2D.
+ * 
+ */
+typedef std::shared_ptr<PolygonCollider2D> PolygonCollider2DPtr;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,416 @@
+/**
+ * @file RecordingReader.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements RecordingReader: a class that streams the positions of recorded
+ * runs, from CSV files or binary snapshot files.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef RECORDINGREADER_H
+#define RECORDINGREADER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omp.h>
+#include <eigen3/Eigen/Dense>
+#include "SnapshotReader.h"
+
+/**
+ * @brief Enum with the formats of recorded runs.
+ * 
+ */
+enum class RecordingFormat {
+    Csv,
+    Binary
+};
+
+/**
+ * @brief This class reads the positions of every frame of a recorded run, written either as a
+ * CSV file by CsvWriter, one row of "x y" cells per frame, or as a binary snapshot file.
+ * 
+ * CSV files are memory mapped and indexed on construction: the threads split the file into
+ * chunks and look for the ends of the rows in parallel, so any frame can then be parsed
+ * directly, without reading the ones before it. Rows are parsed in place with std::from_chars,
+ * straight into the caller's vector, so reading a frame allocates nothing once the vector has
+ * grown to the number of particles. Binary files are read through SnapshotReader.
+ * 
+ * Reading a single frame is thread safe for CSV files and uncompressed binary files.
+ * forEachFrame decodes frames in parallel for both formats, giving each thread its own
+ * SnapshotReader for binary files and a contiguous range of frames, so compressed frames are
+ * decoded from the previous frame of the same thread.
+ * 
+ */
+class RecordingReader {
+public:
+
+    /**
+     * @brief Construct a new RecordingReader object. Binary snapshot files are recognized by
+     * their magic, and any other file is read as CSV.
+     * 
+     * @param fileName: Name of the file.
+     */
+    RecordingReader(const std::string& fileName) : fileName(fileName) {
+        int descriptor = open(fileName.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return;
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                data = static_cast<const char *>(mapping);
+                size = status.st_size;
+            }
+        }
+        close(descriptor);
+
+        if (!data) {
+            return;
+        }
+
+        if (size >= sizeof(SNAPSHOT_MAGIC) && std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0) {
+            unmap();
+            format = RecordingFormat::Binary;
+            snapshot = std::make_unique<SnapshotReader>(fileName);
+            positionsField = snapshot->getFieldIndex("positions");
+
+            if (!snapshot->isOpen() || positionsField < 0 ||
+                snapshot->getFields()[positionsField].components != 2) {
+                snapshot.reset();
+                return;
+            }
+
+            numberOfFrames = snapshot->getNumberOfFrames();
+            numberOfParticles = snapshot->getNumberOfParticles(0);
+            return;
+        }
+
+        format = RecordingFormat::Csv;
+        indexRows();
+
+        std::vector<Eigen::Vector2d> positions;
+        if (numberOfFrames > 0 && readPositions(0, positions)) {
+            numberOfParticles = positions.size();
+        }
+    }
+
+    /**
+     * @brief Destructor for the RecordingReader class. Unmaps the file.
+     * 
+     */
+    ~RecordingReader() {
+        unmap();
+    }
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    /**
+     * @brief Checks if the file can be read: a mapped CSV file, or a valid binary snapshot
+     * file with a positions field of two components.
+     * 
+     * @return true if the file can be read.
+     * @return false otherwise.
+     */
+    bool isOpen() const {
+        return data != nullptr || snapshot != nullptr;
+    }
+
+    /**
+     * @brief Format of the file.
+     * 
+     * @return RecordingFormat representing the format.
+     */
+    RecordingFormat getFormat() const {
+        return format;
+    }
+
+    /**
+     * @brief Number of frames on the file.
+     * 
+     * @return size_t representing the number of frames.
+     */
+    size_t getNumberOfFrames() const {
+        return numberOfFrames;
+    }
+
+    /**
+     * @brief Number of particles on the first frame. The frames of runs with emitters or
+     * sinks may hold a different number of particles each.
+     * 
+     * @return size_t representing the number of particles.
+     */
+    size_t getNumberOfParticles() const {
+        return numberOfParticles;
+    }
+
+    /**
+     * @brief Reads the positions of a frame.
+     * 
+     * @param frame: Index of the frame.
+     * @param positions: Receives the positions, replacing its contents but keeping its
+     * capacity.
+     * @return true if the frame exists and was read.
+     * @return false otherwise, such as for a malformed CSV row.
+     */
+    bool readPositions(size_t frame, std::vector<Eigen::Vector2d>& positions) const {
+        return readPositions(frame, positions, snapshot.get());
+    }
+
+    /**
+     * @brief Reads the frames first, first + stride, ... before last in parallel, calling the
+     * visitor with the positions of each frame on the thread that decoded it.
+     * 
+     * @tparam Visitor: type of the function called for each frame.
+     * @param visitor: Function called with the index of each frame and its positions, from
+     * several threads at the same time, so it may only write to data of its own frame.
+     * @param first: Index of the first frame.
+     * @param last: Index of the frame after the last one, clamped to the number of frames.
+     * @param stride: Distance between two visited frames.
+     * @return true if every frame was read.
+     * @return false otherwise. The frames that were read were still visited.
+     */
+    template <typename Visitor>
+    bool forEachFrame(const Visitor& visitor, size_t first = 0, size_t last = SIZE_MAX, size_t stride = 1) const {
+        last = std::min(last, numberOfFrames);
+        stride = std::max<size_t>(1, stride);
+        const long count = first < last ? (last - first + stride - 1) / stride : 0;
+        bool valid = isOpen();
+
+        #pragma omp parallel reduction(&&: valid)
+        {
+            std::vector<Eigen::Vector2d> positions;
+            std::unique_ptr<SnapshotReader> threadSnapshot;
+
+            if (snapshot) {
+                threadSnapshot = std::make_unique<SnapshotReader>(fileName);
+            }
+
+            // Contiguous frames per thread, so compressed frames decode from the previous one.
+            #pragma omp for schedule(static)
+            for (long k = 0; k < count; k++) {
+                const size_t frame = first + k * stride;
+
+                if (readPositions(frame, positions, threadSnapshot.get())) {
+                    visitor(frame, positions);
+                } else {
+                    valid = false;
+                }
+            }
+        }
+
+        return valid;
+    }
+
+protected:
+
+    /**
+     * @brief Name of the file.
+     * 
+     */
+    std::string fileName;
+
+    /**
+     * @brief Format of the file.
+     * 
+     */
+    RecordingFormat format = RecordingFormat::Csv;
+
+    /**
+     * @brief Start of the mapped CSV file.
+     * 
+     */
+    const char *data = nullptr;
+
+    /**
+     * @brief Size, in bytes, of the mapped CSV file.
+     * 
+     */
+    size_t size = 0;
+
+    /**
+     * @brief Offset of the start of each row of the CSV file, with the size of the file at the
+     * end.
+     * 
+     */
+    std::vector<size_t> rowOffsets;
+
+    /**
+     * @brief The reader of a binary file.
+     * 
+     */
+    std::unique_ptr<SnapshotReader> snapshot;
+
+    /**
+     * @brief Index of the positions field of a binary file.
+     * 
+     */
+    int positionsField = -1;
+
+    /**
+     * @brief Number of frames on the file.
+     * 
+     */
+    size_t numberOfFrames = 0;
+
+    /**
+     * @brief Number of particles on the first frame.
+     * 
+     */
+    size_t numberOfParticles = 0;
+
+    /**
+     * @brief Finds the start of every row of the CSV file. Each thread looks for the ends of
+     * the rows in one chunk of the file, and the chunks are joined in order.
+     * 
+     */
+    void indexRows() {
+        const int numberOfChunks = omp_get_max_threads();
+        std::vector<std::vector<size_t>> chunkOffsets(numberOfChunks);
+
+        #pragma omp parallel for schedule(static, 1)
+        for (int chunk = 0; chunk < numberOfChunks; chunk++) {
+            const char *start = data + size * chunk / numberOfChunks;
+            const char *end = data + size * (chunk + 1) / numberOfChunks;
+
+            while ((start = static_cast<const char *>(std::memchr(start, '\n', end - start))) != nullptr) {
+                chunkOffsets[chunk].push_back(++start - data);
+            }
+        }
+
+        rowOffsets.assign(1, 0);
+        for (const std::vector<size_t>& offsets : chunkOffsets) {
+            rowOffsets.insert(rowOffsets.end(), offsets.begin(), offsets.end());
+        }
+
+        // A row is only dropped if it is empty, such as after a newline at the end of the file.
+        if (rowOffsets.back() != size) {
+            rowOffsets.push_back(size);
+        }
+        numberOfFrames = rowOffsets.size() - 1;
+    }
+
+    /**
+     * @brief Reads the positions of a frame.
+     * 
+     * @param frame: Index of the frame.
+     * @param positions: Receives the positions.
+     * @param reader: The reader of a binary file, nullptr for CSV files.
+     * @return true if the frame exists and was read.
+     * @return false otherwise.
+     */
+    bool readPositions(size_t frame, std::vector<Eigen::Vector2d>& positions, const SnapshotReader *reader) const {
+        positions.clear();
+
+        if (frame >= numberOfFrames) {
+            return false;
+        }
+
+        if (format == RecordingFormat::Binary) {
+            if (!reader) {
+                return false;
+            }
+
+            const size_t particles = reader->getNumberOfParticles(frame);
+            positions.resize(particles);
+            return particles == 0 || decodePositions(frame, positions, *reader);
+        }
+
+        const char *cell = data + rowOffsets[frame];
+        const char *end = data + rowOffsets[frame + 1];
+
+        while (end > cell && (end[-1] == '\n' || end[-1] == '\r')) {
+            end--;
+        }
+
+        while (cell < end) {
+            Eigen::Vector2d position;
+            std::from_chars_result x = std::from_chars(cell, end, position(0));
+
+            if (x.ec != std::errc() || x.ptr == end || *x.ptr != ' ') {
+                return false;
+            }
+
+            std::from_chars_result y = std::from_chars(x.ptr + 1, end, position(1));
+
+            if (y.ec != std::errc() || (y.ptr != end && *y.ptr != ';')) {
+                return false;
+            }
+
+            positions.push_back(position);
+            cell = y.ptr + 1;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Converts the positions field of a frame of a binary file, decoding the frame
+     * once.
+     * 
+     * @param frame: Index of the frame.
+     * @param positions: Receives the positions, already sized to the number of particles of
+     * the frame.
+     * @param reader: The reader of the binary file.
+     * @return true if the field was read.
+     * @return false otherwise.
+     */
+    bool decodePositions(size_t frame, std::vector<Eigen::Vector2d>& positions, const SnapshotReader& reader) const {
+        const size_t particles = positions.size();
+
+        if (reader.getPrecision() == SnapshotPrecision::Double) {
+            const double *values = reader.getField<double>(frame, positionsField);
+            if (!values) {
+                return false;
+            }
+            for (size_t i = 0; i < particles; i++) {
+                positions[i] = Eigen::Vector2d(values[2 * i], values[2 * i + 1]);
+            }
+        } else if (reader.getPrecision() == SnapshotPrecision::Single) {
+            const float *values = reader.getField<float>(frame, positionsField);
+            if (!values) {
+                return false;
+            }
+            for (size_t i = 0; i < particles; i++) {
+                positions[i] = Eigen::Vector2d(values[2 * i], values[2 * i + 1]);
+            }
+        } else {
+            const uint16_t *values = reader.getField<uint16_t>(frame, positionsField);
+            if (!values) {
+                return false;
+            }
+            for (size_t i = 0; i < particles; i++) {
+                positions[i] = Eigen::Vector2d(halfToFloat(values[2 * i]), halfToFloat(values[2 * i + 1]));
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Unmaps the CSV file.
+     * 
+     */
+    void unmap() {
+        if (data) {
+            munmap(const_cast<char *>(data), size);
+            data = nullptr;
+        }
+    }
+};
+
+#endif // RECORDINGREADER_H
\ No newline at end of file
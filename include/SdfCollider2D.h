@@ -0,0 +1,151 @@
+/**
+ * @file SdfCollider2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the signed distance field collider for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SDFCOLLIDER2D_H
+#define SDFCOLLIDER2D_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <eigen3/Eigen/Dense>
+
+/**
+ * @brief Class describing a static obstacle by its signed distance field: negative inside the
+ * obstacle and positive outside. The distances are sampled once, on the nodes of a regular
+ * grid over a box around the obstacle, so each lookup costs one bilinear interpolation of four
+ * nodes whatever the shape of the obstacle. Outside the box, particles are taken as clear of
+ * the obstacle, so the box must reach at least one particle radius past the obstacle.
+ * Invalid arguments leave the collider without nodes, so it rejects every lookup and the
+ * solvers refuse to add it.
+ * 
+ */
+class SdfCollider2D {
+public:
+
+    /**
+     * @brief Construct a new SdfCollider2D object sampling a signed distance function.
+     * 
+     * @param min: Corner of the sampled box with the lowest coordinates.
+     * @param max: Corner of the sampled box with the highest coordinates.
+     * @param cellSize: Distance between the nodes of the grid.
+     * @param signedDistance: Function that gives the signed distance of a point to the obstacle.
+     * The collider is invalid if cellSize is not positive or max is below min.
+     */
+    SdfCollider2D(Eigen::Vector2d min, Eigen::Vector2d max, double cellSize,
+        const std::function<double(const Eigen::Vector2d&)>& signedDistance);
+
+    /**
+     * @brief Construct a new SdfCollider2D object from distances already sampled, such as a
+     * field loaded from a file.
+     * 
+     * @param min: Position of the first node of the grid.
+     * @param cellSize: Distance between the nodes of the grid.
+     * @param width: Number of nodes along x.
+     * @param height: Number of nodes along y.
+     * @param distances: The width * height distances, row by row from the lowest y. The
+     * collider is invalid if there are fewer than 2 nodes along an axis, the number of distances
+     * does not match or cellSize is not positive.
+     */
+    SdfCollider2D(Eigen::Vector2d min, double cellSize, int width, int height,
+        std::vector<double> distances);
+
+    /**
+     * @brief Destructor for the SdfCollider2D class.
+     * 
+     */
+    virtual ~SdfCollider2D();
+
+    /**
+     * @brief Check whether the collider was built from valid arguments.
+     * 
+     * @return true if the collider has sampled distances, false otherwise.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Looks up the signed distance and the outward normal of the obstacle at a point.
+     * 
+     * @param position: The point.
+     * @param distance: Receives the interpolated signed distance.
+     * @param normal: Receives the normalized gradient of the interpolated distance.
+     * @return true if the point is inside the sampled box, false otherwise, leaving distance
+     * and normal unchanged.
+     */
+    bool lookup(const Eigen::Vector2d& position, double& distance, Eigen::Vector2d& normal) const;
+
+    /**
+     * @brief Get the interpolated signed distance of the obstacle at a point.
+     * 
+     * @param position: The point.
+     * @return double representing the distance, or infinity outside the sampled box.
+     */
+    double getDistance(const Eigen::Vector2d& position) const;
+
+    /**
+     * @brief Get the corner of the sampled box with the lowest coordinates.
+     * 
+     * @return Eigen::Vector2d representing the corner.
+     */
+    Eigen::Vector2d getMin() const;
+
+    /**
+     * @brief Get the corner of the sampled box with the highest coordinates.
+     * 
+     * @return Eigen::Vector2d representing the corner.
+     */
+    Eigen::Vector2d getMax() const;
+
+protected:
+
+    /**
+     * @brief Drops the sampled distances, leaving the collider invalid.
+     * 
+     */
+    void invalidate();
+
+    /**
+     * @brief Position of the first node of the grid.
+     * 
+     */
+    Eigen::Vector2d _min;
+
+    /**
+     * @brief Distance between the nodes of the grid.
+     * 
+     */
+    double _cellSize;
+
+    /**
+     * @brief Number of nodes along x.
+     * 
+     */
+    int _width;
+
+    /**
+     * @brief Number of nodes along y.
+     * 
+     */
+    int _height;
+
+    /**
+     * @brief The sampled distances, row by row from the lowest y.
+     * 
+     */
+    std::vector<double> _distances;
+};
+
+/**
+ * @brief std::shared_ptr for SdfCollider2D.
+ * 
+ */
+typedef std::shared_ptr<SdfCollider2D> SdfCollider2DPtr;
+
+#endif
\ No newline at end of file
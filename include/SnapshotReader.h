@@ -0,0 +1,604 @@
+/**
+ * @file SnapshotReader.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements SnapshotReader: a class that reads binary snapshot files.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SNAPSHOTREADER_H
+#define SNAPSHOTREADER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <eigen3/Eigen/Dense>
+#include "SnapshotWriter.h"
+
+/**
+ * @brief This class reads binary snapshot files written by SnapshotWriter.
+ * 
+ * The file is memory mapped and only the frame sizes are read past the header, to index the
+ * frames when the file is opened: any frame can then be accessed directly, and the values of
+ * a field are returned as a pointer into the mapping. Frames of
+ * compressed files are decoded into a buffer owned by the reader instead, starting from the
+ * last keyframe, or from the previous frame when frames are read in order.
+ * 
+ */
+class SnapshotReader {
+public:
+
+    /**
+     * @brief Construct a new SnapshotReader object, mapping the file and reading its header.
+     * 
+     * @param fileName: Name of the file.
+     */
+    SnapshotReader(const std::string& fileName) {
+        int descriptor = open(fileName.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return;
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                data = static_cast<const char *>(mapping);
+                size = status.st_size;
+            }
+        }
+        close(descriptor);
+
+        if (data && !readHeader()) {
+            unmap();
+        }
+    }
+
+    /**
+     * @brief Destructor for the SnapshotReader class. Unmaps the file.
+     * 
+     */
+    ~SnapshotReader() {
+        unmap();
+    }
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    /**
+     * @brief Checks if the file was mapped and has a valid header.
+     * 
+     * @return true if the file can be read.
+     * @return false otherwise.
+     */
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    /**
+     * @brief Number of complete frames on the file.
+     * 
+     * @return size_t representing the number of frames.
+     */
+    size_t getNumberOfFrames() const {
+        return numberOfFrames;
+    }
+
+    /**
+     * @brief Number of particles on the header, which every frame holds on version 1 and 2
+     * files. Frames of later versions hold their own number of particles.
+     * 
+     * @return size_t representing the number of particles.
+     */
+    size_t getNumberOfParticles() const {
+        return numberOfParticles;
+    }
+
+    /**
+     * @brief Number of particles on a frame.
+     * 
+     * @param frame: Index of the frame.
+     * @return size_t representing the number of particles, or 0 if the frame does not exist.
+     */
+    size_t getNumberOfParticles(size_t frame) const {
+        return frame < numberOfFrames ? frameParticles[frame] : 0;
+    }
+
+    /**
+     * @brief Checks if every frame stores the id of each particle.
+     * 
+     * @return true if the frames store ids.
+     * @return false otherwise.
+     */
+    bool storesIds() const {
+        return storeIds;
+    }
+
+    /**
+     * @brief Get the id of each particle of a frame. The ids are never copied.
+     * 
+     * @param frame: Index of the frame.
+     * @return const uint64_t* pointing to getNumberOfParticles(frame) ids, or nullptr if the
+     * frame does not exist or the file stores no ids.
+     */
+    const uint64_t* getIds(size_t frame) const {
+        if (frame >= numberOfFrames || !storeIds) {
+            return nullptr;
+        }
+        return reinterpret_cast<const uint64_t *>(data + idOffsets[frame]);
+    }
+
+    /**
+     * @brief Time, in seconds, between two frames.
+     * 
+     * @return double representing the time step.
+     */
+    double getTimeStep() const {
+        return timeStep;
+    }
+
+    /**
+     * @brief Precision of the stored values.
+     * 
+     * @return SnapshotPrecision representing the precision.
+     */
+    SnapshotPrecision getPrecision() const {
+        return precision;
+    }
+
+    /**
+     * @brief Compression of the frames.
+     * 
+     * @return SnapshotCompression representing the compression.
+     */
+    SnapshotCompression getCompression() const {
+        return compression;
+    }
+
+    /**
+     * @brief Fields stored on every frame.
+     * 
+     * @return const std::vector<SnapshotField>& representing the fields, in file order.
+     */
+    const std::vector<SnapshotField>& getFields() const {
+        return fields;
+    }
+
+    /**
+     * @brief Get the index of a field.
+     * 
+     * @param name: Name of the field.
+     * @return int representing the index of the field, or -1 if there is no such field.
+     */
+    int getFieldIndex(const std::string& name) const {
+        for (size_t field = 0; field < fields.size(); field++) {
+            if (fields[field].name == name) {
+                return field;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Get the values of a field on a frame. Values of uncompressed files are not copied,
+     * while values of compressed files are only valid until another frame is accessed.
+     * 
+     * @tparam T: uint16_t for half precision files, holding the bits of each value, float
+     * for single precision files and double for double precision files.
+     * @param frame: Index of the frame.
+     * @param field: Index of the field.
+     * @return const T* pointing to getNumberOfParticles(frame) * components values, or nullptr
+     * if the frame or the field do not exist or T does not match the precision of the file.
+     */
+    template<typename T>
+    const T* getField(size_t frame, size_t field) const {
+        if (frame >= numberOfFrames || field >= fields.size() || sizeof(T) != static_cast<size_t>(precision)) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T *>(getFrame(frame)) + fieldOffsets[field] * frameParticles[frame];
+    }
+
+    /**
+     * @brief Get one value of a field, in double precision.
+     * 
+     * @param frame: Index of the frame.
+     * @param field: Index of the field.
+     * @param particle: Index of the particle.
+     * @param component: Index of the value on the particle.
+     * @param value: Receives the value.
+     * @return true if the value exists and was read.
+     * @return false if the frame, the field, the particle or the component do not exist.
+     */
+    bool getValue(size_t frame, size_t field, size_t particle, size_t component, double& value) const {
+        if (field >= fields.size() || particle >= getNumberOfParticles(frame) || component >= fields[field].components) {
+            return false;
+        }
+
+        const size_t index = particle * fields[field].components + component;
+
+        if (precision == SnapshotPrecision::Double) {
+            const double *values = getField<double>(frame, field);
+            if (!values) {
+                return false;
+            }
+            value = values[index];
+        } else if (precision == SnapshotPrecision::Single) {
+            const float *values = getField<float>(frame, field);
+            if (!values) {
+                return false;
+            }
+            value = values[index];
+        } else {
+            const uint16_t *values = getField<uint16_t>(frame, field);
+            if (!values) {
+                return false;
+            }
+            value = halfToFloat(values[index]);
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Get the value of a field with two components as a 2D vector.
+     * 
+     * @param frame: Index of the frame.
+     * @param field: Index of the field.
+     * @param particle: Index of the particle.
+     * @param value: Receives the value.
+     * @return true if the value exists and was read.
+     * @return false if the frame, the field or the particle do not exist, or the field has
+     * less than two components.
+     */
+    bool getVector2d(size_t frame, size_t field, size_t particle, Eigen::Vector2d& value) const {
+        return getValue(frame, field, particle, 0, value(0)) && getValue(frame, field, particle, 1, value(1));
+    }
+
+protected:
+
+    /**
+     * @brief Start of the mapped file.
+     * 
+     */
+    const char *data = nullptr;
+
+    /**
+     * @brief Size, in bytes, of the mapped file.
+     * 
+     */
+    size_t size = 0;
+
+    /**
+     * @brief Size, in bytes, of the header.
+     * 
+     */
+    size_t headerSize = 0;
+
+    /**
+     * @brief Number of values of every field on one particle.
+     * 
+     */
+    size_t valuesPerParticle = 0;
+
+    /**
+     * @brief Number of complete frames on the file.
+     * 
+     */
+    size_t numberOfFrames = 0;
+
+    /**
+     * @brief Number of particles on the header.
+     * 
+     */
+    size_t numberOfParticles = 0;
+
+    /**
+     * @brief If true, every frame stores the id of each particle.
+     * 
+     */
+    bool storeIds = false;
+
+    /**
+     * @brief Time, in seconds, between two frames.
+     * 
+     */
+    double timeStep = 0.0;
+
+    /**
+     * @brief Precision of the stored values.
+     * 
+     */
+    SnapshotPrecision precision = SnapshotPrecision::Double;
+
+    /**
+     * @brief Compression of the frames.
+     * 
+     */
+    SnapshotCompression compression = SnapshotCompression::None;
+
+    /**
+     * @brief Number of frames between two frames stored without delta.
+     * 
+     */
+    uint32_t keyframeInterval = 1;
+
+    /**
+     * @brief Offset, in bytes, of the values of each frame on the file, or of the compressed
+     * values of compressed files.
+     * 
+     */
+    std::vector<size_t> frameOffsets;
+
+    /**
+     * @brief Number of particles on each frame.
+     * 
+     */
+    std::vector<size_t> frameParticles;
+
+    /**
+     * @brief Offset, in bytes, of the ids of each frame on the file, if it stores ids.
+     * 
+     */
+    std::vector<size_t> idOffsets;
+
+    /**
+     * @brief If true, the frame of the same index is compressed without delta.
+     * 
+     */
+    std::vector<bool> keyframes;
+
+    /**
+     * @brief The last decoded frame of a compressed file.
+     * 
+     */
+    mutable std::vector<char> decodedFrame;
+
+    /**
+     * @brief Index of the last decoded frame, or numberOfFrames if there is none.
+     * 
+     */
+    mutable size_t decodedFrameIndex = 0;
+
+    /**
+     * @brief Fields stored on every frame.
+     * 
+     */
+    std::vector<SnapshotField> fields;
+
+    /**
+     * @brief Number of values of the fields before each field on one particle. The values of
+     * a field start at fieldOffsets[field] * particles values into its frame.
+     * 
+     */
+    std::vector<size_t> fieldOffsets;
+
+    /**
+     * @brief Reads a value of the header, advancing the offset.
+     * 
+     * @tparam T: type of the value.
+     * @param offset: Offset of the value, updated to the end of the value.
+     * @param value: The value that will be read.
+     * @return true if the value is inside the file.
+     * @return false otherwise.
+     */
+    template<typename T>
+    bool read(size_t& offset, T& value) const {
+        if (offset + sizeof(T) > size) {
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Reads the header of the file and indexes its frames.
+     * 
+     * @return true if the header is valid.
+     * @return false otherwise.
+     */
+    bool readHeader() {
+        size_t offset = sizeof(SNAPSHOT_MAGIC);
+        uint32_t version, precisionBytes, compressionType = 0, ids = 0, numberOfFields;
+        uint64_t particles;
+
+        if (size < offset || std::memcmp(data, SNAPSHOT_MAGIC, offset) != 0) {
+            return false;
+        }
+
+        // Version 1 files have no compression fields, and version 2 files have no ids.
+        if (!read(offset, version) || version < 1 || version > SNAPSHOT_VERSION || !read(offset, precisionBytes)) {
+            return false;
+        }
+
+        if (version >= 2 && (!read(offset, compressionType) || !read(offset, keyframeInterval))) {
+            return false;
+        }
+
+        if (version >= 3 && (!read(offset, ids) || ids > 1)) {
+            return false;
+        }
+
+        if (!read(offset, particles) || !read(offset, timeStep) || !read(offset, numberOfFields)) {
+            return false;
+        }
+
+        if (precisionBytes != static_cast<uint32_t>(SnapshotPrecision::Half) &&
+            precisionBytes != static_cast<uint32_t>(SnapshotPrecision::Single) &&
+            precisionBytes != static_cast<uint32_t>(SnapshotPrecision::Double)) {
+            return false;
+        }
+
+        if (compressionType > static_cast<uint32_t>(SnapshotCompression::Delta) || keyframeInterval < 1) {
+            return false;
+        }
+
+        precision = static_cast<SnapshotPrecision>(precisionBytes);
+        compression = static_cast<SnapshotCompression>(compressionType);
+        numberOfParticles = particles;
+        storeIds = ids == 1;
+        valuesPerParticle = 0;
+
+        for (uint32_t field = 0; field < numberOfFields; field++) {
+            SnapshotField snapshotField;
+            uint32_t nameLength;
+
+            if (!read(offset, snapshotField.components) || !read(offset, nameLength) || offset + nameLength > size) {
+                return false;
+            }
+
+            snapshotField.name = std::string(data + offset, nameLength);
+            offset += nameLength;
+            fields.push_back(snapshotField);
+            fieldOffsets.push_back(valuesPerParticle);
+            valuesPerParticle += snapshotField.components;
+        }
+
+        headerSize = (offset + 7) / 8 * 8;
+        if (headerSize > size) {
+            return false;
+        }
+
+        // Index the frames by hopping over their sizes. A frame cut short by the end of the
+        // file, such as while it is still being written, is left out.
+        const size_t particleSize = valuesPerParticle * precisionBytes;
+        offset = headerSize;
+
+        while (offset < size) {
+            uint64_t frameParticleCount = numberOfParticles;
+
+            if (version >= 3 && !read(offset, frameParticleCount)) {
+                break;
+            }
+
+            if (storeIds) {
+                if (frameParticleCount > (size - offset) / sizeof(uint64_t)) {
+                    break;
+                }
+                idOffsets.push_back(offset);
+                offset += frameParticleCount * sizeof(uint64_t);
+            }
+
+            uint64_t valuesSize;
+            if (compression == SnapshotCompression::Delta) {
+                if (!read(offset, valuesSize)) {
+                    break;
+                }
+            } else if (particleSize == 0 || frameParticleCount <= (size - offset) / particleSize) {
+                valuesSize = frameParticleCount * particleSize;
+            } else {
+                break;
+            }
+
+            // Version 1 and 2 files store nothing for frames without values.
+            if (valuesSize > size - offset || (version < 3 && valuesSize == 0 && compression == SnapshotCompression::None)) {
+                break;
+            }
+
+            const size_t frame = frameOffsets.size();
+            keyframes.push_back(frame % keyframeInterval == 0 || frameParticleCount != frameParticles.back());
+            frameOffsets.push_back(offset);
+            frameParticles.push_back(frameParticleCount);
+            offset += version >= 3 || compression == SnapshotCompression::Delta ? (valuesSize + 7) / 8 * 8 : valuesSize;
+        }
+
+        numberOfFrames = frameOffsets.size();
+        idOffsets.resize(storeIds ? numberOfFrames : 0);
+        decodedFrameIndex = numberOfFrames;
+        return true;
+    }
+
+    /**
+     * @brief Get the values of every field on a frame.
+     * 
+     * @param frame: Index of the frame, which must exist.
+     * @return const char* pointing to the values of the frame.
+     */
+    const char* getFrame(size_t frame) const {
+        if (compression == SnapshotCompression::None) {
+            return data + frameOffsets[frame];
+        }
+
+        if (frame != decodedFrameIndex) {
+            size_t first = frame;
+            while (!keyframes[first]) {
+                first--;
+            }
+
+            // Continue from the decoded frame if it comes after the keyframe.
+            if (decodedFrameIndex < frame && decodedFrameIndex >= first) {
+                first = decodedFrameIndex + 1;
+            }
+
+            decodedFrame.resize(frameParticles[frame] * valuesPerParticle * static_cast<size_t>(precision));
+            for (size_t current = first; current <= frame; current++) {
+                decodeFrame(current, keyframes[current]);
+            }
+            decodedFrameIndex = frame;
+        }
+
+        return decodedFrame.data();
+    }
+
+    /**
+     * @brief Decodes a compressed frame onto the decoded frame buffer.
+     * 
+     * @param frame: Index of the frame.
+     * @param keyframe: If true, the frame is not a delta of the previous one.
+     */
+    void decodeFrame(size_t frame, bool keyframe) const {
+        const size_t stride = static_cast<size_t>(precision);
+        const size_t frameSize = decodedFrame.size();
+        const size_t numberOfValues = frameSize / stride;
+        uint64_t compressedSize;
+        std::memcpy(&compressedSize, data + frameOffsets[frame] - sizeof(compressedSize), sizeof(compressedSize));
+
+        const unsigned char *input = reinterpret_cast<const unsigned char *>(data + frameOffsets[frame]);
+        const unsigned char *end = input + compressedSize;
+        std::vector<char> shuffled(frameSize, 0);
+        size_t k = 0;
+
+        while (input < end && k < frameSize) {
+            const unsigned char control = *input++;
+
+            if (control >= 128) {
+                k += control - 127;
+            } else {
+                const size_t literals = std::min<size_t>(control + 1, std::min<size_t>(end - input, frameSize - k));
+                std::memcpy(&shuffled[k], input, literals);
+                input += literals;
+                k += literals;
+            }
+        }
+
+        for (size_t value = 0; value < numberOfValues; value++) {
+            for (size_t b = 0; b < stride; b++) {
+                char byte = shuffled[b * numberOfValues + value];
+                char &decoded = decodedFrame[value * stride + b];
+                decoded = keyframe ? byte : (char) (decoded ^ byte);
+            }
+        }
+    }
+
+    /**
+     * @brief Unmaps the file.
+     * 
+     */
+    void unmap() {
+        if (data) {
+            munmap(const_cast<char *>(data), size);
+            data = nullptr;
+        }
+    }
+};
+
+#endif // SNAPSHOTREADER_H
\ No newline at end of file
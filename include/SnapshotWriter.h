@@ -0,0 +1,564 @@
+/**
+ * @file SnapshotWriter.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements SnapshotWriter: a class that writes binary snapshot files.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Magic bytes at the start of every snapshot file.
+ * 
+ */
+const static char SNAPSHOT_MAGIC[8] = {'S', 'P', 'H', 'S', 'N', 'A', 'P', '1'};
+
+/**
+ * @brief Version of the snapshot format.
+ * 
+ */
+const static uint32_t SNAPSHOT_VERSION = 3;
+
+/**
+ * @brief Precision of the values stored on a snapshot file. The value of each entry is
+ * the number of bytes of one stored value.
+ * 
+ */
+enum class SnapshotPrecision : uint32_t {
+    Half = 2,
+    Single = 4,
+    Double = 8
+};
+
+/**
+ * @brief Compression of the frames of a snapshot file.
+ * 
+ */
+enum class SnapshotCompression : uint32_t {
+    /**
+     * @brief Frames are stored as raw arrays.
+     * 
+     */
+    None = 0,
+
+    /**
+     * @brief Every frame but the keyframes stores the XOR of its values with the values of
+     * the previous frame, which is mostly zeros for slowly changing fields. The bytes are then
+     * grouped by their position inside each value and runs of zeros are encoded by length.
+     * Decoding is lossless with respect to the stored precision.
+     * 
+     */
+    Delta = 1
+};
+
+/**
+ * @brief Converts a float to a IEEE 754 half precision float, rounding to nearest even.
+ * 
+ * @param value: The float to convert.
+ * @return uint16_t representing the bits of the half precision float.
+ */
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int exponent = (int) ((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (((bits >> 23) & 0xff) == 0xff) {
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    }
+    if (exponent >= 31) {
+        return sign | 0x7c00;
+    }
+
+    uint32_t half;
+    int shift;
+
+    if (exponent <= 0) {
+        // Subnormal half: the implicit bit is shifted into the mantissa.
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        shift = 14 - exponent;
+        half = mantissa >> shift;
+    } else {
+        shift = 13;
+        half = (exponent << 10) | (mantissa >> shift);
+    }
+
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+        half++;
+    }
+
+    return sign | half;
+}
+
+/**
+ * @brief Converts a IEEE 754 half precision float to a float.
+ * 
+ * @param half: The bits of the half precision float.
+ * @return float representing the same value.
+ */
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0 && mantissa == 0) {
+        bits = sign;
+    } else if (exponent == 0) {
+        // Subnormal half: normalize the mantissa.
+        exponent = 127 - 15 + 1;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Struct describing a per-particle field stored on a snapshot file.
+ * 
+ */
+struct SnapshotField {
+
+    /**
+     * @brief Name of the field.
+     * 
+     */
+    std::string name;
+
+    /**
+     * @brief Number of values of the field on each particle.
+     * 
+     */
+    uint32_t components;
+};
+
+/**
+ * @brief This class writes binary snapshot files.
+ * 
+ * A snapshot file starts with a header holding the magic bytes, the version, the precision,
+ * the compression, the keyframe interval, whether the frames store particle ids, the number
+ * of particles given to the constructor, the time step between frames and the list of
+ * fields, padded to a multiple of 8 bytes. It is followed by the frames, in order. Each frame
+ * starts with its number of particles, as a uint64_t, followed by the id of each particle, as
+ * a uint64_t, when the file stores ids. Then it stores every field, in the order of the
+ * header, as a raw array of numberOfParticles * components values in native byte order,
+ * padded to a multiple of 8 bytes. Compressed frames store the size of the compressed values,
+ * as a uint64_t, followed by the compressed bytes, padded to a multiple of 8 bytes, instead.
+ * Frames with a different number of particles than the previous frame are keyframes. The file
+ * is kept open between frames.
+ * 
+ * Version 1 and 2 files have no ids and no number of particles on each frame: every frame
+ * holds the number of particles of the header.
+ * 
+ */
+class SnapshotWriter {
+public:
+
+    /**
+     * @brief Construct a new SnapshotWriter object, creating the file and writing its header.
+     * 
+     * @param fileName: Name of the file. An existing file is overwritten.
+     * @param numberOfParticles: Number of particles of the frames written without giving
+     * their number of particles.
+     * @param timeStep: Time, in seconds, between two frames.
+     * @param fields: Fields stored on every frame.
+     * @param precision: Precision of the stored values.
+     * @param compression: Compression of the frames.
+     * @param keyframeInterval: With delta compression, every keyframeInterval-th frame is
+     * stored without delta, so reading any frame decodes at most that many frames.
+     * @param storeIds: If true, every frame stores the id of each particle, which must then be
+     * given to writeFrame.
+     */
+    SnapshotWriter(const std::string& fileName, size_t numberOfParticles, double timeStep,
+        const std::vector<SnapshotField>& fields, SnapshotPrecision precision = SnapshotPrecision::Double,
+        SnapshotCompression compression = SnapshotCompression::None, uint32_t keyframeInterval = 16,
+        bool storeIds = false) {
+        this->numberOfParticles = numberOfParticles;
+        this->storeIds = storeIds;
+        this->fields = fields;
+        this->precision = precision;
+        this->compression = compression;
+        this->keyframeInterval = keyframeInterval < 1 ? 1 : keyframeInterval;
+        this->numberOfFrames = 0;
+
+        file.open(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (file.is_open()) {
+            writeHeader(timeStep);
+        }
+    }
+
+    /**
+     * @brief Destructor for the SnapshotWriter class. Flushes and closes the file.
+     * 
+     */
+    ~SnapshotWriter() {
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * @brief Checks if the file was opened.
+     * 
+     * @return true if the file is open.
+     * @return false if the file could not be created.
+     */
+    bool isOpen() const {
+        return file.is_open();
+    }
+
+    /**
+     * @brief Writes one frame of the number of particles given to the constructor to a file
+     * that stores no ids.
+     * 
+     * @param values: One array per field, in the order of the header, each holding
+     * numberOfParticles * components values laid out particle by particle.
+     * @return true if no error flags are set. False otherwise. (see std::ofstream::fail)
+     */
+    bool writeFrame(const std::vector<const double *>& values) {
+        return writeFrame(values, numberOfParticles, nullptr);
+    }
+
+    /**
+     * @brief Writes one frame to the file.
+     * 
+     * @param values: One array per field, in the order of the header, each holding
+     * particles * components values laid out particle by particle.
+     * @param particles: Number of particles on the frame.
+     * @param ids: Id of each particle, required if the file stores ids and ignored otherwise.
+     * @return true if no error flags are set. False otherwise. (see std::ofstream::fail)
+     */
+    bool writeFrame(const std::vector<const double *>& values, size_t particles, const uint64_t *ids) {
+        if (!file.is_open() || values.size() != fields.size() || (storeIds && !ids && particles > 0)) {
+            return false;
+        }
+
+        frame.resize(getFrameSize(particles));
+        char *data = frame.data();
+
+        for (size_t field = 0; field < fields.size(); field++) {
+            const size_t count = particles * fields[field].components;
+
+            if (precision == SnapshotPrecision::Double) {
+                std::memcpy(data, values[field], count * sizeof(double));
+            } else if (precision == SnapshotPrecision::Single) {
+                float *floats = reinterpret_cast<float *>(data);
+                for (size_t k = 0; k < count; k++) {
+                    floats[k] = values[field][k];
+                }
+            } else {
+                uint16_t *halves = reinterpret_cast<uint16_t *>(data);
+                for (size_t k = 0; k < count; k++) {
+                    halves[k] = floatToHalf(values[field][k]);
+                }
+            }
+
+            data += count * static_cast<size_t>(precision);
+        }
+
+        const uint64_t frameParticles = particles;
+        file.write(reinterpret_cast<const char *>(&frameParticles), sizeof(frameParticles));
+        if (storeIds) {
+            file.write(reinterpret_cast<const char *>(ids), particles * sizeof(uint64_t));
+        }
+
+        if (compression == SnapshotCompression::None) {
+            const size_t size = frame.size();
+            frame.resize((size + 7) / 8 * 8, 0);
+            file.write(frame.data(), frame.size());
+        } else {
+            writeCompressedFrame(numberOfFrames % keyframeInterval == 0 || particles != previousParticles);
+        }
+
+        previousParticles = particles;
+        numberOfFrames++;
+        return file.good();
+    }
+
+    /**
+     * @brief Flushes the written frames to the file.
+     * 
+     */
+    void flush() {
+        file.flush();
+    }
+
+    /**
+     * @brief Number of frames written so far.
+     * 
+     * @return size_t representing the number of frames.
+     */
+    size_t getNumberOfFrames() const {
+        return numberOfFrames;
+    }
+
+    /**
+     * @brief Number of particles of the frames written without giving their number of
+     * particles.
+     * 
+     * @return size_t representing the number of particles.
+     */
+    size_t getNumberOfParticles() const {
+        return numberOfParticles;
+    }
+
+    /**
+     * @brief Checks if every frame stores the id of each particle.
+     * 
+     * @return true if the frames store ids.
+     * @return false otherwise.
+     */
+    bool storesIds() const {
+        return storeIds;
+    }
+
+    /**
+     * @brief Fields stored on every frame.
+     * 
+     * @return const std::vector<SnapshotField>& representing the fields, in file order.
+     */
+    const std::vector<SnapshotField>& getFields() const {
+        return fields;
+    }
+
+    /**
+     * @brief Size, in bytes, of the values of one frame, before padding and compression.
+     * 
+     * @param particles: Number of particles on the frame.
+     * @return size_t representing the size of the values of a frame.
+     */
+    size_t getFrameSize(size_t particles) const {
+        size_t valuesPerParticle = 0;
+        for (const SnapshotField& field: fields) {
+            valuesPerParticle += field.components;
+        }
+        return particles * valuesPerParticle * static_cast<size_t>(precision);
+    }
+
+protected:
+
+    /**
+     * @brief The file being written.
+     * 
+     */
+    std::ofstream file;
+
+    /**
+     * @brief Number of particles of the frames written without giving their number of
+     * particles.
+     * 
+     */
+    size_t numberOfParticles;
+
+    /**
+     * @brief If true, every frame stores the id of each particle.
+     * 
+     */
+    bool storeIds;
+
+    /**
+     * @brief Number of particles on the previous frame.
+     * 
+     */
+    size_t previousParticles = 0;
+
+    /**
+     * @brief Fields stored on every frame.
+     * 
+     */
+    std::vector<SnapshotField> fields;
+
+    /**
+     * @brief Precision of the stored values.
+     * 
+     */
+    SnapshotPrecision precision;
+
+    /**
+     * @brief Compression of the frames.
+     * 
+     */
+    SnapshotCompression compression;
+
+    /**
+     * @brief Number of frames between two frames stored without delta.
+     * 
+     */
+    uint32_t keyframeInterval;
+
+    /**
+     * @brief Number of frames written so far.
+     * 
+     */
+    size_t numberOfFrames;
+
+    /**
+     * @brief Values of the previous frame, used by delta compression.
+     * 
+     */
+    std::vector<char> previousFrame;
+
+    /**
+     * @brief Buffer holding the compressed frame being written.
+     * 
+     */
+    std::vector<char> compressedFrame;
+
+    /**
+     * @brief Buffer holding the differences of the frame being compressed to the previous one.
+     * 
+     */
+    std::vector<char> delta;
+
+    /**
+     * @brief Buffer holding the differences grouped by byte, before they are compressed.
+     * 
+     */
+    std::vector<char> shuffled;
+
+    /**
+     * @brief Buffer holding the values of the frame being written, so they are a single write.
+     * 
+     */
+    std::vector<char> frame;
+
+    /**
+     * @brief Appends a value to the header, in native byte order.
+     * 
+     * @tparam T: type of the value.
+     * @param header: The header being built.
+     * @param value: The value to be appended.
+     */
+    template<typename T>
+    static void append(std::vector<char>& header, const T& value) {
+        const char *bytes = reinterpret_cast<const char *>(&value);
+        header.insert(header.end(), bytes, bytes + sizeof(T));
+    }
+
+    /**
+     * @brief Writes the header of the file.
+     * 
+     * @param timeStep: Time, in seconds, between two frames.
+     */
+    void writeHeader(double timeStep) {
+        std::vector<char> header(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC));
+
+        append(header, SNAPSHOT_VERSION);
+        append(header, static_cast<uint32_t>(precision));
+        append(header, static_cast<uint32_t>(compression));
+        append(header, keyframeInterval);
+        append(header, static_cast<uint32_t>(storeIds ? 1 : 0));
+        append(header, static_cast<uint64_t>(numberOfParticles));
+        append(header, timeStep);
+        append(header, static_cast<uint32_t>(fields.size()));
+
+        for (const SnapshotField& field: fields) {
+            append(header, field.components);
+            append(header, static_cast<uint32_t>(field.name.size()));
+            header.insert(header.end(), field.name.begin(), field.name.end());
+        }
+
+        // Pad the header so the values of every frame stay aligned when the file is mapped.
+        header.resize((header.size() + 7) / 8 * 8, 0);
+        file.write(header.data(), header.size());
+    }
+
+    /**
+     * @brief Delta compresses the frame on the frame buffer and writes it.
+     * 
+     * @param keyframe: If true, the frame is stored without delta. Must be true when the
+     * previous frame has another number of particles.
+     */
+    void writeCompressedFrame(bool keyframe) {
+        const size_t frameSize = frame.size();
+        const size_t stride = static_cast<size_t>(precision);
+        const size_t numberOfValues = frameSize / stride;
+        delta.assign(frame.begin(), frame.end());
+
+        if (!keyframe) {
+            for (size_t k = 0; k < frameSize; k++) {
+                delta[k] ^= previousFrame[k];
+            }
+        }
+        previousFrame.swap(frame);
+
+        // Group byte b of every value together, so the zero bytes of the deltas form long runs.
+        shuffled.resize(frameSize);
+        for (size_t value = 0; value < numberOfValues; value++) {
+            for (size_t b = 0; b < stride; b++) {
+                shuffled[b * numberOfValues + value] = delta[value * stride + b];
+            }
+        }
+
+        // Each token is a control byte c followed by c + 1 literal bytes if c < 128, or
+        // stands for c - 127 zero bytes otherwise.
+        compressedFrame.clear();
+        size_t k = 0;
+        while (k < frameSize) {
+            size_t run = 0;
+            while (k + run < frameSize && run < 128 && shuffled[k + run] == 0) {
+                run++;
+            }
+
+            if (run > 0) {
+                compressedFrame.push_back(static_cast<char>(127 + run));
+                k += run;
+                continue;
+            }
+
+            size_t literals = 0;
+            while (k + literals < frameSize && literals < 128 && shuffled[k + literals] != 0) {
+                literals++;
+            }
+
+            compressedFrame.push_back(static_cast<char>(literals - 1));
+            compressedFrame.insert(compressedFrame.end(), shuffled.begin() + k, shuffled.begin() + k + literals);
+            k += literals;
+        }
+
+        const uint64_t compressedSize = compressedFrame.size();
+        compressedFrame.resize((compressedFrame.size() + 7) / 8 * 8, 0);
+        file.write(reinterpret_cast<const char *>(&compressedSize), sizeof(compressedSize));
+        file.write(compressedFrame.data(), compressedFrame.size());
+    }
+};
+
+/**
+ * @brief std::shared_ptr to the SnapshotWriter class.
+ * 
+ */
+typedef std::shared_ptr<SnapshotWriter> SnapshotWriterPtr;
+
+#endif // SNAPSHOTWRITER_H
\ No newline at end of file
@@ -0,0 +1,217 @@
+/**
+ * @file SolverStats.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements the optional instrumentation of the solvers: phase timers and
+ * statistics of the neighborhoods and densities.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SOLVERSTATS_H
+#define SOLVERSTATS_H
+
+#include <vector>
+#include <cstddef>
+#include <omp.h>
+
+/**
+ * @brief The instrumentation is compiled only when SPH_INSTRUMENTATION is defined. Otherwise
+ * SPH_STATS discards its statement and PhaseTimer does nothing, so the solvers run without
+ * any extra work and every statistic stays zero.
+ * 
+ */
+#ifdef SPH_INSTRUMENTATION
+    #define SPH_STATS(statement) statement
+#else
+    #define SPH_STATS(statement)
+#endif
+
+/**
+ * @brief True if the solvers were compiled with the instrumentation.
+ * 
+ */
+#ifdef SPH_INSTRUMENTATION
+static constexpr bool SOLVER_STATS_ENABLED = true;
+#else
+static constexpr bool SOLVER_STATS_ENABLED = false;
+#endif
+
+/**
+ * @brief Struct describing the wall clock time, in seconds, spent on each phase of the
+ * updates since the timings were last reset.
+ * 
+ */
+struct PhaseTimings {
+
+    /**
+     * @brief Spatial sorts and neighborhood builds.
+     * 
+     */
+    double neighborBuild = 0.0;
+
+    /**
+     * @brief Density and pressure computations.
+     * 
+     */
+    double densityPressure = 0.0;
+
+    /**
+     * @brief Force computations, or external forces and projections of the constraints.
+     * 
+     */
+    double forces = 0.0;
+
+    /**
+     * @brief Integration of the velocities and positions.
+     * 
+     */
+    double integrate = 0.0;
+
+    /**
+     * @brief Enforcement of the boundaries.
+     * 
+     */
+    double boundary = 0.0;
+
+    /**
+     * @brief Writes to the output file.
+     * 
+     */
+    double output = 0.0;
+
+    /**
+     * @brief Number of updates timed.
+     * 
+     */
+    int updates = 0;
+
+    /**
+     * @brief Total time of every phase.
+     * 
+     * @return double representing the time, in seconds.
+     */
+    double total() const {
+        return neighborBuild + densityPressure + forces + integrate + boundary + output;
+    }
+};
+
+/**
+ * @brief Struct describing the statistics collected by the instrumentation since they were
+ * last reset.
+ * 
+ */
+struct SolverStats {
+
+    /**
+     * @brief Time spent on each phase of the updates.
+     * 
+     */
+    PhaseTimings timings;
+
+    /**
+     * @brief Number of neighborhood builds the neighbor counts were collected on.
+     * 
+     */
+    size_t neighborBuilds = 0;
+
+    /**
+     * @brief Number of builds that rebuilt the neighborhood from scratch. Lower than
+     * neighborBuilds when the candidates of a Verlet list were reused.
+     * 
+     */
+    size_t neighborRebuilds = 0;
+
+    /**
+     * @brief Number of particles with each number of stored neighbors, summed over the builds.
+     * Half neighbor lists store each pair once, so they count half the neighbors.
+     * 
+     */
+    std::vector<size_t> neighborCounts;
+
+    /**
+     * @brief Number of particles that had more neighbors than the neighborhood can store, and
+     * lost some of them, summed over the builds.
+     * 
+     */
+    size_t truncatedNeighborhoods = 0;
+
+    /**
+     * @brief Number of solver steps, summed over the updates. VSphSolver2D runs several steps
+     * per update.
+     * 
+     */
+    size_t solverSteps = 0;
+
+    /**
+     * @brief Number of pressure correction iterations, summed over the solver steps.
+     * PciSphSolver2D runs several per step.
+     * 
+     */
+    size_t pressureIterations = 0;
+
+    /**
+     * @brief Largest relative deviation of a density from the rest density.
+     * 
+     */
+    double maxDensityError = 0.0;
+
+    /**
+     * @brief Average number of stored neighbors of a particle.
+     * 
+     * @return double representing the average.
+     */
+    double averageNeighbors() const {
+        size_t particles = 0;
+        double neighbors = 0.0;
+
+        for (size_t count = 0; count < neighborCounts.size(); count++) {
+            particles += neighborCounts[count];
+            neighbors += (double) count * neighborCounts[count];
+        }
+
+        return particles > 0 ? neighbors / particles : 0.0;
+    }
+};
+
+/**
+ * @brief Class that measures consecutive phases: each lap adds the time elapsed since the
+ * previous lap, or since construction, to a phase timing.
+ * 
+ */
+class PhaseTimer {
+public:
+
+#ifdef SPH_INSTRUMENTATION
+    /**
+     * @brief Construct a new PhaseTimer object and start the clock.
+     * 
+     */
+    PhaseTimer() : _start(omp_get_wtime()) { }
+
+    /**
+     * @brief Adds the time elapsed since the previous lap to a phase timing.
+     * 
+     * @param phase: The phase timing that receives the elapsed time.
+     */
+    void lap(double& phase) {
+        const double now = omp_get_wtime();
+        phase += now - _start;
+        _start = now;
+    }
+
+private:
+
+    /**
+     * @brief Time, as given by omp_get_wtime, of the previous lap.
+     * 
+     */
+    double _start;
+#else
+    void lap(double&) { }
+#endif
+};
+
+#endif // SOLVERSTATS_H
\ No newline at end of file
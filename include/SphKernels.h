@@ -15,83 +15,184 @@
 /**
  * @brief Struct representig the Poly6 SPH kernel.
  * 
+ * @tparam Scalar: floating point type of the kernel, float or double.
+ * @tparam Dimension: number of spatial dimensions the kernel is normalized for, 2 or 3.
  */
-struct SphPoly6Kernel {
+template <typename Scalar, int Dimension = 2>
+struct SphPoly6KernelT {
 
     /**
      * @brief Construct a new SphPoly6Kernel object.
      * 
      * @param kernelRadius: The radius of the kernel. 
      */
-    SphPoly6Kernel(double kernelRadius);
+    SphPoly6KernelT(Scalar kernelRadius);
 
     /**
      * @brief Kernel radius of the kernel.
      * 
      */
-    double kernelRadius;
+    Scalar kernelRadius;
 
     /**
      * @brief Compute the kernel value for the given distance squared difference.
      * 
      * @param distanceSquaredDifference: difference between two squared distances.
-     * @return double representing the kernel value.
+     * @return Scalar representing the kernel value.
      */
-    double operator()(double distanceSquaredDifference) const;
+    Scalar operator()(Scalar distanceSquaredDifference) const;
+
+    /**
+     * @brief Compute the kernel values for an array of distance squared differences.
+     * 
+     * @param distanceSquaredDifferences: differences between two squared distances.
+     * @param values: array that receives the kernel values.
+     * @param count: number of values to compute.
+     */
+    void operator()(const Scalar *distanceSquaredDifferences, Scalar *values, int count) const;
+
+    /**
+     * @brief Normalization constant of the kernel, computed once on construction.
+     * 
+     */
+    Scalar normalization;
 };
 
+/**
+ * @brief The Poly6 SPH kernel in double precision.
+ * 
+ */
+typedef SphPoly6KernelT<double> SphPoly6Kernel;
+
+/**
+ * @brief The Poly6 SPH kernel in double precision, normalized for 3D.
+ * 
+ */
+typedef SphPoly6KernelT<double, 3> SphPoly6Kernel3D;
+
 /**
  * @brief Struct representig the Spiky SPH kernel.
  * 
+ * @tparam Scalar: floating point type of the kernel, float or double.
+ * @tparam Dimension: number of spatial dimensions the kernel is normalized for, 2 or 3.
  */
-struct SphSpikyKernel {
+template <typename Scalar, int Dimension = 2>
+struct SphSpikyKernelT {
     /**
      * @brief Construct a new Sph Spiky Kernel object
      * 
      * @param kernelRadius: The radius of the kernel. 
      */
-    SphSpikyKernel(double kernelRadius);
+    SphSpikyKernelT(Scalar kernelRadius);
 
     /**
      * @brief Kernel radius of the kernel.
      * 
      */
-    double kernelRadius;
+    Scalar kernelRadius;
 
     /**
      * @brief Compute the gradient of the kernel for the given distance squared difference.
      * 
      * @param distanceSquaredDifference: difference between two squared distances.
-     * @return double representing the kernel value.
+     * @return Scalar representing the kernel value.
+     */
+    Scalar gradientAt(Scalar distanceSquaredDifference) const;
+
+    /**
+     * @brief Compute the gradients of the kernel for an array of distance squared differences.
+     * 
+     * @param distanceSquaredDifferences: differences between two squared distances.
+     * @param values: array that receives the gradient values.
+     * @param count: number of values to compute.
+     */
+    void gradientsAt(const Scalar *distanceSquaredDifferences, Scalar *values, int count) const;
+
+    /**
+     * @brief Compute the derivatives of the kernel over the distance. Unlike gradientsAt,
+     * which follows the reference implementation, these are the exact derivatives of the
+     * Spiky kernel, as needed by the pressure solve of PciSphSolver2D.
+     * 
+     * @param distanceDifferences: differences between the kernel radius and the distances.
+     * @param values: array that receives the derivatives.
+     * @param count: number of values to compute.
+     */
+    void derivativesAt(const Scalar *distanceDifferences, Scalar *values, int count) const;
+
+    /**
+     * @brief Normalization constant of the kernel, computed once on construction.
+     * 
      */
-    double gradientAt(double distanceSquaredDifference) const;
+    Scalar normalization;
 };
 
+/**
+ * @brief The Spiky SPH kernel in double precision.
+ * 
+ */
+typedef SphSpikyKernelT<double> SphSpikyKernel;
+
+/**
+ * @brief The Spiky SPH kernel in double precision, normalized for 3D.
+ * 
+ */
+typedef SphSpikyKernelT<double, 3> SphSpikyKernel3D;
+
 /**
  * @brief Struct representig the Viscosity SPH kernel.
  * 
+ * @tparam Scalar: floating point type of the kernel, float or double.
+ * @tparam Dimension: number of spatial dimensions the kernel is normalized for, 2 or 3.
  */
-struct SphViscosityKernel {
+template <typename Scalar, int Dimension = 2>
+struct SphViscosityKernelT {
     /**
      * @brief Construct a new Sph Viscosity Kernel object
      * 
      * @param kernelRadius: The radius of the kernel.
      */
-    SphViscosityKernel(double kernelRadius);
+    SphViscosityKernelT(Scalar kernelRadius);
 
     /**
      * @brief Kernel radius of the kernel.
      * 
      */
-    double kernelRadius;
+    Scalar kernelRadius;
 
     /**
      * @brief Compute the laplacian of the kernel for the given distance squared difference.
      * 
      * @param distanceSquaredDifference: difference between two squared distances.
-     * @return double representing the kernel value.
+     * @return Scalar representing the kernel value.
+     */
+    Scalar laplacianAt(Scalar distanceSquaredDifference) const;
+
+    /**
+     * @brief Compute the laplacians of the kernel for an array of distance squared differences.
+     * 
+     * @param distanceSquaredDifferences: differences between two squared distances.
+     * @param values: array that receives the laplacian values.
+     * @param count: number of values to compute.
      */
-    double laplacianAt(double distanceSquaredDifference) const;
+    void laplaciansAt(const Scalar *distanceSquaredDifferences, Scalar *values, int count) const;
+
+    /**
+     * @brief Normalization constant of the kernel, computed once on construction.
+     * 
+     */
+    Scalar normalization;
 };
 
+/**
+ * @brief The Viscosity SPH kernel in double precision.
+ * 
+ */
+typedef SphViscosityKernelT<double> SphViscosityKernel;
+
+/**
+ * @brief The Viscosity SPH kernel in double precision, normalized for 3D.
+ * 
+ */
+typedef SphViscosityKernelT<double, 3> SphViscosityKernel3D;
+
 #endif
\ No newline at end of file
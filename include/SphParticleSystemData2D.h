@@ -13,9 +13,14 @@
 #define SPHPARTICLESYSTEMDATA2D_H
 
 #include "ParticleNeighborhood2D.h"
+#include "ParticleAttributes.h"
+#include "Constants.h"
+#include "ThreadLocalBuffers.h"
 #include <eigen3/Eigen/Dense>
 #include <memory>
+#include <iostream>
 #include <vector>
+#include <cstdint>
 
 /**
  * @brief Class that handles data for 2D SPH system solvers.
@@ -31,32 +36,80 @@ public:
     
     /**
      * @brief Class default initializer.
+     * 
+     * @param neighborhoodType: Type of neighborhood structure used to find neighbor particles.
      */
-    SphParticleSystemData2D();
+    SphParticleSystemData2D(NeighborhoodType neighborhoodType = NeighborhoodType::Grid);
 
     /**
      * @brief Class default destroyer.
      */
     ~SphParticleSystemData2D();
+
+    // The attribute references are bound to the registry of this object, so copies would
+    // keep pointing into the registry of the source.
+    SphParticleSystemData2D(const SphParticleSystemData2D&) = delete;
+    SphParticleSystemData2D& operator=(const SphParticleSystemData2D&) = delete;
     
     /**
      * @brief This method adds a particle to the system. Can be overrided.
-     *
+     * 
      * @param position: Eigen::Vector2d representing the new particle's 
      *		     position.
      */
     virtual void addParticle(Eigen::Vector2d positon);
 
+    /**
+     * @brief This method removes a particle from the system in constant time. The last
+     * stored particle moves into its slot, and the particle with the highest id takes its id,
+     * so ids stay between 0 and numberOfParticles - 1. Persistent ids are never reused.
+     * 
+     * @param index: Slot of the particle to be removed.
+     */
+    void removeParticle(size_t index);
+
+    /**
+     * @brief This method removes several particles from the system, each in constant time.
+     * 
+     * @param indices: Slots of the particles to be removed, without repetitions. Sorted in
+     *         place, from the highest slot to the lowest.
+     */
+    void removeParticles(std::vector<size_t>& indices);
+
+    /**
+     * @brief This method reserves room for the given number of particles, so adding
+     * particles up to that number does not reallocate.
+     * 
+     * @param size: The number of particles.
+     */
+    void reserve(size_t size);
+
     /**
      * @brief This method computes the density and pressure of the particles
-     * for a solver time step. Can be overrided.
+     * for a solver time step. Half neighbor lists add each pair to both of its particles.
+     * Can be overrided.
      */
     virtual void computeDensityPressure();
 
+    /**
+     * @brief This method returns the density the pressures push the particles towards.
+     * Can be overrided.
+     * 
+     * @returns A double representing the rest density.
+     */
+    virtual double getRestDensity();
+
+    /**
+     * @brief Sets the density the pressures push the particles towards.
+     * 
+     * @param newRestDensity: double representing the new rest density.
+     */
+    void setRestDensity(double newRestDensity);
+
     /**
      * @brief This method returns the positions of the particles
      * in the system, in order.
-     *
+     * 
      * @returns A list of particle positions of type 
      *      std::vector < Eigen::Vector2d >&.
      */
@@ -166,6 +219,13 @@ public:
      */
     ParticleNeighborhood2DPtr getNeighborhood();
 
+    /**
+     * @brief Set the Neighborhood object
+     * 
+     * @param neighborhood: ParticleNeighborhood2DPtr representing the new neighborhood structure.
+     */
+    void setNeighborhood(ParticleNeighborhood2DPtr neighborhood);
+
     /**
      * @brief Get the density variation for each particle in the system, in order.
      * 
@@ -214,8 +274,28 @@ public:
      * @return double reppresenting the stiffness of the system.
      */
     double getStiffness();
+
+    /**
+     * @brief Set the stiffness constant.
+     * 
+     * @param newStiffness: double representing the new stiffness.
+     */
+    void setStiffness(double newStiffness);
+
+    /**
+     * @brief Get the stiffness at proximity constant.
+     * 
+     * @return double representing the stiffness of the near pressures.
+     */
     double getStiffnessAtProximity();
 
+    /**
+     * @brief Set the stiffness at proximity constant.
+     * 
+     * @param newStiffnessAtProximity: double representing the new stiffness at proximity.
+     */
+    void setStiffnessAtProximity(double newStiffnessAtProximity);
+
     /**
      * @brief Get the linearViscosity constant.
      * 
@@ -223,6 +303,13 @@ public:
      */
     double getLinearViscosity();
 
+    /**
+     * @brief Set the linearViscosity constant.
+     * 
+     * @param newLinearViscosity: double representing the new linear viscosity.
+     */
+    void setLinearViscosity(double newLinearViscosity);
+
     /**
      * @brief Get the quadraticViscosity constant.
      * 
@@ -230,15 +317,141 @@ public:
      */
     double getQuadraticViscosity();
 
+    /**
+     * @brief Set the quadraticViscosity constant.
+     * 
+     * @param newQuadraticViscosity: double representing the new quadratic viscosity.
+     */
+    void setQuadraticViscosity(double newQuadraticViscosity);
+
     /**
      * @brief Get the surface tension constant
      * 
      * @return double reppresenting the surface tension of the system.  
      */
     double getSurfaceTension();
+
+    /**
+     * @brief Set the surface tension constant.
+     * 
+     * @param newSurfaceTension: double representing the new surface tension.
+     */
+    void setSurfaceTension(double newSurfaceTension);
+
+    /**
+     * @brief Get the registry with every per-particle attribute of the system. New attributes
+     * registered on it grow together with the built-in ones as particles are added.
+     * 
+     * @return ParticleAttributes2D& representing the attribute registry.
+     */
+    ParticleAttributes2D& getAttributes();
+
+    /**
+     * @brief Sorts every per-particle attribute by the Z-order (Morton) key of the grid cell,
+     * with cell size equal to the kernel radius, that contains each particle. The cells are
+     * counted from the lowest finite coordinates and clamped to 32 bits, so particles at
+     * negative or non-finite coordinates still get valid keys. Particles that are close in
+     * space end up close in memory. The neighborhood must be rebuilt afterwards.
+     * 
+     */
+    void sortParticles();
+
+    /**
+     * @brief Get the id of each stored particle, in storage order. The id of a particle is
+     * the order in which it was added and does not change when particles are sorted. When a
+     * particle is removed, the particle with the highest id takes its id.
+     * 
+     * @return const std::vector<size_t>& representing the particle ids.
+     */
+    const std::vector<size_t>& getParticleIds();
+
+    /**
+     * @brief Get the persistent id of each stored particle, in storage order. Unlike the ids
+     * of getParticleIds, a persistent id is given to a single particle when it is added and
+     * is never reused, so it follows the particle while others are added and removed.
+     * 
+     * @return std::vector<double>& representing the persistent ids, stored as the
+     * "persistentIds" attribute.
+     */
+    std::vector<double>& getPersistentIds();
+
+    /**
+     * @brief Checks if the particles were sorted, so storage order may differ from id order.
+     * 
+     * @return true if sortParticles was called.
+     * @return false if particles are stored in id order.
+     */
+    bool isReordered();
+
+    /**
+     * @brief Copies a per-particle list from storage order into id order.
+     * 
+     * @param values: The list of values in storage order.
+     * @param result: The list that receives the values in id order.
+     */
+    void toIdOrder(const std::vector<Eigen::Vector2d>& values, std::vector<Eigen::Vector2d>& result);
+
+    /**
+     * @brief Copies a per-particle list from storage order into id order.
+     * 
+     * @param values: The list of values in storage order.
+     * @param result: The list that receives the values in id order.
+     */
+    void toIdOrder(const std::vector<double>& values, std::vector<double>& result);
+
+    /**
+     * @brief Writes every per-particle attribute, the particle ids and the physical
+     * parameters of the system to a binary stream.
+     * 
+     * @param stream: The stream to write to.
+     */
+    virtual void writeState(std::ostream& stream);
+
+    /**
+     * @brief Restores the state written by writeState. The stream must hold the same
+     * attributes as this system, and the neighborhood must be rebuilt afterwards. Nothing is
+     * changed until the whole state was read.
+     * 
+     * @param stream: The stream to read from.
+     * @return true if the state was read.
+     * @return false if the stream ended early or holds other attributes, leaving the system
+     * unchanged.
+     */
+    virtual bool readState(std::istream& stream);
     
 protected:
 
+    /**
+     * @brief Registry that owns every per-particle attribute. The lists below are views
+     * of the built-in attributes, so it must be declared before them.
+     * 
+     */
+    ParticleAttributes2D _attributes;
+
+    /**
+     * @brief Id of each stored particle, in storage order.
+     * 
+     */
+    std::vector<size_t> _particleIds = {};
+
+    /**
+     * @brief Slot of each particle, in id order. The inverse of _particleIds.
+     * 
+     */
+    std::vector<size_t> _particleSlots = {};
+
+    /**
+     * @brief If true, the particles were sorted and may not be in id order.
+     * 
+     */
+    bool _reordered = false;
+
+    /**
+     * @brief Persistent id of the next added particle.
+     * 
+     */
+    uint64_t _nextPersistentId = 0;
+
     /**
      * @brief std::shared_ptr to the neighborhood structure.
      * 
@@ -249,67 +462,73 @@ protected:
      * @brief vector of particle positions.
      * 
      */
-    std::vector<Eigen::Vector2d> _positions = {};
+    std::vector<Eigen::Vector2d>& _positions;
 
     /**
      * @brief vector of particle velocities.
      * 
      */
-    std::vector<Eigen::Vector2d> _velocities = {};
+    std::vector<Eigen::Vector2d>& _velocities;
 
     /**
      * @brief vector of forces over each particle.
      * 
      */
-    std::vector<Eigen::Vector2d> _forces = {};
+    std::vector<Eigen::Vector2d>& _forces;
 
     /**
      * @brief vector of the densities of each particle.
      * 
      */
-    std::vector<double> _densities = {};
+    std::vector<double>& _densities;
 
     /**
      * @brief vector of the pressures of each particle.
      * 
      */
-    std::vector<double> _pressures = {};
+    std::vector<double>& _pressures;
 
     /**
      * @brief vector of the last positions of each particle.
      * 
      */
-    std::vector<Eigen::Vector2d> _lastPositions = {};
+    std::vector<Eigen::Vector2d>& _lastPositions;
 
     /**
      * @brief vector of the projected prositions of each particle.
      * 
      */
-    std::vector<Eigen::Vector2d> _projectedPositions = {};
+    std::vector<Eigen::Vector2d>& _projectedPositions;
     
     /**
      * @brief vector of the density variations of each particle.
      * 
      */
-    std::vector<double> _densityVariations = {};
+    std::vector<double>& _densityVariations;
 
     /**
      * @brief vector of the pressure variations of each particle.
      * 
      */
-    std::vector<double> _pressureVariations = {};
+    std::vector<double>& _pressureVariations;
+
+    /**
+     * @brief vector of the persistent ids of each particle.
+     * 
+     */
+    std::vector<double>& _persistentIds;
 
     /**
      * @brief Kernel factor constat.
      * 
      */
-    double _kernelFactor;
+    double _kernelFactor = 0.0;
 
     /**
      * @brief Kernel factors norm constant.
      * 
      */
-    double _kernelFactorNorm;
+    double _kernelFactorNorm = 0.0;
 
     /**
      * @brief Stiffnesses constant.
@@ -370,6 +589,18 @@ protected:
      * 
      */
     double _particleRadius = 16.0;
+
+    /**
+     * @brief The density the pressures push the particles towards.
+     * 
+     */
+    double _restDensity = REST_DENSITY;
+
+    /**
+     * @brief Per-thread density sums for half neighbor lists.
+     * 
+     */
+    ThreadLocalBuffers<double> _densityBuffers;
 };
 
 /**
@@ -378,4 +609,4 @@ protected:
  */
 typedef std::shared_ptr<SphParticleSystemData2D> SphParticleSystemData2DPtr;    
 
-#endif
+#endif
\ No newline at end of file
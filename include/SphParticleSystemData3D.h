@@ -0,0 +1,251 @@
+/**
+ * @file SphParticleSystemData3D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the particle system data for 3D SPH simulators.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SPHPARTICLESYSTEMDATA3D_H
+#define SPHPARTICLESYSTEMDATA3D_H
+
+#include "ParticleAttributes.h"
+#include "CellListNeighborhood.h"
+#include "Constants.h"
+#include <eigen3/Eigen/Dense>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Class that handles data for 3D SPH system solvers. The attributes live on a
+ * ParticleAttributes3D registry, one contiguous array per attribute, and the neighbors are
+ * found with a CellListNeighborhood3D, sorted by index as the density and force sums expect.
+ * 
+ */
+class SphParticleSystemData3D {
+public:
+
+    /**
+     * @brief Variable that stores the number of particles
+     * on the system.
+     */
+    size_t numberOfParticles = 0;
+
+    /**
+     * @brief Class default initializer.
+     * 
+     */
+    SphParticleSystemData3D();
+
+    /**
+     * @brief Class default destroyer.
+     * 
+     */
+    ~SphParticleSystemData3D();
+
+    // The attribute references are bound to the registry of this object, so copies would
+    // keep pointing into the registry of the source.
+    SphParticleSystemData3D(const SphParticleSystemData3D&) = delete;
+    SphParticleSystemData3D& operator=(const SphParticleSystemData3D&) = delete;
+
+    /**
+     * @brief This method adds a particle to the system.
+     * 
+     * @param position: Eigen::Vector3d representing the new particle's position.
+     */
+    void addParticle(Eigen::Vector3d position);
+
+    /**
+     * @brief Reserves room for size particles, so adding particles up to that number does
+     * not reallocate.
+     * 
+     * @param size: The number of particles.
+     */
+    void reserve(size_t size);
+
+    /**
+     * @brief Computes the density and the pressure of each particle.
+     * 
+     */
+    void computeDensityPressure();
+
+    /**
+     * @brief Get the Positions of the particles.
+     * 
+     * @return std::vector<Eigen::Vector3d>& representing the positions of the particles.
+     */
+    std::vector<Eigen::Vector3d>& getPositions();
+
+    /**
+     * @brief Get the Velocities of the particles.
+     * 
+     * @return std::vector<Eigen::Vector3d>& representing the velocities of the particles.
+     */
+    std::vector<Eigen::Vector3d>& getVelocities();
+
+    /**
+     * @brief Get the Forces over the particles.
+     * 
+     * @return std::vector<Eigen::Vector3d>& representing the forces over the particles.
+     */
+    std::vector<Eigen::Vector3d>& getForces();
+
+    /**
+     * @brief Get the Densities of the particles.
+     * 
+     * @return std::vector<double>& representing the densities of the particles.
+     */
+    std::vector<double>& getDensities();
+
+    /**
+     * @brief Get the Pressures of the particles.
+     * 
+     * @return std::vector<double>& representing the pressures of the particles.
+     */
+    std::vector<double>& getPressures();
+
+    /**
+     * @brief Get the Kernel Radius.
+     * 
+     * @return double representing the kernel radius.
+     */
+    double getKernelRadius();
+
+    /**
+     * @brief Get the Mass of each particle.
+     * 
+     * @return double representing the mass.
+     */
+    double getMass();
+
+    /**
+     * @brief Set the Mass of each particle.
+     * 
+     * @param newMass: The new mass.
+     */
+    void setMass(double newMass);
+
+    /**
+     * @brief Get the Viscosity Constant.
+     * 
+     * @return double representing the viscosity constant.
+     */
+    double getViscosityConstant();
+
+    /**
+     * @brief Set the Viscosity Constant.
+     * 
+     * @param newViscosityConstant: The new viscosity constant.
+     */
+    void setViscosityConstant(double newViscosityConstant);
+
+    /**
+     * @brief Get the Particle Radius, the distance at which the boundaries push the particles.
+     * 
+     * @return double representing the particle radius.
+     */
+    double getParticleRadius();
+
+    /**
+     * @brief Get the neighborhood of the particles.
+     * 
+     * @return CellListNeighborhood3DPtr representing the neighborhood.
+     */
+    CellListNeighborhood3DPtr getNeighborhood();
+
+    /**
+     * @brief Builds the neighborhood on the current positions.
+     * 
+     */
+    void buildNeighborhood();
+
+    /**
+     * @brief Get the registry that owns every per-particle attribute. Attributes registered
+     * on it grow with the particle system.
+     * 
+     * @return ParticleAttributes3D& representing the registry.
+     */
+    ParticleAttributes3D& getAttributes();
+
+private:
+
+    /**
+     * @brief Registry that owns every per-particle attribute. The lists below are views
+     * of the built-in attributes, so it must be declared before them.
+     * 
+     */
+    ParticleAttributes3D _attributes;
+
+    /**
+     * @brief std::shared_ptr to the neighborhood structure.
+     * 
+     */
+    CellListNeighborhood3DPtr _neighborhood;
+
+    /**
+     * @brief vector of particle positions.
+     * 
+     */
+    std::vector<Eigen::Vector3d>& _positions;
+
+    /**
+     * @brief vector of particle velocities.
+     * 
+     */
+    std::vector<Eigen::Vector3d>& _velocities;
+
+    /**
+     * @brief vector of forces over each particle.
+     * 
+     */
+    std::vector<Eigen::Vector3d>& _forces;
+
+    /**
+     * @brief vector of the densities of each particle.
+     * 
+     */
+    std::vector<double>& _densities;
+
+    /**
+     * @brief vector of the pressures of each particle.
+     * 
+     */
+    std::vector<double>& _pressures;
+
+    /**
+     * @brief Kernel radius constant.
+     * 
+     */
+    double _kernelRadius = 16.0;
+
+    /**
+     * @brief Mass of each particle. The accelerations of the base equations scale with the
+     * mass over the squared density, and the 3D kernels spread the mass over a volume, so it
+     * is chosen to give the block of SphSolver3D the accelerations of the 2D one.
+     * 
+     */
+    double _mass = 400.0;
+
+    /**
+     * @brief Viscosity constant.
+     * 
+     */
+    double _viscosityConstant = 200.0;
+
+    /**
+     * @brief Particle radius constant.
+     * 
+     */
+    double _particleRadius = 16.0;
+};
+
+/**
+ * @brief std::shared_ptr to SphParticleSystemData3D.
+ * 
+ */
+typedef std::shared_ptr<SphParticleSystemData3D> SphParticleSystemData3DPtr;
+
+#endif
\ No newline at end of file
@@ -14,14 +14,183 @@
 
 #include "SphParticleSystemData2D.h"
 #include "CsvWriter.h"
+#include "SnapshotWriter.h"
+#include "AsyncSnapshotWriter.h"
+#include "SolverStats.h"
+#include "ParticleEmitter2D.h"
+#include "ParticleSink2D.h"
+#include "SdfCollider2D.h"
 #include <vector>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <fstream>
 #include <typeinfo>
 #include <regex>
+#include <omp.h>
 #include <eigen3/Eigen/Dense>
 
+/**
+ * @brief Schedules for the per-particle parallel loops that visit neighbors. Clustered fluid
+ * gives particles very different neighbor counts, which dynamic or guided schedules balance.
+ * 
+ */
+enum class LoopSchedule {
+    /**
+     * @brief Iterations are split into equal chunks ahead of time.
+     * 
+     */
+    Static,
+
+    /**
+     * @brief Threads grab chunks of iterations as they finish the previous ones.
+     * 
+     */
+    Dynamic,
+
+    /**
+     * @brief Like Dynamic, with chunks that shrink as the loop progresses.
+     * 
+     */
+    Guided
+};
+
+/**
+ * @brief Class that makes a schedule the one used by loops with a runtime schedule while it
+ * lives, and restores the schedule of the caller when destroyed, so a solver does not change
+ * the schedule of the loops of the rest of the program.
+ * 
+ */
+class LoopScheduleScope {
+public:
+
+    /**
+     * @brief Construct a new LoopScheduleScope object, saving the current schedule.
+     * 
+     * @param kind: The kind of schedule.
+     * @param chunkSize: The chunk size of the schedule.
+     */
+    LoopScheduleScope(omp_sched_t kind, int chunkSize) {
+        omp_get_schedule(&_previousKind, &_previousChunkSize);
+        omp_set_schedule(kind, chunkSize);
+    }
+
+    /**
+     * @brief Destructor for the LoopScheduleScope class. Restores the saved schedule.
+     * 
+     */
+    ~LoopScheduleScope() {
+        omp_set_schedule(_previousKind, _previousChunkSize);
+    }
+
+    LoopScheduleScope(const LoopScheduleScope&) = delete;
+    LoopScheduleScope& operator=(const LoopScheduleScope&) = delete;
+
+private:
+
+    /**
+     * @brief The kind of the saved schedule.
+     * 
+     */
+    omp_sched_t _previousKind;
+
+    /**
+     * @brief The chunk size of the saved schedule.
+     * 
+     */
+    int _previousChunkSize;
+};
+
+/**
+ * @brief Floating point precision of the density, force and integration steps of the base
+ * SPH solver.
+ * 
+ */
+enum class SolverPrecision {
+    /**
+     * @brief Every value is stored and summed in double precision.
+     * 
+     */
+    Double,
+
+    /**
+     * @brief Positions, velocities, forces, densities and pressures are stored, read and
+     * written in single precision, while the density and force sums over the neighbors are
+     * accumulated in double precision. The double precision attributes are only brought up
+     * to date when the state leaves the solver, except for the positions, which are widened
+     * once per update for the neighborhoods. On the bundled scene positions stay within about
+     * 2.5e-3 of the double results over the first 25 updates, after which the rounding grows
+     * chaotically.
+     * 
+     */
+    Mixed
+};
+
+/**
+ * @brief Formats of the files the solvers write the simulation data to.
+ * 
+ */
+enum class OutputFormat {
+    /**
+     * @brief One CSV row of "x y" positions per update.
+     * 
+     */
+    Csv,
+
+    /**
+     * @brief Binary snapshot file, as written by SnapshotWriter, with the fields chosen by
+     * OutputSettings. It can be read with SnapshotReader.
+     * 
+     */
+    Binary
+};
+
+/**
+ * @brief Struct describing what the solvers write to the output file and how.
+ * 
+ */
+struct OutputSettings {
+
+    /**
+     * @brief Names of the particle attributes written to binary files, such as "positions",
+     * "velocities", "densities" or "pressures". CSV files always hold the positions.
+     * 
+     */
+    std::vector<std::string> fields = {"positions"};
+
+    /**
+     * @brief Number of updates between two written frames.
+     * 
+     */
+    int interval = 1;
+
+    /**
+     * @brief Precision of the values written to binary files.
+     * 
+     */
+    SnapshotPrecision precision = SnapshotPrecision::Double;
+
+    /**
+     * @brief Compression of the frames written to binary files.
+     * 
+     */
+    SnapshotCompression compression = SnapshotCompression::None;
+
+    /**
+     * @brief Number of frames between two frames stored without delta, when compressed.
+     * 
+     */
+    int keyframeInterval = 16;
+
+    /**
+     * @brief If true, every frame of binary files stores the persistent id of each particle,
+     * and the particles are written in storage order. Ids are always stored when the solver
+     * has emitters or sinks on the first written frame, since particles then come and go.
+     * 
+     */
+    bool ids = false;
+};
+
 /**
  * @brief Class that implements the base SPH solver for 2D pparticle systems.
  * 
@@ -45,8 +214,11 @@ public:
      * @brief Construct a new SphSolver2D object with a given number of particles.
      * 
      * @param numberOfParticles: Number of particles to added to the system. 
+     * @param fileName: Name of the file to write the simulation data to. Empty to disable writing.
+     * @param neighborhoodType: Type of neighborhood structure used to find neighbor particles.
      */
-    SphSolver2D(int numberOfParticles, std::string fileName = "");
+    SphSolver2D(int numberOfParticles, std::string fileName = "",
+        NeighborhoodType neighborhoodType = NeighborhoodType::Grid);
 
     /**
      * @brief Add a new particle to the system with given position parameter.
@@ -56,11 +228,198 @@ public:
     void addParticle(Eigen::Vector2d positon);
 
     /**
-     * @brief Get the positions of each particle, in order.
+     * @brief Get the positions of each particle, in the order the particles were added,
+     * even if the particles were sorted in memory. Once sorted, the positions are a copy, so
+     * they are read only: positions are changed through the particle system data.
      * 
-     * @return std::vector< Eigen::Vector2d >& representing the positions of each particle.  
+     * @return const std::vector< Eigen::Vector2d >& representing the positions of each particle.  
      */
-    std::vector<Eigen::Vector2d>& getPositions();
+    virtual const std::vector<Eigen::Vector2d>& getPositions();
+
+    /**
+     * @brief Get the particle system data, with the particles in storage order.
+     * 
+     * @return SphParticleSystemData2DPtr representing the particle system data.
+     */
+    virtual SphParticleSystemData2DPtr getParticleSystemData();
+
+    /**
+     * @brief Set how often particles are sorted in memory by spatial locality, speeding up
+     * neighbor access on large systems.
+     * 
+     * @param reorderInterval: Number of updates between two sorts. 0 disables sorting.
+     * @return true if the interval was set.
+     * @return false if the solver does not support sorting and the interval is not 0.
+     */
+    virtual bool setReorderInterval(int reorderInterval);
+
+    /**
+     * @brief Set the OpenMP schedule of the per-particle loops that visit neighbors: the
+     * neighborhood build, density and pressure computation and force evaluation.
+     * Neighbors of each particle are always visited serially.
+     * 
+     * @param schedule: The loop schedule.
+     * @param chunkSize: Number of iterations per chunk, 0 for the OpenMP default.
+     */
+    void setLoopSchedule(LoopSchedule schedule, int chunkSize = 0);
+
+    /**
+     * @brief Set the precision of the density, force, integration and boundary steps.
+     * Solvers that only have double precision steps reject the other precisions.
+     * 
+     * @param precision: The precision.
+     * @return true if the solver runs in the precision.
+     * @return false otherwise, keeping the current precision.
+     */
+    virtual bool setPrecision(SolverPrecision precision);
+
+    /**
+     * @brief Set the deterministic mode, in which the results do not depend on the number of
+     * OpenMP threads, so multi-threaded runs reproduce bit for bit. The neighbor lists
+     * already keep the same order for any number of threads, and every per-particle loop
+     * gathers its neighbors in that order. Sums over all particles run in a fixed order
+     * instead of as OpenMP reductions, and symmetric pairs, which scatter into per-thread
+     * buffers, fall back to full neighbor lists.
+     * 
+     * @param deterministic: true to enable the deterministic mode.
+     */
+    virtual void setDeterministic(bool deterministic);
+
+    /**
+     * @brief Checks if the deterministic mode is enabled.
+     * 
+     * @return true if the results do not depend on the number of threads.
+     * @return false otherwise.
+     */
+    bool isDeterministic();
+
+    /**
+     * @brief Enables Verlet neighbor lists. The neighborhood is then built with the kernel
+     * radius plus the skin and only rebuilt once a particle moved more than half the skin,
+     * while neighbor distances are still updated on every build.
+     * 
+     * @param skin: Distance added to the kernel radius. 0 disables Verlet lists.
+     */
+    void setVerletSkin(double skin);
+
+    /**
+     * @brief Adds an inflow boundary, which emits particles at the start of each update.
+     * 
+     * @param emitter: The emitter to be added.
+     * @return true if the emitter was added.
+     * @return false if the solver does not support emitters.
+     */
+    virtual bool addEmitter(ParticleEmitter2DPtr emitter);
+
+    /**
+     * @brief Adds an outflow boundary, which removes particles at the start of each update.
+     * 
+     * @param sink: The sink to be added.
+     * @return true if the sink was added.
+     * @return false if the solver does not support sinks.
+     */
+    virtual bool addSink(ParticleSink2DPtr sink);
+
+    /**
+     * @brief Adds a static obstacle, which pushes the particles out of it with the response of
+     * the walls. Only the particles in the cells of the kernel radius grid that overlap the
+     * sampled box of the collider look it up. The predicted positions of PciSphSolver2D are
+     * pushed out of the colliders as well.
+     * 
+     * @param collider: The collider to be added.
+     * @return true if the collider was added.
+     * @return false if the collider is null or invalid, or the solver does not support colliders.
+     */
+    virtual bool addCollider(SdfCollider2DPtr collider);
+
+    /**
+     * @brief Set the format of the file the simulation data is written to. Must be called
+     * before the first update.
+     * 
+     * @param outputFormat: The format of the file.
+     */
+    void setOutputFormat(OutputFormat outputFormat);
+
+    /**
+     * @brief Write binary snapshots on a background thread, so update() only copies the
+     * positions into a queue. Must be called before the first update. The queued frames are
+     * written when the solver is destroyed.
+     * 
+     * @param queueDepth: Number of frames that can wait to be written. 0 writes on the
+     * calling thread.
+     * @param policy: What to do with a new frame when the queue is full.
+     */
+    void setAsyncOutput(int queueDepth, BackpressurePolicy policy = BackpressurePolicy::Block);
+
+    /**
+     * @brief Set the fields, frequency, precision and compression of the output. Must be
+     * called before the first update, and after the attributes of the fields were added.
+     * 
+     * @param outputSettings: The settings of the output.
+     * @return true if every field is an attribute of the particle system.
+     * @return false otherwise, keeping the previous settings.
+     */
+    bool setOutputSettings(const OutputSettings& outputSettings);
+
+    /**
+     * @brief Writes the queued frames and closes the binary output file. A later update that
+     * writes output starts the file again.
+     * 
+     */
+    void closeOutput();
+
+    /**
+     * @brief Get the simulated time of one update.
+     * 
+     * @return double representing the time, in seconds, advanced by update().
+     */
+    virtual double getTimeStepSize();
+
+    /**
+     * @brief Saves the full state of the particle system and of the solver to a binary file,
+     * so the run can be resumed with loadCheckpoint.
+     * 
+     * @param fileName: Name of the checkpoint file.
+     * @return true if the checkpoint was written.
+     * @return false otherwise.
+     */
+    virtual bool saveCheckpoint(const std::string& fileName);
+
+    /**
+     * @brief Restores a state saved by saveCheckpoint, from a solver of the same type, and
+     * rebuilds the neighborhood. Updates after a restore give the same results as updates
+     * after the save.
+     * 
+     * @param fileName: Name of the checkpoint file.
+     * @return true if the checkpoint was read.
+     * @return false if the file could not be read or is not a checkpoint of this solver,
+     * leaving the solver unchanged.
+     */
+    virtual bool loadCheckpoint(const std::string& fileName);
+
+    /**
+     * @brief Get the statistics collected since the last reset: the time spent on each phase,
+     * the neighbor counts and the density error. Only collected when compiled with
+     * SPH_INSTRUMENTATION, otherwise every statistic is zero.
+     * 
+     * @return const SolverStats& representing the statistics.
+     */
+    const SolverStats& getStats();
+
+    /**
+     * @brief Set every statistic to zero.
+     * 
+     */
+    void resetStats();
+
+    /**
+     * @brief Writes the statistics of each update, as a CSV row, to a trace file.
+     * 
+     * @param fileName: Name of the trace file, or "" to stop tracing.
+     * @return true if the trace file was opened, or tracing was stopped.
+     * @return false if the file could not be opened, or the instrumentation is not compiled.
+     */
+    bool setStatsTraceFile(const std::string& fileName);
     
     /**
      * @brief Perform one time step for the system, updating the parameters of each aprticle.
@@ -132,6 +491,66 @@ protected:
      */
     CsvWriter _csv;
 
+    /**
+     * @brief Format of the file the simulation data is written to.
+     * 
+     */
+    OutputFormat _outputFormat = OutputFormat::Csv;
+
+    /**
+     * @brief Writer of the binary snapshot file, created on the first write.
+     * 
+     */
+    SnapshotWriterPtr _snapshotWriter;
+
+    /**
+     * @brief Number of frames the background writer can queue, 0 to write synchronously.
+     * 
+     */
+    int _outputQueueDepth = 0;
+
+    /**
+     * @brief What the background writer does with a new frame when its queue is full.
+     * 
+     */
+    BackpressurePolicy _outputPolicy = BackpressurePolicy::Block;
+
+    /**
+     * @brief Background writer of the binary snapshot file, created on the first write.
+     * 
+     */
+    AsyncSnapshotWriterPtr _asyncSnapshotWriter;
+
+    /**
+     * @brief The fields, frequency, precision and compression of the output.
+     * 
+     */
+    OutputSettings _outputSettings;
+
+    /**
+     * @brief Number of updates since the output file was created.
+     * 
+     */
+    int _updatesSinceOutputStart = 0;
+
+    /**
+     * @brief Values of each vector field in id order, used when particles were sorted.
+     * 
+     */
+    std::vector<std::vector<Eigen::Vector2d>> _outputVectors = {};
+
+    /**
+     * @brief Values of each scalar field in id order, used when particles were sorted.
+     * 
+     */
+    std::vector<std::vector<double>> _outputScalars = {};
+
+    /**
+     * @brief Persistent id of each particle, written to binary files that store ids.
+     * 
+     */
+    std::vector<uint64_t> _outputIds = {};
+
     /**
      * @brief vector of boundary conditions.
      * 
@@ -186,6 +605,274 @@ protected:
      */
     std::string _fileName = "";
 
+    /**
+     * @brief Number of updates between two spatial sorts of the particles. 0 disables sorting.
+     * 
+     */
+    int _reorderInterval = 0;
+
+    /**
+     * @brief Number of updates performed since the last spatial sort.
+     * 
+     */
+    int _updatesSinceReorder = 0;
+
+    /**
+     * @brief Positions of each particle in id order, used when particles were sorted.
+     * 
+     */
+    std::vector<Eigen::Vector2d> _positionsInIdOrder = {};
+
+    /**
+     * @brief Schedule of the per-particle loops that visit neighbors.
+     * 
+     */
+    LoopSchedule _loopSchedule = LoopSchedule::Static;
+
+    /**
+     * @brief Chunk size of the per-particle loops that visit neighbors, 0 for the default.
+     * 
+     */
+    int _loopChunkSize = 0;
+
+    /**
+     * @brief Precision of the density, force and integration steps.
+     * 
+     */
+    SolverPrecision _precision = SolverPrecision::Double;
+
+    /**
+     * @brief If true, the results do not depend on the number of threads.
+     * 
+     */
+    bool _deterministic = false;
+
+    /**
+     * @brief Single precision positions, used by the mixed precision steps.
+     * 
+     */
+    std::vector<Eigen::Vector2f> _mixedPositions = {};
+
+    /**
+     * @brief Single precision velocities, used by the mixed precision steps.
+     * 
+     */
+    std::vector<Eigen::Vector2f> _mixedVelocities = {};
+
+    /**
+     * @brief Single precision forces, used by the mixed precision steps.
+     * 
+     */
+    std::vector<Eigen::Vector2f> _mixedForces = {};
+
+    /**
+     * @brief Single precision densities, used by the mixed precision steps.
+     * 
+     */
+    std::vector<float> _mixedDensities = {};
+
+    /**
+     * @brief Single precision pressures, used by the mixed precision steps.
+     * 
+     */
+    std::vector<float> _mixedPressures = {};
+
+    /**
+     * @brief Number of particles on the single precision attributes, -1 when they must be
+     * loaded from the double precision attributes again.
+     * 
+     */
+    int _mixedParticles = -1;
+
+    /**
+     * @brief If true, the double precision attributes hold the current state, otherwise only
+     * their positions do.
+     * 
+     */
+    bool _mixedStateOnHost = true;
+
+    /**
+     * @brief Load the single precision attributes from the double precision attributes.
+     * 
+     */
+    void uploadMixed();
+
+    /**
+     * @brief Copy the single precision attributes back to the double precision attributes,
+     * if they are ahead of them. Called before the state leaves the solver or is changed
+     * from outside the mixed precision steps.
+     * 
+     */
+    void synchronizeMixed();
+
+    /**
+     * @brief Compute the density and pressure of each particle with the mixed precision
+     * steps, loading the single precision attributes first if the particles changed.
+     * 
+     */
+    void computeDensityPressureMixed();
+
+    /**
+     * @brief Inflow boundaries of the system.
+     * 
+     */
+    std::vector<ParticleEmitter2DPtr> _emitters = {};
+
+    /**
+     * @brief Outflow boundaries of the system.
+     * 
+     */
+    std::vector<ParticleSink2DPtr> _sinks = {};
+
+    /**
+     * @brief Static obstacles of the system.
+     * 
+     */
+    std::vector<SdfCollider2DPtr> _colliders = {};
+
+    /**
+     * @brief Size of the cells the colliders were binned into, 0 when they must be binned again.
+     * 
+     */
+    double _colliderCellSize = 0.0;
+
+    /**
+     * @brief Number of collider cells along x.
+     * 
+     */
+    int _colliderGridWidth = 0;
+
+    /**
+     * @brief Number of collider cells along y.
+     * 
+     */
+    int _colliderGridHeight = 0;
+
+    /**
+     * @brief Offset of the colliders of each cell in _colliderCellIndices, with one more entry
+     * at the end.
+     * 
+     */
+    std::vector<int> _colliderCellStarts = {};
+
+    /**
+     * @brief Indices of the colliders overlapping each cell, cell after cell.
+     * 
+     */
+    std::vector<int> _colliderCellIndices = {};
+
+    /**
+     * @brief Bins the colliders into the cells of the view they overlap, one cell per kernel
+     * radius, clamping the parts outside the view into the border cells as the grids do.
+     * 
+     */
+    void buildColliderCells();
+
+    /**
+     * @brief Bins the colliders again if the kernel radius changed since they were binned.
+     * 
+     * @return true if there are colliders.
+     * @return false otherwise.
+     */
+    bool prepareColliders();
+
+    /**
+     * @brief Pushes a position inside the colliders overlapping its cell back onto their
+     * surface. The colliders must be prepared with prepareColliders.
+     * 
+     * @param position: The position.
+     * @return Eigen::Vector2d representing the pushed position.
+     */
+    Eigen::Vector2d pushOutOfColliders(Eigen::Vector2d position);
+
+    /**
+     * @brief Pushes the particles out of the colliders overlapping their cells. Called by
+     * enforceBoundary after the walls.
+     * 
+     */
+    void applyColliders();
+
+    /**
+     * @brief Emits and removes the particles of every emitter and sink. Called at the start
+     * of each update, before the neighborhood is built.
+     * 
+     */
+    void applyEmittersAndSinks();
+
+    /**
+     * @brief Statistics collected since the last reset.
+     * 
+     */
+    SolverStats _stats;
+
+    /**
+     * @brief Trace file that receives the statistics of each update.
+     * 
+     */
+    std::ofstream _statsTrace;
+
+    /**
+     * @brief Statistics at the end of the previous traced update.
+     * 
+     */
+    SolverStats _tracedStats;
+
+    /**
+     * @brief Largest density error of the current update.
+     * 
+     */
+    double _updateDensityError = 0.0;
+
+    /**
+     * @brief Number of rebuilds of the Verlet list candidates when the neighbor counts were
+     * last collected.
+     * 
+     */
+    int _verletRebuilds = 0;
+
+    /**
+     * @brief Adds the neighbor counts and truncations of the last neighborhood build to the
+     * statistics. Called through SPH_STATS.
+     * 
+     */
+    void collectNeighborStats();
+
+    /**
+     * @brief Adds the density error of the last density computation to the statistics.
+     * Called through SPH_STATS.
+     * 
+     */
+    void collectDensityStats();
+
+    /**
+     * @brief Counts the update and writes its row to the trace file. Called through SPH_STATS.
+     * 
+     */
+    void finishUpdateStats();
+
+    /**
+     * @brief Make the loop schedule of this solver the one used by loops with a runtime
+     * schedule until the end of the update. Called at the start of each update.
+     * 
+     * @return LoopScheduleScope that restores the schedule of the caller when destroyed.
+     */
+    LoopScheduleScope applyLoopSchedule();
+
+    /**
+     * @brief Sort the particles by spatial locality if the reorder interval was reached.
+     * Must be called before the neighborhood is built.
+     * 
+     */
+    void reorderParticles();
+
+    /**
+     * @brief Checks if the next call to reorderParticles sorts the particles.
+     * 
+     * @return true if the reorder interval is reached on the next update.
+     * @return false otherwise.
+     */
+    bool isReorderDue();
+
     /**
      * @brief Compute the forces over each particle during one time step.
      * 
@@ -199,7 +886,7 @@ protected:
     void integrate();
 
     /**
-     * @brief Enforce the boundary conditions for each particle.
+     * @brief Enforce the boundary conditions for each particle: the walls, then the colliders.
      * 
      */
     void enforceBoundary();
@@ -210,6 +897,36 @@ protected:
      * @param filename: string representing the file's name.
      */
     void writeToFile();
+
+    /**
+     * @brief Write the output fields to the binary snapshot file.
+     * 
+     */
+    void writeSnapshot();
+
+    /**
+     * @brief Name of the solver stored on checkpoints, so they are only restored by the same
+     * type of solver.
+     * 
+     * @return std::string representing the name of the solver.
+     */
+    virtual std::string getCheckpointName();
+
+    /**
+     * @brief Writes the parameters of the solver to a binary stream.
+     * 
+     * @param stream: The stream to write to.
+     */
+    virtual void writeState(std::ostream& stream);
+
+    /**
+     * @brief Reads the parameters written by writeState from a binary stream.
+     * 
+     * @param stream: The stream to read from.
+     * @return true if the parameters were read.
+     * @return false otherwise.
+     */
+    virtual bool readState(std::istream& stream);
 };
 
 /**
@@ -0,0 +1,220 @@
+/**
+ * @file SphSolver3D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the base SPH solver for 3D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SPHSOLVER3D_H
+#define SPHSOLVER3D_H
+
+#include "SphParticleSystemData3D.h"
+#include "SnapshotWriter.h"
+#include "SolverStats.h"
+#include <eigen3/Eigen/Dense>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class that implements the base SPH solver for 3D particle systems, inside a box.
+ * The density, force and integration steps are the 3D instantiation of SphSolverCore, the
+ * ones SphSolver2D runs in 2D, so both solvers share the same equations, the sorted
+ * neighborhoods and the vectorized integration.
+ * 
+ * The simulation is written as binary snapshots, as read by SnapshotReader, with the
+ * "positions" field holding 3 components per particle.
+ * 
+ */
+class SphSolver3D {
+public:
+
+    /**
+     * @brief Construct a new SphSolver3D object with a block of particles at one kernel
+     * radius from each other, resting on the floor of the box.
+     * 
+     * @param numberOfParticles: Number of particles to added to the system.
+     * @param fileName: Name of the snapshot file to write the simulation to. Empty to disable writing.
+     */
+    SphSolver3D(int numberOfParticles, std::string fileName = "");
+
+    /**
+     * @brief Destructor for SphSolver3D.
+     * 
+     */
+    ~SphSolver3D();
+
+    /**
+     * @brief Add a particle to the system.
+     * 
+     * @param position: The position of the particle.
+     */
+    void addParticle(Eigen::Vector3d position);
+
+    /**
+     * @brief Get the positions of the particles.
+     * 
+     * @return std::vector<Eigen::Vector3d>& representing the positions.
+     */
+    std::vector<Eigen::Vector3d>& getPositions();
+
+    /**
+     * @brief Get the particle system data.
+     * 
+     * @return SphParticleSystemData3DPtr representing the particle system data.
+     */
+    SphParticleSystemData3DPtr getParticleSystemData();
+
+    /**
+     * @brief Get the size of the time steps.
+     * 
+     * @return double representing the time step size in seconds.
+     */
+    double getTimeStepSize();
+
+    /**
+     * @brief Get the statistics gathered since construction or the last reset. Timings and
+     * counters are only gathered when built with SPH_INSTRUMENTATION.
+     * 
+     * @return const SolverStats& representing the statistics.
+     */
+    const SolverStats& getStats();
+
+    /**
+     * @brief Clears the statistics.
+     * 
+     */
+    void resetStats();
+
+    /**
+     * @brief Perform one time step for the system, updating the parameters of each aprticle.
+     * 
+     */
+    void update();
+
+    /**
+     * @brief Get the kernel radius.
+     * 
+     * @return double representing the kernel radius.
+     */
+    double getKernelRadius();
+
+    /**
+     * @brief Get the width of the box, along x.
+     * 
+     * @return double representing the width.
+     */
+    double getViewWidth();
+
+    /**
+     * @brief Get the height of the box, along y.
+     * 
+     * @return double representing the height.
+     */
+    double getViewHeight();
+
+    /**
+     * @brief Get the depth of the box, along z.
+     * 
+     * @return double representing the depth.
+     */
+    double getViewDepth();
+
+private:
+
+    /**
+     * @brief std::shared_ptr to the particle system data.
+     * 
+     */
+    SphParticleSystemData3DPtr _particleSystemData;
+
+    /**
+     * @brief Planes of the box, as the normal pointing inside followed by the offset.
+     * 
+     */
+    std::vector<Eigen::Vector4d> _boundaries;
+
+    /**
+     * @brief Time step size in seconds.
+     * 
+     */
+    double _timeStepSizeInSeconds = 0.0007;
+
+    /**
+     * @brief Factor applied to the velocities of the particles touching a boundary.
+     * 
+     */
+    double _boundaryDumping = 1.0;
+
+    /**
+     * @brief Width of the box.
+     * 
+     */
+    double _viewWidth = 600.0;
+
+    /**
+     * @brief Height of the box.
+     * 
+     */
+    double _viewHeight = 900.0;
+
+    /**
+     * @brief Depth of the box.
+     * 
+     */
+    double _viewDepth = 300.0;
+
+    /**
+     * @brief Name of the snapshot file.
+     * 
+     */
+    std::string _fileName;
+
+    /**
+     * @brief Writer of the snapshot file, created on the first update.
+     * 
+     */
+    SnapshotWriterPtr _snapshotWriter;
+
+    /**
+     * @brief Statistics gathered since construction or the last reset.
+     * 
+     */
+    SolverStats _stats;
+
+    /**
+     * @brief Compute the pressure, viscosity and gravity forces on each particle.
+     * 
+     */
+    void computeForces();
+
+    /**
+     * @brief Integrate the velocities and the positions of the particles.
+     * 
+     */
+    void integrate();
+
+    /**
+     * @brief Push the particles near the planes of the box back inside.
+     * 
+     */
+    void enforceBoundary();
+
+    /**
+     * @brief Write the positions of the particles to the snapshot file.
+     * 
+     */
+    void writeSnapshot();
+};
+
+/**
+ * @brief std::shared_ptr for SphSolver3D.
+ * 
+ */
+typedef std::shared_ptr<SphSolver3D> SphSolver3DPtr;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,353 @@
+/**
+ * @file SphSolverCore.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements SphSolverCore: the per-particle SPH computations of the base
+ * solver, templated on the scalar type, the number of dimensions and the kernels.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SPHSOLVERCORE_H
+#define SPHSOLVERCORE_H
+
+#include <vector>
+#include <eigen3/Eigen/Dense>
+#include "Constants.h"
+#include "SphKernels.h"
+#include "ParticleNeighborhood2D.h"
+#include "ThreadLocalBuffers.h"
+#include <omp.h>
+
+/**
+ * @brief Class that holds the density, force and integration steps of the base SPH solver.
+ * Every step is a non-virtual template, so the kernels are inlined and the vector math is
+ * unrolled for the given scalar type and number of dimensions. SphParticleSystemData2D and
+ * SphSolver2D use the 2D double instantiation, while the float one halves the memory of the
+ * particle attributes. SphParticleSystemData3D and SphSolver3D use the 3D one, with the
+ * kernels normalized for 3D.
+ * 
+ * The steps are also templated on the neighborhood, which only needs a getNeighbors method
+ * returning a NeighborList2D, so non-virtual neighborhoods such as CellListNeighborhood3D are
+ * inlined as well.
+ * 
+ * Neighbor distances are rounded to single precision before the kernels are evaluated, as
+ * the reference implementation does, so both instantiations see the same distances.
+ * 
+ * The density and force sums over the neighbors are accumulated in the Accumulator type, so
+ * float attributes can be summed in double (mixed precision).
+ * 
+ * @tparam Scalar: floating point type of the particle attributes, float or double.
+ * @tparam Dimension: number of spatial dimensions, 2 or 3.
+ * @tparam Accumulator: floating point type of the sums over the neighbors.
+ * @tparam DensityKernel: kernel used for the densities.
+ * @tparam PressureKernel: kernel whose gradient is used for the pressure forces.
+ * @tparam ViscosityKernel: kernel whose laplacian is used for the viscosity forces.
+ */
+template <typename Scalar,
+    int Dimension,
+    typename Accumulator = Scalar,
+    typename DensityKernel = SphPoly6KernelT<Scalar, Dimension>,
+    typename PressureKernel = SphSpikyKernelT<Scalar, Dimension>,
+    typename ViscosityKernel = SphViscosityKernelT<Scalar, Dimension>>
+class SphSolverCore {
+public:
+
+    /**
+     * @brief Vector of the scalar type.
+     * 
+     */
+    typedef Eigen::Matrix<Scalar, Dimension, 1> Vector;
+
+    /**
+     * @brief Vector of the accumulator type.
+     * 
+     */
+    typedef Eigen::Matrix<Accumulator, Dimension, 1> AccumulatorVector;
+
+    /**
+     * @brief Construct a new SphSolverCore object.
+     * 
+     * @param kernelRadius: The radius of the kernels.
+     * @param mass: The mass of each particle.
+     * @param viscosityConstant: The viscosity constant.
+     */
+    SphSolverCore(Scalar kernelRadius, Scalar mass, Scalar viscosityConstant) :
+        _densityKernel(kernelRadius), _pressureKernel(kernelRadius), _viscosityKernel(kernelRadius),
+        _kernelRadius(kernelRadius), _kernelRadiusSquared(kernelRadius * kernelRadius),
+        _mass(mass), _viscosityConstant(viscosityConstant) { }
+
+    /**
+     * @brief Compute the density and the pressure of each particle.
+     * 
+     * @tparam Neighborhood: type of the neighborhood.
+     * @param neighborhood: Neighborhood built on the positions, with sorted full lists.
+     * @param positions: Position of each particle.
+     * @param densities: Array that receives the density of each particle.
+     * @param pressures: Array that receives the pressure of each particle.
+     */
+    template <typename Neighborhood>
+    void computeDensityPressure(
+        const Neighborhood& neighborhood,
+        const std::vector<Vector>& positions,
+        std::vector<Scalar>& densities,
+        std::vector<Scalar>& pressures) const {
+        const size_t numberOfParticles = positions.size();
+        const Scalar selfDensity = _mass * _densityKernel(_kernelRadiusSquared);
+
+        #pragma omp parallel
+        {
+            std::vector<Scalar> distanceSquaredDifferences;
+            std::vector<Scalar> weights;
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < numberOfParticles; i++) {
+                const NeighborList2D neighbors = neighborhood.getNeighbors(i);
+                distanceSquaredDifferences.resize(neighbors.size);
+                weights.resize(neighbors.size);
+
+                // Gather the neighbors first, so the kernel is evaluated on the whole
+                // neighborhood at once. Neighbors outside the kernel get a zero weight.
+                for (int k = 0; k < neighbors.size; k++) {
+                    Vector resultingVector = positions[neighbors.indices[k]] - positions[i];
+                    float distanceSquared = resultingVector.squaredNorm();
+                    distanceSquaredDifferences[k] = distanceSquared < _kernelRadiusSquared ?
+                        _kernelRadiusSquared - distanceSquared : Scalar(0.0);
+                }
+
+                _densityKernel(distanceSquaredDifferences.data(), weights.data(), neighbors.size);
+
+                // Neighbors arrive sorted by index and exclude the particle itself, so its own
+                // contribution is added in index order to keep the summation order of an all-pairs loop.
+                Accumulator density = 0;
+                bool selfAdded = false;
+
+                for (int k = 0; k < neighbors.size; k++) {
+                    if (!selfAdded && (size_t) neighbors.indices[k] > i) {
+                        density += selfDensity;
+                        selfAdded = true;
+                    }
+
+                    density += Accumulator(_mass * weights[k]);
+                }
+
+                if (!selfAdded) {
+                    density += selfDensity;
+                }
+
+                densities[i] = density;
+                pressures[i] = GAS_CONSTANT * (density - REST_DENSITY);
+            }
+        }
+    }
+
+    /**
+     * @brief Compute the density and the pressure of each particle from half neighbor lists,
+     * adding each pair to both of its particles through per-thread buffers.
+     * 
+     * @tparam Neighborhood: type of the neighborhood.
+     * @param neighborhood: Neighborhood built on the positions, with half lists.
+     * @param positions: Position of each particle.
+     * @param densityBuffers: Per-thread buffers that receive the sums of the pairs.
+     * @param densities: Array that receives the density of each particle.
+     * @param pressures: Array that receives the pressure of each particle.
+     */
+    template <typename Neighborhood>
+    void computeDensityPressureSymmetric(
+        const Neighborhood& neighborhood,
+        const std::vector<Vector>& positions,
+        ThreadLocalBuffers<Accumulator>& densityBuffers,
+        std::vector<Scalar>& densities,
+        std::vector<Scalar>& pressures) const {
+        const size_t numberOfParticles = positions.size();
+        const Scalar selfDensity = _mass * _densityKernel(_kernelRadiusSquared);
+        densityBuffers.reset(numberOfParticles, Accumulator(0));
+
+        #pragma omp parallel
+        {
+            Accumulator *pairDensities = densityBuffers.buffer(omp_get_thread_num());
+            std::vector<Scalar> distanceSquaredDifferences;
+            std::vector<Scalar> weights;
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < numberOfParticles; i++) {
+                const NeighborList2D neighbors = neighborhood.getNeighbors(i);
+                distanceSquaredDifferences.resize(neighbors.size);
+                weights.resize(neighbors.size);
+
+                for (int k = 0; k < neighbors.size; k++) {
+                    Vector resultingVector = positions[neighbors.indices[k]] - positions[i];
+                    float distanceSquared = resultingVector.squaredNorm();
+                    distanceSquaredDifferences[k] = distanceSquared < _kernelRadiusSquared ?
+                        _kernelRadiusSquared - distanceSquared : Scalar(0.0);
+                }
+
+                _densityKernel(distanceSquaredDifferences.data(), weights.data(), neighbors.size);
+
+                for (int k = 0; k < neighbors.size; k++) {
+                    const Accumulator density = Accumulator(_mass * weights[k]);
+                    pairDensities[i] += density;
+                    pairDensities[neighbors.indices[k]] += density;
+                }
+            }
+        }
+
+        #pragma omp parallel for
+        for (size_t i = 0; i < numberOfParticles; i++) {
+            const Accumulator density = densityBuffers.sum(i) + selfDensity;
+            densities[i] = density;
+            pressures[i] = GAS_CONSTANT * (density - REST_DENSITY);
+        }
+    }
+
+    /**
+     * @brief Compute the pressure, viscosity and gravity forces on each particle.
+     * 
+     * @tparam Neighborhood: type of the neighborhood.
+     * @param neighborhood: Neighborhood built on the positions, with sorted full lists.
+     * @param positions: Position of each particle.
+     * @param velocities: Velocity of each particle.
+     * @param densities: Density of each particle.
+     * @param pressures: Pressure of each particle.
+     * @param forces: Array that receives the force on each particle.
+     */
+    template <typename Neighborhood>
+    void computeForces(
+        const Neighborhood& neighborhood,
+        const std::vector<Vector>& positions,
+        const std::vector<Vector>& velocities,
+        const std::vector<Scalar>& densities,
+        const std::vector<Scalar>& pressures,
+        std::vector<Vector>& forces) const {
+        const size_t numberOfParticles = positions.size();
+        const Vector gravity = G3D.head<Dimension>().template cast<Scalar>();
+
+        #pragma omp parallel
+        {
+            std::vector<Scalar> distanceDifferences;
+            std::vector<Scalar> gradients;
+            std::vector<Scalar> laplacians;
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < numberOfParticles; i++) {
+                const NeighborList2D neighbors = neighborhood.getNeighbors(i);
+                AccumulatorVector fpress = AccumulatorVector::Zero();
+                AccumulatorVector fvisc = AccumulatorVector::Zero();
+                distanceDifferences.resize(neighbors.size);
+                gradients.resize(neighbors.size);
+                laplacians.resize(neighbors.size);
+
+                for (int k = 0; k < neighbors.size; k++) {
+                    float distance = neighbors.distances[k];
+                    distanceDifferences[k] = _kernelRadius - distance;
+                }
+
+                _pressureKernel.gradientsAt(distanceDifferences.data(), gradients.data(), neighbors.size);
+                _viscosityKernel.laplaciansAt(distanceDifferences.data(), laplacians.data(), neighbors.size);
+
+                for (int k = 0; k < neighbors.size; k++) {
+                    size_t j = neighbors.indices[k];
+                    Vector resultingVector = positions[j] - positions[i];
+                    float distance = neighbors.distances[k];
+
+                    if (distance < _kernelRadius) {
+                        // compute pressure force contribution
+                        fpress += (-resultingVector.normalized() * _mass * (pressures[i] + pressures[j]) /
+                                    (Scalar(2.0) * densities[j]) * gradients[k]).template cast<Accumulator>();
+                        // compute viscosity force contribution
+                        fvisc += (_viscosityConstant * _mass * (velocities[j] - velocities[i]) /
+                                    densities[j] * laplacians[k]).template cast<Accumulator>();
+                    }
+                }
+
+                Vector fgrav = gravity * _mass / densities[i];
+                forces[i] = (fpress + fvisc + fgrav.template cast<Accumulator>()).template cast<Scalar>();
+            }
+        }
+    }
+
+    /**
+     * @brief Integrate the velocities and the positions of the particles over one time step.
+     * 
+     * @param positions: Position of each particle, updated in place.
+     * @param velocities: Velocity of each particle, updated in place.
+     * @param forces: Force on each particle.
+     * @param densities: Density of each particle.
+     * @param timeStepSizeInSeconds: The size of the time step.
+     */
+    void integrate(
+        std::vector<Vector>& positions,
+        std::vector<Vector>& velocities,
+        const std::vector<Vector>& forces,
+        const std::vector<Scalar>& densities,
+        Scalar timeStepSizeInSeconds) const {
+        Scalar *positionComponents = positions.data()->data();
+        Scalar *velocityComponents = velocities.data()->data();
+        const Scalar *forceComponents = forces.data()->data();
+        const Scalar *densityValues = densities.data();
+        const int numberOfComponents = Dimension * positions.size();
+
+        #pragma omp parallel for simd
+        for (int k = 0; k < numberOfComponents; k++) {
+            velocityComponents[k] += (forceComponents[k] / densityValues[k / Dimension]) * timeStepSizeInSeconds;
+            positionComponents[k] += velocityComponents[k] * timeStepSizeInSeconds;
+        }
+    }
+
+private:
+
+    /**
+     * @brief Kernel used for the densities.
+     * 
+     */
+    DensityKernel _densityKernel;
+
+    /**
+     * @brief Kernel whose gradient is used for the pressure forces.
+     * 
+     */
+    PressureKernel _pressureKernel;
+
+    /**
+     * @brief Kernel whose laplacian is used for the viscosity forces.
+     * 
+     */
+    ViscosityKernel _viscosityKernel;
+
+    /**
+     * @brief The radius of the kernels.
+     * 
+     */
+    Scalar _kernelRadius;
+
+    /**
+     * @brief The radius of the kernels, squared.
+     * 
+     */
+    Scalar _kernelRadiusSquared;
+
+    /**
+     * @brief The mass of each particle.
+     * 
+     */
+    Scalar _mass;
+
+    /**
+     * @brief The viscosity constant.
+     * 
+     */
+    Scalar _viscosityConstant;
+};
+
+/**
+ * @brief The per-particle SPH computations of the base solver for 3D particle systems.
+ * 
+ * @tparam Scalar: floating point type of the particle attributes, float or double.
+ * @tparam Accumulator: floating point type of the sums over the neighbors.
+ */
+template <typename Scalar, typename Accumulator = Scalar>
+using SphSolverCore3D = SphSolverCore<Scalar, 3, Accumulator>;
+
+#endif
\ No newline at end of file
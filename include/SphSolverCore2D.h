@@ -0,0 +1,34 @@
+/**
+ * @file SphSolverCore2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that defines SphSolverCore2D: the 2D instantiation of the per-particle SPH
+ * computations of the base solver.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef SPHSOLVERCORE2D_H
+#define SPHSOLVERCORE2D_H
+
+#include "SphSolverCore.h"
+
+/**
+ * @brief The per-particle SPH computations of the base solver for 2D particle systems.
+ * 
+ * @tparam Scalar: floating point type of the particle attributes, float or double.
+ * @tparam Accumulator: floating point type of the sums over the neighbors.
+ * @tparam DensityKernel: kernel used for the densities.
+ * @tparam PressureKernel: kernel whose gradient is used for the pressure forces.
+ * @tparam ViscosityKernel: kernel whose laplacian is used for the viscosity forces.
+ */
+template <typename Scalar,
+    typename Accumulator = Scalar,
+    typename DensityKernel = SphPoly6KernelT<Scalar>,
+    typename PressureKernel = SphSpikyKernelT<Scalar>,
+    typename ViscosityKernel = SphViscosityKernelT<Scalar>>
+using SphSolverCore2D = SphSolverCore<Scalar, 2, Accumulator, DensityKernel, PressureKernel, ViscosityKernel>;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+/**
+ * @file ThreadLocalBuffers.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements ThreadLocalBuffers: per-thread accumulation buffers for
+ * per-particle values.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef THREADLOCALBUFFERS_H
+#define THREADLOCALBUFFERS_H
+
+#include <vector>
+#include <omp.h>
+
+/**
+ * @brief Class that holds one buffer of per-particle values for each OpenMP thread. Loops
+ * that add contributions to other particles than their own, such as pair-wise loops over
+ * half neighbor lists, write to the buffer of their thread and the buffers are summed
+ * afterwards, so no two threads write to the same value.
+ * 
+ * @tparam T: type of the values.
+ */
+template <typename T>
+class ThreadLocalBuffers {
+public:
+
+    /**
+     * @brief Resizes the buffers to hold size values each, one buffer per thread that a
+     * parallel region may use, and sets every value to zero.
+     * 
+     * @param size: Number of values of each buffer.
+     * @param zero: The value that does not change a sum.
+     */
+    void reset(size_t size, const T& zero) {
+        _size = size;
+        _zero = zero;
+        _numBuffers = omp_get_max_threads();
+        _values.assign(_size * _numBuffers, zero);
+    }
+
+    /**
+     * @brief Get the buffer of a thread.
+     * 
+     * @param thread: Number of the thread, as given by omp_get_thread_num().
+     * @return T* pointing to the first value of the buffer.
+     */
+    T* buffer(int thread) {
+        return &_values[thread * _size];
+    }
+
+    /**
+     * @brief Sums the values of every buffer at a given index. Buffers are always summed
+     * in the same order.
+     * 
+     * @param index: The index of the value.
+     * @return T representing the sum.
+     */
+    T sum(size_t index) const {
+        T result = _zero;
+
+        for (int thread = 0; thread < _numBuffers; thread++) {
+            result += _values[thread * _size + index];
+        }
+
+        return result;
+    }
+
+private:
+
+    /**
+     * @brief Values of every buffer, laid out buffer by buffer.
+     * 
+     */
+    std::vector<T> _values = {};
+
+    /**
+     * @brief Number of values of each buffer.
+     * 
+     */
+    size_t _size = 0;
+
+    /**
+     * @brief Number of buffers.
+     * 
+     */
+    int _numBuffers = 0;
+
+    /**
+     * @brief The value that does not change a sum.
+     * 
+     */
+    T _zero = T();
+};
+
+#endif
\ No newline at end of file
@@ -13,6 +13,7 @@
 #define VSPHPARTICLESYSTEMDATA2D_H
 
 #include "SphParticleSystemData2D.h"
+#include "ThreadLocalBuffers.h"
 #include <memory>
 
 /**
@@ -24,8 +25,9 @@ public:
     /**
      * @brief Default constructor for VSphParticleSystemData2D.
      * 
+     * @param neighborhoodType: Type of neighborhood structure used to find neighbor particles.
      */
-    VSphParticleSystemData2D();
+    VSphParticleSystemData2D(NeighborhoodType neighborhoodType = NeighborhoodType::Grid);
 
     /**
      * @brief Destructor for VSphParticleSystemData2D.
@@ -35,17 +37,33 @@ public:
 
     /**
      * @brief Compute density and pressure for each particle in 
-     * the system, as well as their variatinos.
+     * the system, as well as their variatinos. If the neighborhood stores
+     * half neighbor lists, each pair is evaluated once and added to both particles.
      * 
      */
     void computeDensityPressure() override;
 
     /**
-     * @brief Adds a new particle to the system with given position parameter.
+     * @brief Get the density the pressures push the particles towards.
      * 
-     * @param positon: the position of the particle to be added.
+     * @return double representing the rest density.
      */
-    void addParticle(Eigen::Vector2d positon) override;
+    double getRestDensity() override;
+
+private:
+
+    /**
+     * @brief Per-thread density variation sums for half neighbor lists.
+     * 
+     */
+    ThreadLocalBuffers<double> _densityVariationBuffers;
+
+    /**
+     * @brief Compute density and pressure, as well as their variations, evaluating each
+     * pair of a half neighbor list once.
+     * 
+     */
+    void computeDensityPressureSymmetric();
 };
 
 /**
@@ -13,8 +13,48 @@
 #define VSPHSOLVER2D_H
 
 #include "SphSolver2D.h"
+#include "ThreadLocalBuffers.h"
 #include <eigen3/Eigen/Dense>
 
+/**
+ * @brief Struct describing how VSphSolver2D splits each update into solver steps.
+ * 
+ */
+struct TimeStepSettings {
+
+    /**
+     * @brief If true, the size of each solver step follows the CFL condition on the largest
+     * velocity and acceleration. Otherwise every update runs 10 steps of equal size.
+     * 
+     */
+    bool adaptive = false;
+
+    /**
+     * @brief Largest fraction of the kernel radius a particle may travel in one step.
+     * 
+     */
+    double courantNumber = 0.4;
+
+    /**
+     * @brief Factor of the acceleration limit, which keeps the step below
+     * forceNumber * sqrt(kernelRadius / acceleration).
+     * 
+     */
+    double forceNumber = 0.25;
+
+    /**
+     * @brief Smallest size of a step, in seconds, so violent flows cannot stall the updates.
+     * 
+     */
+    double minTimeStepSize = 1.0 / 3000.0;
+
+    /**
+     * @brief Largest size of a step, in seconds.
+     * 
+     */
+    double maxTimeStepSize = 1.0 / 60.0;
+};
+
 /**
  * @brief Class that implemets the Viscoelastic SPH particle system solver for 2D systems.
  * 
@@ -39,8 +79,11 @@ public:
      * @brief Construct a new VSphSolver2D object with a given number of particles.
      * 
      * @param numberOfParticles: Number of particles to added to the system. 
+     * @param fileName: Name of the file to write the simulation data to. Empty to disable writing.
+     * @param neighborhoodType: Type of neighborhood structure used to find neighbor particles.
      */
-    VSphSolver2D(int numberOfParticles, std::string fileName = "");
+    VSphSolver2D(int numberOfParticles, std::string fileName = "",
+        NeighborhoodType neighborhoodType = NeighborhoodType::Grid);
 
     /**
      * @brief Perform one time step for the system, updating the parameters of each aprticle. 
@@ -48,25 +91,99 @@ public:
      */
     void update() override;
 
-private:
+    /**
+     * @brief Enables or disables symmetric pair-wise evaluation. When enabled, the
+     * neighborhood stores each pair of particles once and density and projection apply
+     * equal and opposite contributions to both particles, halving kernel evaluations.
+     * Results match the default mode up to rounding. Ignored in the deterministic mode.
+     * 
+     * @param symmetricPairs: true to evaluate each pair once.
+     * @return true if the mode was set.
+     * @return false if the solver does not support symmetric pairs and they were requested.
+     */
+    virtual bool setSymmetricPairs(bool symmetricPairs);
 
     /**
-     * @brief Number of substeps to perform in each time step.
+     * @brief Set the deterministic mode, falling back to full neighbor lists while it is
+     * enabled if symmetric pairs were requested.
      * 
+     * @param deterministic: true to enable the deterministic mode.
      */
-    int _solverSteps = 10;
+    void setDeterministic(bool deterministic) override;
 
     /**
-     * @brief Expected frames per second for the simulation.
+     * @brief Set the precision of the solver steps. Only double precision is supported, since
+     * the viscoelastic steps have no single precision attributes.
      * 
+     * @param precision: The precision.
+     * @return true if the precision is SolverPrecision::Double.
+     * @return false otherwise.
      */
-    int _fps = 30;
-    
+    bool setPrecision(SolverPrecision precision) override;
+
     /**
-     * @brief double representing the time step size in seconds square for the simulation.
+     * @brief Get the simulated time of one update, which runs several solver steps.
      * 
+     * @return double representing the time, in seconds, advanced by update().
      */
-    double _timeStepSizeInSecondsSquared = 1.0;
+    double getTimeStepSize() override;
+
+    /**
+     * @brief Set how each update is split into solver steps. Adaptive updates keep the steps
+     * of an update equal and pick their number from the CFL condition at each step, so calm
+     * flows run fewer steps and impacts run more.
+     * 
+     * @param settings: The time step settings.
+     */
+    void setTimeStepSettings(const TimeStepSettings& settings);
+
+    /**
+     * @brief Get the number of solver steps run by the last update.
+     * 
+     * @return int representing the number of steps.
+     */
+    int getSubsteps();
+
+protected:
+
+    /**
+     * @brief Name of the solver stored on checkpoints.
+     * 
+     * @return std::string representing the name of the solver.
+     */
+    std::string getCheckpointName() override;
+
+    /**
+     * @brief Writes the parameters of the solver to a binary stream.
+     * 
+     * @param stream: The stream to write to.
+     */
+    void writeState(std::ostream& stream) override;
+
+    /**
+     * @brief Reads the parameters written by writeState from a binary stream.
+     * 
+     * @param stream: The stream to read from.
+     * @return true if the parameters were read.
+     * @return false otherwise.
+     */
+    bool readState(std::istream& stream) override;
+
+    /**
+     * @brief Run one solver step of the current time step size.
+     * 
+     * @param timer: The timer of the update, which receives the time of each phase.
+     */
+    virtual void step(PhaseTimer& timer);
+
+    /**
+     * @brief Pick the size of the next adaptive step from the CFL condition and split the
+     * rest of the update into equal steps of at most that size.
+     * 
+     * @param remainingTime: Simulated time, in seconds, left in the update.
+     * @return double representing the size of the next step, in seconds.
+     */
+    virtual double computeTimeStepSize(double remainingTime);
 
     /**
      * @brief Apply external forces on each particle.
@@ -80,6 +197,12 @@ private:
      */
     void project();
 
+    /**
+     * @brief Project the particle positions evaluating each pair of a half neighbor list once.
+     * 
+     */
+    void projectSymmetric();
+
     /**
      * @brief Correct the positions and velocities to enforce fluid incompressibility.
      * 
@@ -91,6 +214,70 @@ private:
      * 
      */
     void integrate();
+
+    /**
+     * @brief Run the solver steps of one update, of equal size or picked by the CFL
+     * condition, as set by the time step settings.
+     * 
+     * @param timer: The timer of the update, which receives the time of each phase.
+     */
+    void runSteps(PhaseTimer& timer);
+
+    /**
+     * @brief Get the largest squared speed of a particle, used by the CFL condition.
+     * 
+     * @return double representing the squared speed.
+     */
+    virtual double computeMaxSpeedSquared();
+
+    /**
+     * @brief Number of substeps to perform in each time step.
+     * 
+     */
+    int _solverSteps = 10;
+
+    /**
+     * @brief Expected frames per second for the simulation.
+     * 
+     */
+    int _fps = 30;
+    
+    /**
+     * @brief double representing the time step size in seconds square for the simulation.
+     * 
+     */
+    double _timeStepSizeInSecondsSquared = 1.0;
+
+    /**
+     * @brief How each update is split into solver steps.
+     * 
+     */
+    TimeStepSettings _timeStepSettings;
+
+    /**
+     * @brief Number of solver steps run by the last update.
+     * 
+     */
+    int _substeps = 0;
+
+    /**
+     * @brief Largest velocity component change per second caused by the last correction.
+     * 
+     */
+    double _maxAcceleration = 0.0;
+
+    /**
+     * @brief If true, symmetric pairs were requested, and are used outside of the
+     * deterministic mode.
+     * 
+     */
+    bool _symmetricPairs = false;
+
+    /**
+     * @brief Per-thread projection displacements for half neighbor lists.
+     * 
+     */
+    ThreadLocalBuffers<Eigen::Vector2d> _displacementBuffers;
 };
 
 /**
@@ -0,0 +1,235 @@
+/**
+ * @file VerletNeighborhood2D.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Header of the Verlet list Neighborhood for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef VERLETNEIGHBORHOOD2D_H
+#define VERLETNEIGHBORHOOD2D_H
+
+#include <vector>
+#include <memory>
+#include <eigen3/Eigen/Dense>
+#include "ParticleNeighborhood2D.h"
+
+/**
+ * @brief Class describing a Verlet list neighborhood for 2D particle systems.
+ * 
+ * Wraps another neighborhood, which is built with the kernel radius plus a skin distance and
+ * gives the candidate neighbors of each particle. The candidates stay valid while no particle
+ * has moved more than half the skin since the last build of the wrapped neighborhood, so
+ * build() only rebuilds it when that happens. Otherwise, it recomputes the distance to every
+ * candidate and keeps the ones inside the kernel radius.
+ * 
+ * The candidates cover a disk as wide as the kernel radius plus the skin, so the wrapped
+ * neighborhood gets as many more slots as that disk has more area than the kernel, and no
+ * neighbor inside the kernel is lost to the capacity of the candidates.
+ * 
+ */
+class VerletNeighborhood2D: public ParticleNeighborhood2D {
+public:
+
+    /**
+     * @brief Construct a new VerletNeighborhood2D object.
+     * 
+     * @param neighborhood: The neighborhood that gives the candidate neighbors.
+     * @param skin: Distance added to the kernel radius when building the candidates.
+     */
+    VerletNeighborhood2D(ParticleNeighborhood2DPtr neighborhood, double skin);
+
+    /**
+     * @brief Destructor for the VerletNeighborhood2D class.
+     * 
+     */
+    ~VerletNeighborhood2D();
+
+    /**
+     * @brief Set the resolution of the grid. The wrapped neighborhood uses the kernel
+     * radius plus the skin, with its slots sized for that radius.
+     * 
+     * @param width: Width of the grid.
+     * @param height: Height of the grid.
+     * @param kernelRadius: Kernel radius.
+     */
+    void setGridResolution(int width, int height, double kernelRadius) override;
+
+    /**
+	 * @brief Loop through all neighbor particles of the given particle,
+	 * invoking a call to callback on each neighbor.
+	 * 
+	 * @param origin: Index of the particle that will have it's neighborhood
+	 * looped through.
+	 * @param callback: Callback function to be invoked on each neighbor.
+	 */
+    void forEachNearbyPoint(
+		const int origin,
+		const ForEachNearbyPointFunc& callback) const override;
+
+    /**
+     * @brief Get a view over the neighbors of the given particle, valid until the next build.
+     * 
+     * @param origin: Index of the particle.
+     * @return NeighborList2D representing the neighbors of the particle.
+     */
+    NeighborList2D getNeighbors(const int origin) const override;
+
+    /**
+	 * @brief Updates the neighbors of each particle, rebuilding the candidates only if a
+	 * particle moved more than half the skin since they were built.
+	 * 
+	 * @param points: array of all points that will be part of the neighborhood.
+	 */
+	void build(const std::vector<Eigen::Vector2d>& points) override;
+
+    /**
+	 * @brief Get the Distances of a particle to it's neighbors.
+	 * 
+	 * @param index: index of the particle to get the distances of.
+	 * @return std::vector<double> represeting the list of distances.
+	 */
+    std::vector<double> getDistances(int index) override;
+
+    /**
+     * @brief Enables or disables sorting each neighborhood by particle index.
+     * 
+     * @param sortByIndex: true to sort the neighborhoods by particle index.
+     */
+    void setSortByIndex(bool sortByIndex) override;
+
+    /**
+     * @brief Enables or disables half neighbor lists.
+     * 
+     * @param halfNeighborList: true to store each pair once.
+     */
+    void setHalfNeighborList(bool halfNeighborList) override;
+
+    /**
+     * @brief Checks if each pair of particles is stored once.
+     * 
+     * @return true if the neighborhood stores half neighbor lists.
+     * @return false if each pair is stored on the neighborhoods of both particles.
+     */
+    bool isHalfNeighborList() const override;
+
+    /**
+     * @brief Get the number of truncated neighborhoods on the last build of the candidates.
+     * The candidates include every neighbor, so filtering them truncates nothing.
+     * 
+     * @return size_t representing the number of truncated neighborhoods.
+     */
+    size_t getTruncatedCount() const override;
+
+    /**
+     * @brief Set the number of neighbors stored for each particle inside the kernel radius.
+     * The wrapped neighborhood gets the slots of the wider candidate disk.
+     * 
+     * @param maxNeighbors: The number of neighbor slots of each particle.
+     */
+    void setMaxNeighbors(int maxNeighbors) override;
+
+    /**
+     * @brief Discards the positions of the last build of the candidates, so the next build
+     * rebuilds them even if the particles barely moved.
+     * 
+     */
+    void invalidate() override;
+
+    /**
+     * @brief Get the neighborhood that gives the candidate neighbors.
+     * 
+     * @return ParticleNeighborhood2DPtr representing the wrapped neighborhood.
+     */
+    ParticleNeighborhood2DPtr getNeighborhood();
+
+    /**
+     * @brief Get the skin distance.
+     * 
+     * @return double representing the skin.
+     */
+    double getSkin();
+
+    /**
+     * @brief Get the number of times the candidates were rebuilt.
+     * 
+     * @return int representing the number of rebuilds.
+     */
+    int getRebuildCount();
+
+    /**
+     * @brief Default number of neighbors stored for a particle.
+     * 
+     */
+    const static int MAX_NEIGHBORS = 64;
+
+private:
+
+    /**
+     * @brief The neighborhood that gives the candidate neighbors.
+     * 
+     */
+    ParticleNeighborhood2DPtr _neighborhood;
+
+    /**
+     * @brief Positions of the particles when the candidates were built.
+     * 
+     */
+    std::vector<Eigen::Vector2d> _buildPositions;
+
+    /**
+     * @brief Neighbor indices, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<int> _neighbors;
+
+    /**
+     * @brief Distance to each neighbor, _maxNeighbors slots per particle.
+     * 
+     */
+    std::vector<double> _distances;
+
+    /**
+     * @brief Number of neighbors of each particle.
+     * 
+     */
+    std::vector<int> _numNeighbors;
+
+    /**
+     * @brief Distance added to the kernel radius when building the candidates.
+     * 
+     */
+    double _skin;
+
+    /**
+     * @brief The kernel radius.
+     * 
+     */
+    double _kernelRadius = 1.0;
+
+    /**
+     * @brief Number of times the candidates were rebuilt.
+     * 
+     */
+    int _rebuildCount = 0;
+
+    /**
+     * @brief Checks if any particle moved more than half the skin since the candidates were built.
+     * 
+     * @param points: array of all points that will be part of the neighborhood.
+     * @return true if the candidates must be rebuilt.
+     * @return false otherwise.
+     */
+    bool needsRebuild(const std::vector<Eigen::Vector2d>& points);
+};
+
+/**
+ * @brief std::shared_ptr to the VerletNeighborhood2D class.
+ * 
+ */
+typedef std::shared_ptr<VerletNeighborhood2D> VerletNeighborhood2DPtr;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+/**
+ * @file WorkStealingScheduler.h
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief File that implements WorkStealingScheduler: a class that runs independent tasks on
+ * a pool of threads, with idle threads stealing the tasks of busy ones.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#ifndef WORKSTEALINGSCHEDULER_H
+#define WORKSTEALINGSCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief This class runs a set of independent tasks on a pool of worker threads.
+ * 
+ * The tasks are dealt to one queue per worker, in order and round-robin. Each worker runs the
+ * tasks of its own queue from the front and, once it is empty, steals from the back of the
+ * queues of the other workers, so workers that drew short tasks take over the tail of the
+ * ones that drew long tasks. Tasks are expected to be coarse, such as a whole simulation, so
+ * each queue is guarded by its own mutex.
+ * 
+ */
+class WorkStealingScheduler {
+public:
+
+    /**
+     * @brief Construct a new WorkStealingScheduler object.
+     * 
+     * @param numberOfWorkers: Number of worker threads, 0 for one per hardware thread.
+     */
+    WorkStealingScheduler(int numberOfWorkers = 0) {
+        if (numberOfWorkers <= 0) {
+            numberOfWorkers = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (int worker = 0; worker < numberOfWorkers; worker++) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
+    /**
+     * @brief Get the number of worker threads.
+     * 
+     * @return int representing the number of workers.
+     */
+    int getNumberOfWorkers() const {
+        return queues.size();
+    }
+
+    /**
+     * @brief Runs every task and returns once all of them finished.
+     * 
+     * @param numberOfTasks: Number of tasks, numbered from 0.
+     * @param task: Function that runs a task, given its number and the number of the worker
+     * that runs it. Called concurrently from every worker.
+     */
+    void run(size_t numberOfTasks, const std::function<void(size_t, int)>& task) {
+        for (size_t i = 0; i < numberOfTasks; i++) {
+            queues[i % queues.size()]->tasks.push_back(i);
+        }
+
+        steals = 0;
+        std::vector<std::thread> workers;
+
+        for (int worker = 0; worker < getNumberOfWorkers(); worker++) {
+            workers.emplace_back([this, worker, &task]() {
+                size_t next;
+
+                while (pop(worker, next) || steal(worker, next)) {
+                    task(next, worker);
+                }
+            });
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Get the number of tasks of the last run that were stolen from another worker.
+     * 
+     * @return size_t representing the number of steals.
+     */
+    size_t getSteals() const {
+        return steals;
+    }
+
+private:
+
+    /**
+     * @brief Queue of the tasks of one worker.
+     * 
+     */
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    /**
+     * @brief The queue of each worker.
+     * 
+     */
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    /**
+     * @brief Number of tasks stolen on the last run.
+     * 
+     */
+    std::atomic<size_t> steals{0};
+
+    /**
+     * @brief Takes the next task of a worker's own queue.
+     * 
+     * @param worker: The worker.
+     * @param task: Receives the task.
+     * @return true if a task was taken.
+     * @return false if the queue is empty.
+     */
+    bool pop(int worker, size_t& task) {
+        WorkerQueue& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty()) {
+            return false;
+        }
+
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    /**
+     * @brief Takes the last task of the queue of another worker, visiting the other workers
+     * in order from the next one. No queue grows during a run, so once every queue is empty
+     * the worker is done.
+     * 
+     * @param worker: The worker that steals.
+     * @param task: Receives the task.
+     * @return true if a task was stolen.
+     * @return false if every queue is empty.
+     */
+    bool steal(int worker, size_t& task) {
+        for (int i = 1; i < getNumberOfWorkers(); i++) {
+            WorkerQueue& queue = *queues[(worker + i) % getNumberOfWorkers()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.tasks.empty()) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+                steals++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+/**
+ * @brief std::shared_ptr for WorkStealingScheduler.
+ * 
+ */
+typedef std::shared_ptr<WorkStealingScheduler> WorkStealingSchedulerPtr;
+
+#endif
\ No newline at end of file
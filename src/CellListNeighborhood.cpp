@@ -0,0 +1,263 @@
+/**
+ * @file CellListNeighborhood.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the compact Cell List Neighborhood for 2D and 3D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/CellListNeighborhood.h"
+#include "../include/Constants.h"
+#include "../include/SolverStats.h"
+#include <algorithm>
+#include <omp.h>
+
+template <int Dimension>
+CellListNeighborhoodT<Dimension>::CellListNeighborhoodT() {
+    setGridResolution(Vector::Constant(100.0), 1.0);
+}
+
+template <int Dimension>
+CellListNeighborhoodT<Dimension>::~CellListNeighborhoodT() { }
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::setGridResolution(const Vector& size, double kernelRadius) {
+    _cellSize = kernelRadius;
+    _numCells = 1;
+
+    for (int d = 0; d < Dimension; d++) {
+        _cells[d] = size(d) / _cellSize;
+        _strides[d] = _numCells;
+        _numCells *= _cells[d];
+    }
+
+    // Offsets of the 3^Dimension cells around a cell, read as base 3 digits of k with the
+    // first dimension as the most significant one.
+    int numNeighborCells = 1;
+    for (int d = 0; d < Dimension; d++) {
+        numNeighborCells *= 3;
+    }
+
+    _neighborCellOffsets.resize(numNeighborCells);
+
+    for (int k = 0; k < numNeighborCells; k++) {
+        int digits = k;
+        int offset = 0;
+
+        for (int d = Dimension - 1; d >= 0; d--) {
+            offset += (digits % 3 - 1) * _strides[d];
+            digits /= 3;
+        }
+
+        _neighborCellOffsets[k] = offset;
+    }
+
+    _cellStart = std::vector<int>(_numCells + 1, 0);
+    _cellCounts = std::vector<int>(_numCells, 0);
+}
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::sortIntoCells(const std::vector<Vector>& points) {
+    const int numberOfPoints = points.size();
+    const int numChunks = omp_get_max_threads();
+    const int chunkSize = (numberOfPoints + numChunks - 1) / numChunks;
+    const int cellBlockSize = (_numCells + numChunks - 1) / numChunks;
+    std::vector<int> blockStart(numChunks + 1, 0);
+
+    _particleCells.resize(numberOfPoints);
+    _cellParticles.resize(numberOfPoints);
+    _chunkCounts.assign((size_t) numChunks * _numCells, 0);
+
+    // Count the particles of each chunk on each cell.
+    #pragma omp parallel for
+    for (int chunk = 0; chunk < numChunks; chunk++) {
+        int *counts = &_chunkCounts[(size_t) chunk * _numCells];
+        int end = std::min(numberOfPoints, (chunk + 1) * chunkSize);
+
+        for (int i = chunk * chunkSize; i < end; i++) {
+            int cell = 0;
+
+            for (int d = 0; d < Dimension; d++) {
+                int index = points[i](d) / _cellSize;
+                index = std::max(1, std::min(_cells[d] - 2, index));
+                cell += index * _strides[d];
+            }
+
+            _particleCells[i] = cell;
+            counts[cell]++;
+        }
+    }
+
+    // Turn the chunk counts into the offset of each chunk inside each cell.
+    #pragma omp parallel for
+    for (int cell = 0; cell < _numCells; cell++) {
+        int count = 0;
+
+        for (int chunk = 0; chunk < numChunks; chunk++) {
+            int &chunkCount = _chunkCounts[(size_t) chunk * _numCells + cell];
+            int offset = count;
+            count += chunkCount;
+            chunkCount = offset;
+        }
+
+        _cellCounts[cell] = count;
+    }
+
+    // Exclusive prefix sum over the cell counts, one block of cells per chunk.
+    #pragma omp parallel for
+    for (int chunk = 0; chunk < numChunks; chunk++) {
+        int end = std::min(_numCells, (chunk + 1) * cellBlockSize);
+
+        for (int cell = chunk * cellBlockSize; cell < end; cell++) {
+            blockStart[chunk + 1] += _cellCounts[cell];
+        }
+    }
+
+    for (int chunk = 0; chunk < numChunks; chunk++) {
+        blockStart[chunk + 1] += blockStart[chunk];
+    }
+
+    #pragma omp parallel for
+    for (int chunk = 0; chunk < numChunks; chunk++) {
+        int start = blockStart[chunk];
+        int end = std::min(_numCells, (chunk + 1) * cellBlockSize);
+
+        for (int cell = chunk * cellBlockSize; cell < end; cell++) {
+            _cellStart[cell] = start;
+            start += _cellCounts[cell];
+        }
+    }
+
+    _cellStart[_numCells] = numberOfPoints;
+
+    // Scatter the particle indices, each chunk writing to its own slots of each cell.
+    #pragma omp parallel for
+    for (int chunk = 0; chunk < numChunks; chunk++) {
+        int *offsets = &_chunkCounts[(size_t) chunk * _numCells];
+        int end = std::min(numberOfPoints, (chunk + 1) * chunkSize);
+
+        for (int i = chunk * chunkSize; i < end; i++) {
+            int cell = _particleCells[i];
+            _cellParticles[_cellStart[cell] + offsets[cell]++] = i;
+        }
+    }
+}
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::build(const std::vector<Vector>& points) {
+    const int numberOfPoints = points.size();
+
+    sortIntoCells(points);
+
+    _numNeighbors.resize(numberOfPoints);
+    _neighbors.resize((size_t) numberOfPoints * _maxNeighbors);
+    _distances.resize((size_t) numberOfPoints * _maxNeighbors);
+
+    size_t truncatedCount = 0;
+
+    #pragma omp parallel for schedule(runtime) reduction(+: truncatedCount)
+    for (int i = 0; i < numberOfPoints; i++) {
+        const Vector &pi = points[i];
+        SPH_STATS(bool truncated = false);
+        int *neighbors = &_neighbors[(size_t) i * _maxNeighbors];
+        double *distances = &_distances[(size_t) i * _maxNeighbors];
+        int numNeighbors = 0;
+
+        for (int offset : _neighborCellOffsets) {
+            int cell = _particleCells[i] + offset;
+
+            // Each cell is visited from its last particle to its first, which is the
+            // order of the linked lists built by GridNeighborhood2D.
+            for (int k = _cellStart[cell + 1] - 1; k >= _cellStart[cell]; k--) {
+                int j = _cellParticles[k];
+                if (_halfNeighborList && j <= i)
+                    continue;
+
+                Vector dx = points[j] - pi;
+                double r2 = dx.squaredNorm();
+                if (r2 < EPS || r2 > _cellSize * _cellSize)
+                    continue;
+
+                if (numNeighbors < _maxNeighbors) {
+                    neighbors[numNeighbors] = j;
+                    distances[numNeighbors] = sqrt(r2);
+                    ++numNeighbors;
+                } else {
+                    SPH_STATS(truncated = true);
+                }
+            }
+        }
+
+        _numNeighbors[i] = numNeighbors;
+        SPH_STATS(truncatedCount += truncated);
+
+        if (_sortByIndex) {
+            sortNeighborhood(i);
+        }
+    }
+
+    _truncatedCount = truncatedCount;
+}
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::sortNeighborhood(int index) {
+    int *neighbors = &_neighbors[(size_t) index * _maxNeighbors];
+    double *distances = &_distances[(size_t) index * _maxNeighbors];
+
+    for (int k = 1; k < _numNeighbors[index]; k++) {
+        int neighbor = neighbors[k];
+        double distance = distances[k];
+        int l = k - 1;
+
+        while (l >= 0 && neighbors[l] > neighbor) {
+            neighbors[l + 1] = neighbors[l];
+            distances[l + 1] = distances[l];
+            l--;
+        }
+
+        neighbors[l + 1] = neighbor;
+        distances[l + 1] = distance;
+    }
+}
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::setSortByIndex(bool sortByIndex) {
+    _sortByIndex = sortByIndex;
+}
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::setHalfNeighborList(bool halfNeighborList) {
+    _halfNeighborList = halfNeighborList;
+}
+
+template <int Dimension>
+bool CellListNeighborhoodT<Dimension>::isHalfNeighborList() const {
+    return _halfNeighborList;
+}
+
+template <int Dimension>
+size_t CellListNeighborhoodT<Dimension>::getTruncatedCount() const {
+    return _truncatedCount;
+}
+
+template <int Dimension>
+void CellListNeighborhoodT<Dimension>::setMaxNeighbors(int maxNeighbors) {
+    _maxNeighbors = maxNeighbors;
+}
+
+template <int Dimension>
+int CellListNeighborhoodT<Dimension>::getMaxNeighbors() const {
+    return _maxNeighbors;
+}
+
+template <int Dimension>
+std::vector<double> CellListNeighborhoodT<Dimension>::getDistances(int index) const {
+    const double *distances = &_distances[(size_t) index * _maxNeighbors];
+    return std::vector<double>(distances, distances + _numNeighbors[index]);
+}
+
+template class CellListNeighborhoodT<2>;
+template class CellListNeighborhoodT<3>;
\ No newline at end of file
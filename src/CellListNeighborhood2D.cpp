@@ -0,0 +1,58 @@
+/**
+ * @file CellListNeighborhood2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the compact Cell List Neighborhood for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/CellListNeighborhood2D.h"
+
+CellListNeighborhood2D::CellListNeighborhood2D() : ParticleNeighborhood2D() { }
+
+CellListNeighborhood2D::~CellListNeighborhood2D() { }
+
+void CellListNeighborhood2D::setGridResolution(int width, int height, double kernelRadius) {
+    _cellList.setGridResolution(Eigen::Vector2d(width, height), kernelRadius);
+}
+
+void CellListNeighborhood2D::forEachNearbyPoint(const int origin,
+    const ForEachNearbyPointFunc& callback) const {
+    _cellList.forEachNeighbor(origin, callback);
+}
+
+NeighborList2D CellListNeighborhood2D::getNeighbors(const int origin) const {
+    return _cellList.getNeighbors(origin);
+}
+
+void CellListNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
+    _cellList.build(points);
+    _truncatedCount = _cellList.getTruncatedCount();
+}
+
+void CellListNeighborhood2D::setSortByIndex(bool sortByIndex) {
+    _cellList.setSortByIndex(sortByIndex);
+}
+
+void CellListNeighborhood2D::setHalfNeighborList(bool halfNeighborList) {
+    _cellList.setHalfNeighborList(halfNeighborList);
+}
+
+bool CellListNeighborhood2D::isHalfNeighborList() const {
+    return _cellList.isHalfNeighborList();
+}
+
+void CellListNeighborhood2D::setMaxNeighbors(int maxNeighbors) {
+    _cellList.setMaxNeighbors(maxNeighbors);
+}
+
+int CellListNeighborhood2D::getMaxNeighbors() const {
+    return _cellList.getMaxNeighbors();
+}
+
+std::vector<double> CellListNeighborhood2D::getDistances(int index) {
+    return _cellList.getDistances(index);
+}
\ No newline at end of file
@@ -0,0 +1,478 @@
+/**
+ * @file DeviceVSphSolver2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the Viscoelastic SPH solver for 2D systems that runs its solver
+ * steps on an OpenMP offload device.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/DeviceVSphSolver2D.h"
+#include "../include/Constants.h"
+#include <algorithm>
+#include <cmath>
+
+DeviceVSphSolver2D::DeviceVSphSolver2D(int numberOfParticles, std::string fileName) :
+    VSphSolver2D(numberOfParticles, fileName) {
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+
+    _device = omp_get_num_devices() > 0 ? omp_get_default_device() : omp_get_initial_device();
+    // Same cells as GridNeighborhood2D, which takes the size of the view in whole units.
+    _gridWidth = (int) _viewWidth / kernelRadius;
+    _gridHeight = (int) _viewHeight / kernelRadius;
+}
+
+DeviceVSphSolver2D::~DeviceVSphSolver2D() {}
+
+void DeviceVSphSolver2D::update() {
+    PhaseTimer timer;
+
+    // Emitters, sinks and spatial sorts change the particles on the host, so the particles
+    // only go back and forth on the updates that run them.
+    if (!_emitters.empty() || !_sinks.empty() || isReorderDue()) {
+        synchronize();
+        applyEmittersAndSinks();
+        reorderParticles();
+        _deviceParticles = -1;
+    } else {
+        reorderParticles();
+    }
+    timer.lap(_stats.timings.boundary);
+
+    if (_deviceParticles != (int) _particleSystemData->numberOfParticles) {
+        upload();
+    }
+    timer.lap(_stats.timings.neighborBuild);
+    runSteps(timer);
+
+    if (_fileName != "") {
+        synchronize();
+        writeToFile();
+        timer.lap(_stats.timings.output);
+    }
+
+    SPH_STATS(_stats.solverSteps += _substeps);
+    SPH_STATS(finishUpdateStats());
+}
+
+void DeviceVSphSolver2D::step(PhaseTimer& timer) {
+    applyExternalForcesOnDevice();
+    timer.lap(_stats.timings.forces);
+    integrateOnDevice();
+    timer.lap(_stats.timings.integrate);
+    buildNeighborhoodOnDevice();
+    SPH_STATS(_stats.neighborBuilds++);
+    SPH_STATS(_stats.neighborRebuilds++);
+    timer.lap(_stats.timings.neighborBuild);
+    computeDensityPressureOnDevice();
+    timer.lap(_stats.timings.densityPressure);
+    projectOnDevice();
+    timer.lap(_stats.timings.forces);
+    correctOnDevice();
+    timer.lap(_stats.timings.integrate);
+    enforceBoundaryOnDevice();
+    timer.lap(_stats.timings.boundary);
+
+    _positionsOnHost = false;
+    _stateOnHost = false;
+}
+
+const std::vector<Eigen::Vector2d>& DeviceVSphSolver2D::getPositions() {
+    if (!_positionsOnHost) {
+        _positions.download(flatData(_particleSystemData->getPositions()), 2 * _deviceParticles);
+        _positionsOnHost = true;
+        _positionDownloads++;
+    }
+
+    return VSphSolver2D::getPositions();
+}
+
+SphParticleSystemData2DPtr DeviceVSphSolver2D::getParticleSystemData() {
+    synchronize();
+    return _particleSystemData;
+}
+
+void DeviceVSphSolver2D::synchronize() {
+    if (_stateOnHost) {
+        return;
+    }
+
+    const size_t numberOfParticles = _deviceParticles;
+
+    if (!_positionsOnHost) {
+        _positions.download(flatData(_particleSystemData->getPositions()), 2 * numberOfParticles);
+        _positionDownloads++;
+    }
+
+    _velocities.download(flatData(_particleSystemData->getVelocities()), 2 * numberOfParticles);
+    _lastPositions.download(flatData(_particleSystemData->getLastPositions()), 2 * numberOfParticles);
+    _projectedPositions.download(flatData(_particleSystemData->getProjectedPositions()), 2 * numberOfParticles);
+    _densities.download(_particleSystemData->getDensities().data(), numberOfParticles);
+    _densityVariations.download(_particleSystemData->getDensityVariations().data(), numberOfParticles);
+    _pressures.download(_particleSystemData->getPressures().data(), numberOfParticles);
+    _pressureVariations.download(_particleSystemData->getPressureVariations().data(), numberOfParticles);
+
+    _positionsOnHost = true;
+    _stateOnHost = true;
+}
+
+bool DeviceVSphSolver2D::saveCheckpoint(const std::string& fileName) {
+    synchronize();
+    return VSphSolver2D::saveCheckpoint(fileName);
+}
+
+bool DeviceVSphSolver2D::loadCheckpoint(const std::string& fileName) {
+    synchronize();
+    return VSphSolver2D::loadCheckpoint(fileName);
+}
+
+bool DeviceVSphSolver2D::addCollider(SdfCollider2DPtr) {
+    return false;
+}
+
+bool DeviceVSphSolver2D::setSymmetricPairs(bool symmetricPairs) {
+    return !symmetricPairs && VSphSolver2D::setSymmetricPairs(symmetricPairs);
+}
+
+bool DeviceVSphSolver2D::readState(std::istream& stream) {
+    _deviceParticles = -1;
+    _positionsOnHost = true;
+    _stateOnHost = true;
+    return VSphSolver2D::readState(stream);
+}
+
+bool DeviceVSphSolver2D::isOnDevice() {
+    return _device != omp_get_initial_device();
+}
+
+size_t DeviceVSphSolver2D::getPositionDownloads() {
+    return _positionDownloads;
+}
+
+void DeviceVSphSolver2D::upload() {
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    const size_t numCells = (size_t) _gridWidth * _gridHeight;
+
+    _positions.resize(2 * numberOfParticles, _device);
+    _velocities.resize(2 * numberOfParticles, _device);
+    _lastPositions.resize(2 * numberOfParticles, _device);
+    _projectedPositions.resize(2 * numberOfParticles, _device);
+    _densities.resize(numberOfParticles, _device);
+    _densityVariations.resize(numberOfParticles, _device);
+    _pressures.resize(numberOfParticles, _device);
+    _pressureVariations.resize(numberOfParticles, _device);
+    _cellIndices.resize(numberOfParticles, _device);
+    _cellCounts.resize(numCells, _device);
+    _cellStarts.resize(numCells + 1, _device);
+    _cellParticles.resize(numberOfParticles, _device);
+    _neighbors.resize(numberOfParticles * MAX_NEIGHBORS, _device);
+    _distances.resize(numberOfParticles * MAX_NEIGHBORS, _device);
+    _numNeighbors.resize(numberOfParticles, _device);
+
+    _positions.upload(flatData(_particleSystemData->getPositions()), 2 * numberOfParticles);
+    _velocities.upload(flatData(_particleSystemData->getVelocities()), 2 * numberOfParticles);
+    _lastPositions.upload(flatData(_particleSystemData->getLastPositions()), 2 * numberOfParticles);
+
+    _deviceParticles = numberOfParticles;
+    _positionsOnHost = true;
+    _stateOnHost = true;
+}
+
+void DeviceVSphSolver2D::applyExternalForcesOnDevice() {
+    double *velocities = _velocities.data();
+    const double gravity0 = _timeStepSizeInSeconds * G2D(0);
+    const double gravity1 = _timeStepSizeInSeconds * G2D(1);
+    const int numberOfComponents = 2 * _deviceParticles;
+
+    #pragma omp target teams distribute parallel for device(_device) is_device_ptr(velocities)
+    for (int k = 0; k < numberOfComponents; k++) {
+        velocities[k] += (k & 1) ? gravity1 : gravity0;
+    }
+}
+
+void DeviceVSphSolver2D::integrateOnDevice() {
+    double *positions = _positions.data();
+    const double *velocities = _velocities.data();
+    double *lastPositions = _lastPositions.data();
+    const double timeStepSize = _timeStepSizeInSeconds;
+    const int numberOfComponents = 2 * _deviceParticles;
+
+    #pragma omp target teams distribute parallel for device(_device) \
+        is_device_ptr(positions, velocities, lastPositions)
+    for (int k = 0; k < numberOfComponents; k++) {
+        lastPositions[k] = positions[k];
+        positions[k] += timeStepSize * velocities[k];
+    }
+}
+
+void DeviceVSphSolver2D::buildNeighborhoodOnDevice() {
+    const double *positions = _positions.data();
+    int *cellIndices = _cellIndices.data();
+    int *cellCounts = _cellCounts.data();
+    int *cellStarts = _cellStarts.data();
+    int *cellParticles = _cellParticles.data();
+    int *neighbors = _neighbors.data();
+    double *distances = _distances.data();
+    int *numNeighbors = _numNeighbors.data();
+    const double cellSize = _particleSystemData->getKernelRadius();
+    const int width = _gridWidth;
+    const int height = _gridHeight;
+    const int numCells = width * height;
+    const int numberOfPoints = _deviceParticles;
+
+    #pragma omp target teams distribute parallel for device(_device) is_device_ptr(cellCounts)
+    for (int cell = 0; cell < numCells; cell++) {
+        cellCounts[cell] = 0;
+    }
+
+    #pragma omp target teams distribute parallel for device(_device) \
+        is_device_ptr(positions, cellIndices, cellCounts)
+    for (int i = 0; i < numberOfPoints; i++) {
+        int xind = positions[2 * i] / cellSize;
+        int yind = positions[2 * i + 1] / cellSize;
+        xind = std::max(1, std::min(width - 2, xind));
+        yind = std::max(1, std::min(height - 2, yind));
+        cellIndices[i] = xind + yind * width;
+
+        #pragma omp atomic update
+        cellCounts[xind + yind * width]++;
+    }
+
+    // There are far fewer cells than particles, so one device thread scans the counts, and
+    // clears them to count the particles written to each cell.
+    #pragma omp target device(_device) is_device_ptr(cellCounts, cellStarts)
+    {
+        cellStarts[0] = 0;
+
+        for (int cell = 0; cell < numCells; cell++) {
+            cellStarts[cell + 1] = cellStarts[cell] + cellCounts[cell];
+            cellCounts[cell] = 0;
+        }
+    }
+
+    #pragma omp target teams distribute parallel for device(_device) \
+        is_device_ptr(cellIndices, cellCounts, cellStarts, cellParticles)
+    for (int i = 0; i < numberOfPoints; i++) {
+        const int cell = cellIndices[i];
+        int slot;
+
+        #pragma omp atomic capture
+        slot = cellCounts[cell]++;
+
+        cellParticles[cellStarts[cell] + slot] = i;
+    }
+
+    // The atomic writes land in any order, so each cell is sorted by index, which keeps the
+    // neighbor order, and the sums over the neighbors, the same on every run.
+    #pragma omp target teams distribute parallel for device(_device) is_device_ptr(cellStarts, cellParticles)
+    for (int cell = 0; cell < numCells; cell++) {
+        for (int k = cellStarts[cell] + 1; k < cellStarts[cell + 1]; k++) {
+            const int particle = cellParticles[k];
+            int l = k - 1;
+
+            while (l >= cellStarts[cell] && cellParticles[l] > particle) {
+                cellParticles[l + 1] = cellParticles[l];
+                l--;
+            }
+
+            cellParticles[l + 1] = particle;
+        }
+    }
+
+    #pragma omp target teams distribute parallel for device(_device) \
+        is_device_ptr(positions, cellIndices, cellStarts, cellParticles, neighbors, distances, numNeighbors)
+    for (int i = 0; i < numberOfPoints; i++) {
+        const double pix = positions[2 * i];
+        const double piy = positions[2 * i + 1];
+        const int xind = cellIndices[i] % width;
+        const int yind = cellIndices[i] / width;
+        int count = 0;
+
+        for (int ii = xind - 1; ii <= xind + 1; ii++) {
+            for (int jj = yind - 1; jj <= yind + 1; jj++) {
+                const int cell = ii + jj * width;
+
+                // GridNeighborhood2D lists the particles of a cell from the highest index.
+                for (int k = cellStarts[cell + 1] - 1; k >= cellStarts[cell]; k--) {
+                    const int j = cellParticles[k];
+                    const double dx = positions[2 * j] - pix;
+                    const double dy = positions[2 * j + 1] - piy;
+                    const double r2 = dx * dx + dy * dy;
+
+                    if (r2 < EPS || r2 > cellSize * cellSize || count == MAX_NEIGHBORS)
+                        continue;
+
+                    neighbors[(size_t) i * MAX_NEIGHBORS + count] = j;
+                    distances[(size_t) i * MAX_NEIGHBORS + count] = sqrt(r2);
+                    count++;
+                }
+            }
+        }
+
+        numNeighbors[i] = count;
+    }
+}
+
+void DeviceVSphSolver2D::computeDensityPressureOnDevice() {
+    const double *distances = _distances.data();
+    const int *numNeighbors = _numNeighbors.data();
+    double *densities = _densities.data();
+    double *densityVariations = _densityVariations.data();
+    double *pressures = _pressures.data();
+    double *pressureVariations = _pressureVariations.data();
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    const double mass = _particleSystemData->getMass();
+    const double kernelFactor = _particleSystemData->getKernelFactor();
+    const double kernelFactorNorm = _particleSystemData->getKernelFactorNorm();
+    const double stiffness = _particleSystemData->getStiffness();
+    const double stiffnessAtProximity = _particleSystemData->getStiffnessAtProximity();
+    const int numberOfParticles = _deviceParticles;
+
+    #pragma omp target teams distribute parallel for device(_device) \
+        is_device_ptr(distances, numNeighbors, densities, densityVariations, pressures, pressureVariations)
+    for (int i = 0; i < numberOfParticles; i++) {
+        double density = 0.0;
+        double densityVariation = 0.0;
+
+        for (int k = 0; k < numNeighbors[i]; k++) {
+            double a = 1. - distances[(size_t) i * MAX_NEIGHBORS + k] / kernelRadius;
+            density += mass * a * a * a * kernelFactor;
+            densityVariation += mass * a * a * a * a * kernelFactorNorm;
+        }
+
+        densities[i] = density;
+        densityVariations[i] = densityVariation;
+        pressures[i] = stiffness * (density - mass * ELASTIC_REST_DENSITY);
+        pressureVariations[i] = stiffnessAtProximity * densityVariation;
+    }
+}
+
+void DeviceVSphSolver2D::projectOnDevice() {
+    const double *positions = _positions.data();
+    const double *velocities = _velocities.data();
+    const double *pressures = _pressures.data();
+    const double *pressureVariations = _pressureVariations.data();
+    const int *neighbors = _neighbors.data();
+    const double *distances = _distances.data();
+    const int *numNeighbors = _numNeighbors.data();
+    double *projectedPositions = _projectedPositions.data();
+    const double kernelFactor = _particleSystemData->getKernelFactor();
+    const double kernelFactorNorm = _particleSystemData->getKernelFactorNorm();
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    const double mass = _particleSystemData->getMass();
+    const double surfaceTension = _particleSystemData->getSurfaceTension();
+    const double linearViscosity = _particleSystemData->getLinearViscosity();
+    const double quadraticViscosity = _particleSystemData->getQuadraticViscosity();
+    const double timeStepSize = _timeStepSizeInSeconds;
+    const double timeStepSizeSquared = _timeStepSizeInSecondsSquared;
+    const int numberOfParticles = _deviceParticles;
+
+    // Same operations, in the same order, as VSphSolver2D::project.
+    #pragma omp target teams distribute parallel for device(_device) \
+        is_device_ptr(positions, velocities, pressures, pressureVariations, neighbors, distances, \
+            numNeighbors, projectedPositions)
+    for (int i = 0; i < numberOfParticles; i++) {
+        double px = positions[2 * i];
+        double py = positions[2 * i + 1];
+
+        for (int k = 0; k < numNeighbors[i]; k++) {
+            const int j = neighbors[(size_t) i * MAX_NEIGHBORS + k];
+            const double r = distances[(size_t) i * MAX_NEIGHBORS + k];
+            const double dx = positions[2 * j] - positions[2 * i];
+            const double dy = positions[2 * j + 1] - positions[2 * i + 1];
+
+            double a = 1. - r / kernelRadius;
+            double d = timeStepSizeSquared *
+                         ((pressureVariations[i] + pressureVariations[j])
+                          * a * a * a * kernelFactorNorm + (pressures[i] + pressures[j])
+                           * a * a * kernelFactor) / 2.;
+
+            // relaxation
+            px -= d * dx / (r * mass);
+            py -= d * dy / (r * mass);
+
+            const double tension = (surfaceTension / mass) * mass * a * a * kernelFactor;
+            px += tension * dx;
+            py += tension * dy;
+
+            // linear and quadratic visc
+            const double dvx = velocities[2 * i] - velocities[2 * j];
+            const double dvy = velocities[2 * i + 1] - velocities[2 * j + 1];
+            double u = dvx * dx + dvy * dy;
+            if (u > 0) {
+                u /= r;
+                double I = 0.5 * timeStepSize * a * (linearViscosity * u + quadraticViscosity * u * u);
+                px -= I * dx * timeStepSize;
+                py -= I * dy * timeStepSize;
+            }
+        }
+
+        projectedPositions[2 * i] = px;
+        projectedPositions[2 * i + 1] = py;
+    }
+}
+
+void DeviceVSphSolver2D::correctOnDevice() {
+    double *positions = _positions.data();
+    double *velocities = _velocities.data();
+    const double *projectedPositions = _projectedPositions.data();
+    const double *lastPositions = _lastPositions.data();
+    const double timeStepSize = _timeStepSizeInSeconds;
+    const int numberOfComponents = 2 * _deviceParticles;
+    double maxVelocityChange = 0.0;
+
+    #pragma omp target teams distribute parallel for device(_device) map(tofrom: maxVelocityChange) \
+        reduction(max: maxVelocityChange) is_device_ptr(positions, velocities, projectedPositions, lastPositions)
+    for (int k = 0; k < numberOfComponents; k++) {
+        positions[k] = projectedPositions[k];
+        const double velocity = (positions[k] - lastPositions[k]) / timeStepSize;
+        maxVelocityChange = std::max(maxVelocityChange, std::abs(velocity - velocities[k]));
+        velocities[k] = velocity;
+    }
+
+    _maxAcceleration = maxVelocityChange / _timeStepSizeInSeconds;
+}
+
+void DeviceVSphSolver2D::enforceBoundaryOnDevice() {
+    const double *positions = _positions.data();
+    double *velocities = _velocities.data();
+    const double particleRadius = _particleSystemData->getParticleRadius();
+    const double timeStepSize = _timeStepSizeInSeconds;
+    const double boundaryDumping = _boundaryDumping;
+    const int numberOfBoundaries = _boundaries.size();
+    const int numberOfParticles = _deviceParticles;
+    const double *boundaries = _boundaries.data()->data();
+
+    #pragma omp target teams distribute parallel for device(_device) \
+        map(to: boundaries[0:3 * numberOfBoundaries]) is_device_ptr(positions, velocities)
+    for (int i = 0; i < numberOfParticles; i++) {
+        for (int b = 0; b < numberOfBoundaries; b++) {
+            const double *boundary = &boundaries[3 * b];
+            double d = positions[2 * i] * boundary[0] + positions[2 * i + 1] * boundary[1] - boundary[2];
+            if ((d = std::max(0., d)) < particleRadius) {
+                velocities[2 * i] += (particleRadius - d) * boundary[0] / timeStepSize;
+                velocities[2 * i + 1] += (particleRadius - d) * boundary[1] / timeStepSize;
+                velocities[2 * i] *= boundaryDumping;
+                velocities[2 * i + 1] *= boundaryDumping;
+            }
+        }
+    }
+}
+
+double DeviceVSphSolver2D::computeMaxSpeedSquared() {
+    const double *velocities = _velocities.data();
+    const int numberOfParticles = _deviceParticles;
+    double maxSpeedSquared = 0.0;
+
+    #pragma omp target teams distribute parallel for device(_device) map(tofrom: maxSpeedSquared) \
+        reduction(max: maxSpeedSquared) is_device_ptr(velocities)
+    for (int i = 0; i < numberOfParticles; i++) {
+        const double speedSquared = velocities[2 * i] * velocities[2 * i] + velocities[2 * i + 1] * velocities[2 * i + 1];
+        maxSpeedSquared = std::max(maxSpeedSquared, speedSquared);
+    }
+
+    return maxSpeedSquared;
+}
\ No newline at end of file
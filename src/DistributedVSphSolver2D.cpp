@@ -0,0 +1,402 @@
+/**
+ * @file DistributedVSphSolver2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the domain decomposed Viscoelastic SPH solver for 2D systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/DistributedVSphSolver2D.h"
+
+#ifdef SPH_MPI
+
+#include "../include/ParticleNeighborhood2D.h"
+#include <algorithm>
+#include <limits>
+
+DistributedVSphSolver2D::DistributedVSphSolver2D(int numberOfParticles, MPI_Comm communicator) :
+    VSphSolver2D(numberOfParticles), _communicator(communicator) {
+    MPI_Comm_rank(_communicator, &_rank);
+    MPI_Comm_size(_communicator, &_numberOfRanks);
+
+    std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    std::vector<double>& globalIds = _particleSystemData->getAttributes().addScalarAttribute("globalIds");
+    _globalNumberOfParticles = _particleSystemData->numberOfParticles;
+
+    for (size_t i = 0; i < _globalNumberOfParticles; i++) {
+        globalIds[i] = i;
+    }
+
+    // Every rank starts from the whole block, so it keeps its share of equal slabs of the
+    // view, and the rebalance then evens out the counts.
+    for (int rank = 1; rank < _numberOfRanks; rank++) {
+        _slabCuts.push_back(rank * _viewWidth / _numberOfRanks);
+    }
+
+    std::vector<size_t> others = {};
+
+    for (size_t i = 0; i < _globalNumberOfParticles; i++) {
+        if (ownerOf(positions[i](0)) != _rank) {
+            others.push_back(i);
+        }
+    }
+
+    _particleSystemData->removeParticles(others);
+    rebalance();
+    _particleSystemData->getNeighborhood()->build(positions);
+}
+
+DistributedVSphSolver2D::~DistributedVSphSolver2D() {}
+
+void DistributedVSphSolver2D::update() {
+    if (_rebalanceInterval > 0 && _updatesSinceRebalance >= _rebalanceInterval) {
+        rebalance();
+    }
+
+    VSphSolver2D::update();
+    _updatesSinceRebalance++;
+}
+
+void DistributedVSphSolver2D::step(PhaseTimer& timer) {
+    ParticleNeighborhood2DPtr neighorhood = _particleSystemData->getNeighborhood();
+    auto& positions = _particleSystemData->getPositions();
+
+    applyExternalForces();
+    timer.lap(_stats.timings.forces);
+    integrate();
+    timer.lap(_stats.timings.integrate);
+    exchangeGhosts();
+    neighorhood->build(positions);
+    SPH_STATS(collectNeighborStats());
+    timer.lap(_stats.timings.neighborBuild);
+    _particleSystemData->computeDensityPressure();
+    SPH_STATS(collectDensityStats());
+    exchangeGhostPressures();
+    timer.lap(_stats.timings.densityPressure);
+    project();
+    timer.lap(_stats.timings.forces);
+    correct();
+    dropGhosts();
+    migrateParticles();
+    timer.lap(_stats.timings.integrate);
+    enforceBoundary();
+    timer.lap(_stats.timings.boundary);
+}
+
+double DistributedVSphSolver2D::computeTimeStepSize(double remainingTime) {
+    double timeStepSize = VSphSolver2D::computeTimeStepSize(remainingTime);
+
+    // Each rank splits the same remaining time evenly, so the smallest step is one of them.
+    MPI_Allreduce(MPI_IN_PLACE, &timeStepSize, 1, MPI_DOUBLE, MPI_MIN, _communicator);
+
+    return timeStepSize;
+}
+
+void DistributedVSphSolver2D::setRebalanceInterval(int rebalanceInterval) {
+    _rebalanceInterval = std::max(0, rebalanceInterval);
+}
+
+bool DistributedVSphSolver2D::setReorderInterval(int reorderInterval) {
+    return reorderInterval == 0 && VSphSolver2D::setReorderInterval(reorderInterval);
+}
+
+bool DistributedVSphSolver2D::addEmitter(ParticleEmitter2DPtr) {
+    return false;
+}
+
+bool DistributedVSphSolver2D::addSink(ParticleSink2DPtr) {
+    return false;
+}
+
+bool DistributedVSphSolver2D::setSymmetricPairs(bool symmetricPairs) {
+    return !symmetricPairs && VSphSolver2D::setSymmetricPairs(symmetricPairs);
+}
+
+void DistributedVSphSolver2D::rebalance() {
+    const std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    // The largest x is reduced negated, so both bounds take a single reduction.
+    double bounds[2] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        bounds[0] = std::min(bounds[0], positions[i](0));
+        bounds[1] = std::min(bounds[1], -positions[i](0));
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, bounds, 2, MPI_DOUBLE, MPI_MIN, _communicator);
+    _updatesSinceRebalance = 0;
+
+    if (bounds[0] > -bounds[1]) {
+        return;
+    }
+
+    const double minX = bounds[0];
+    const double binWidth = (-bounds[1] - minX) / REBALANCE_BINS;
+    std::vector<long> histogram(REBALANCE_BINS, 0);
+
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const int bin = binWidth > 0.0 ? (positions[i](0) - minX) / binWidth : 0;
+        histogram[std::min(bin, REBALANCE_BINS - 1)]++;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, histogram.data(), REBALANCE_BINS, MPI_LONG, MPI_SUM, _communicator);
+
+    long count = 0;
+    int bin = 0;
+
+    for (int rank = 1; rank < _numberOfRanks; rank++) {
+        const long target = rank * _globalNumberOfParticles / _numberOfRanks;
+
+        while (bin < REBALANCE_BINS && count < target) {
+            count += histogram[bin++];
+        }
+
+        _slabCuts[rank - 1] = minX + bin * binWidth;
+    }
+
+    migrateParticles();
+}
+
+int DistributedVSphSolver2D::ownerOf(double x) {
+    return std::upper_bound(_slabCuts.begin(), _slabCuts.end(), x) - _slabCuts.begin();
+}
+
+void DistributedVSphSolver2D::exchange(const std::vector<double>& sendValues,
+    const std::vector<int>& sendCounts, int valuesPerParticle, std::vector<double>& receiveValues,
+    std::vector<int>& receiveCounts) {
+    std::vector<int> sendSizes(_numberOfRanks), sendOffsets(_numberOfRanks);
+    std::vector<int> receiveSizes(_numberOfRanks), receiveOffsets(_numberOfRanks);
+    int sendTotal = 0;
+    int receiveTotal = 0;
+
+    receiveCounts.resize(_numberOfRanks);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, receiveCounts.data(), 1, MPI_INT, _communicator);
+
+    for (int rank = 0; rank < _numberOfRanks; rank++) {
+        sendSizes[rank] = sendCounts[rank] * valuesPerParticle;
+        sendOffsets[rank] = sendTotal;
+        sendTotal += sendSizes[rank];
+        receiveSizes[rank] = receiveCounts[rank] * valuesPerParticle;
+        receiveOffsets[rank] = receiveTotal;
+        receiveTotal += receiveSizes[rank];
+    }
+
+    receiveValues.resize(receiveTotal);
+    MPI_Alltoallv(sendValues.data(), sendSizes.data(), sendOffsets.data(), MPI_DOUBLE,
+        receiveValues.data(), receiveSizes.data(), receiveOffsets.data(), MPI_DOUBLE, _communicator);
+}
+
+void DistributedVSphSolver2D::exchangeGhosts() {
+    const std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    const std::vector<Eigen::Vector2d>& velocities = _particleSystemData->getVelocities();
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    std::vector<std::vector<int>> ghosts(_numberOfRanks);
+
+    // A particle is a neighbor of some particle of every slab within one kernel radius of it.
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const int first = ownerOf(positions[i](0) - kernelRadius);
+        const int last = ownerOf(positions[i](0) + kernelRadius);
+
+        for (int rank = first; rank <= last; rank++) {
+            if (rank != _rank) {
+                ghosts[rank].push_back(i);
+            }
+        }
+    }
+
+    std::vector<double> sendValues = {};
+    std::vector<double> receiveValues = {};
+    _ghostSendIndices.clear();
+    _ghostSendCounts.resize(_numberOfRanks);
+
+    for (int rank = 0; rank < _numberOfRanks; rank++) {
+        _ghostSendCounts[rank] = ghosts[rank].size();
+
+        for (int i : ghosts[rank]) {
+            _ghostSendIndices.push_back(i);
+            sendValues.insert(sendValues.end(), {positions[i](0), positions[i](1),
+                velocities[i](0), velocities[i](1)});
+        }
+    }
+
+    exchange(sendValues, _ghostSendCounts, 4, receiveValues, _ghostReceiveCounts);
+
+    _numberOfGhosts = receiveValues.size() / 4;
+    _particleSystemData->getAttributes().resize(numberOfParticles + _numberOfGhosts);
+
+    std::vector<Eigen::Vector2d>& ghostPositions = _particleSystemData->getPositions();
+    std::vector<Eigen::Vector2d>& ghostVelocities = _particleSystemData->getVelocities();
+
+    for (size_t k = 0; k < _numberOfGhosts; k++) {
+        ghostPositions[numberOfParticles + k] = Eigen::Vector2d(receiveValues[4 * k], receiveValues[4 * k + 1]);
+        ghostVelocities[numberOfParticles + k] = Eigen::Vector2d(receiveValues[4 * k + 2], receiveValues[4 * k + 3]);
+    }
+}
+
+void DistributedVSphSolver2D::exchangeGhostPressures() {
+    std::vector<double>& pressures = _particleSystemData->getPressures();
+    std::vector<double>& pressureVariations = _particleSystemData->getPressureVariations();
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    std::vector<double> sendValues = {};
+    std::vector<double> receiveValues = {};
+
+    sendValues.reserve(2 * _ghostSendIndices.size());
+
+    for (int i : _ghostSendIndices) {
+        sendValues.push_back(pressures[i]);
+        sendValues.push_back(pressureVariations[i]);
+    }
+
+    // The ghosts are sent in the order of the halo exchange, so they land on the same slots.
+    exchange(sendValues, _ghostSendCounts, 2, receiveValues, _ghostReceiveCounts);
+
+    for (size_t k = 0; k < _numberOfGhosts; k++) {
+        pressures[numberOfParticles + k] = receiveValues[2 * k];
+        pressureVariations[numberOfParticles + k] = receiveValues[2 * k + 1];
+    }
+}
+
+void DistributedVSphSolver2D::dropGhosts() {
+    _particleSystemData->getAttributes().resize(_particleSystemData->numberOfParticles);
+}
+
+void DistributedVSphSolver2D::migrateParticles() {
+    ParticleAttributes2D& attributes = _particleSystemData->getAttributes();
+    std::vector<std::vector<Eigen::Vector2d> *> vectorAttributes = {};
+    std::vector<std::vector<double> *> scalarAttributes = {};
+
+    for (const std::string& name : attributes.getVectorAttributeNames()) {
+        vectorAttributes.push_back(&attributes.getVectorAttribute(name));
+    }
+    for (const std::string& name : attributes.getScalarAttributeNames()) {
+        scalarAttributes.push_back(&attributes.getScalarAttribute(name));
+    }
+
+    const std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    const int valuesPerParticle = 2 * vectorAttributes.size() + scalarAttributes.size();
+    std::vector<std::vector<size_t>> leaving(_numberOfRanks);
+
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const int owner = ownerOf(positions[i](0));
+
+        if (owner != _rank) {
+            leaving[owner].push_back(i);
+        }
+    }
+
+    std::vector<double> sendValues = {};
+    std::vector<double> receiveValues = {};
+    std::vector<int> sendCounts(_numberOfRanks);
+    std::vector<int> receiveCounts = {};
+    std::vector<size_t> leavingIndices = {};
+
+    for (int rank = 0; rank < _numberOfRanks; rank++) {
+        sendCounts[rank] = leaving[rank].size();
+
+        for (size_t i : leaving[rank]) {
+            for (std::vector<Eigen::Vector2d> *values : vectorAttributes) {
+                sendValues.push_back((*values)[i](0));
+                sendValues.push_back((*values)[i](1));
+            }
+            for (std::vector<double> *values : scalarAttributes) {
+                sendValues.push_back((*values)[i]);
+            }
+            leavingIndices.push_back(i);
+        }
+    }
+
+    exchange(sendValues, sendCounts, valuesPerParticle, receiveValues, receiveCounts);
+    _particleSystemData->removeParticles(leavingIndices);
+
+    for (size_t offset = 0; offset < receiveValues.size(); offset += valuesPerParticle) {
+        const double *values = &receiveValues[offset];
+        _particleSystemData->addParticle(Eigen::Vector2d(0.0, 0.0));
+        const size_t index = _particleSystemData->numberOfParticles - 1;
+
+        for (std::vector<Eigen::Vector2d> *attribute : vectorAttributes) {
+            (*attribute)[index] = Eigen::Vector2d(values[0], values[1]);
+            values += 2;
+        }
+        for (std::vector<double> *attribute : scalarAttributes) {
+            (*attribute)[index] = *values++;
+        }
+    }
+}
+
+bool DistributedVSphSolver2D::gatherPositions(std::vector<Eigen::Vector2d>& positions, int root) {
+    const std::vector<Eigen::Vector2d>& localPositions = _particleSystemData->getPositions();
+    const std::vector<double>& globalIds = _particleSystemData->getAttributes().getScalarAttribute("globalIds");
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const int size = 3 * numberOfParticles;
+    std::vector<double> sendValues = {};
+    std::vector<double> receiveValues = {};
+    std::vector<int> receiveSizes(_numberOfRanks), receiveOffsets(_numberOfRanks);
+
+    sendValues.reserve(size);
+
+    for (int i = 0; i < numberOfParticles; i++) {
+        sendValues.insert(sendValues.end(), {globalIds[i], localPositions[i](0), localPositions[i](1)});
+    }
+
+    MPI_Gather(&size, 1, MPI_INT, receiveSizes.data(), 1, MPI_INT, root, _communicator);
+
+    if (_rank == root) {
+        int receiveTotal = 0;
+
+        for (int rank = 0; rank < _numberOfRanks; rank++) {
+            receiveOffsets[rank] = receiveTotal;
+            receiveTotal += receiveSizes[rank];
+        }
+
+        receiveValues.resize(receiveTotal);
+    }
+
+    MPI_Gatherv(sendValues.data(), size, MPI_DOUBLE, receiveValues.data(), receiveSizes.data(),
+        receiveOffsets.data(), MPI_DOUBLE, root, _communicator);
+
+    if (_rank != root) {
+        return false;
+    }
+
+    positions.resize(_globalNumberOfParticles);
+
+    for (size_t k = 0; k < receiveValues.size(); k += 3) {
+        positions[(size_t) receiveValues[k]] = Eigen::Vector2d(receiveValues[k + 1], receiveValues[k + 2]);
+    }
+
+    return true;
+}
+
+int DistributedVSphSolver2D::getRank() {
+    return _rank;
+}
+
+int DistributedVSphSolver2D::getNumberOfRanks() {
+    return _numberOfRanks;
+}
+
+size_t DistributedVSphSolver2D::getNumberOfOwnedParticles() {
+    return _particleSystemData->numberOfParticles;
+}
+
+size_t DistributedVSphSolver2D::getNumberOfGhosts() {
+    return _numberOfGhosts;
+}
+
+size_t DistributedVSphSolver2D::getGlobalNumberOfParticles() {
+    return _globalNumberOfParticles;
+}
+
+Eigen::Vector2d DistributedVSphSolver2D::getSlab(int rank) {
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    return Eigen::Vector2d(rank > 0 ? _slabCuts[rank - 1] : -infinity,
+        rank < _numberOfRanks - 1 ? _slabCuts[rank] : infinity);
+}
+
+#endif
\ No newline at end of file
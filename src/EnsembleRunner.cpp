@@ -0,0 +1,105 @@
+/**
+ * @file EnsembleRunner.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the runner of ensembles of independent Viscoelastic SPH simulations.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/EnsembleRunner.h"
+#include "../include/VSphParticleSystemData2D.h"
+#include <algorithm>
+#include <omp.h>
+
+EnsembleRunner::EnsembleRunner(int numberOfWorkers) : _scheduler(numberOfWorkers) { }
+
+EnsembleRunner::~EnsembleRunner() { }
+
+int EnsembleRunner::addMember(const EnsembleMember& member) {
+    _members.push_back(member);
+    _results.emplace_back();
+    return _members.size() - 1;
+}
+
+bool EnsembleRunner::setOutputSettings(const OutputSettings& outputSettings) {
+    VSphParticleSystemData2D particleSystemData;
+    const ParticleAttributes2D& attributes = particleSystemData.getAttributes();
+
+    for (const std::string& name: outputSettings.fields) {
+        if (!attributes.hasScalarAttribute(name) && !attributes.hasVectorAttribute(name)) {
+            return false;
+        }
+    }
+
+    _outputSettings = outputSettings;
+    return true;
+}
+
+void EnsembleRunner::setThreadsPerMember(int threadsPerMember) {
+    _threadsPerMember = std::max(1, threadsPerMember);
+}
+
+void EnsembleRunner::run() {
+    std::vector<int> pending;
+    for (int member = 0; member < getNumberOfMembers(); member++) {
+        if (!_results[member].finished) {
+            pending.push_back(member);
+        }
+    }
+
+    // The most expensive simulations are dealt first, so they start first on every worker
+    std::stable_sort(pending.begin(), pending.end(), [&](int a, int b) {
+        return (double) _members[a].numberOfParticles * _members[a].numberOfUpdates >
+            (double) _members[b].numberOfParticles * _members[b].numberOfUpdates;
+    });
+
+    _scheduler.run(pending.size(), [&](size_t task, int) {
+        runMember(pending[task]);
+    });
+}
+
+int EnsembleRunner::getNumberOfMembers() {
+    return _members.size();
+}
+
+int EnsembleRunner::getNumberOfWorkers() {
+    return _scheduler.getNumberOfWorkers();
+}
+
+const EnsembleResult& EnsembleRunner::getResult(int member) {
+    return _results[member];
+}
+
+size_t EnsembleRunner::getSteals() {
+    return _scheduler.getSteals();
+}
+
+void EnsembleRunner::runMember(int member) {
+    const EnsembleMember& settings = _members[member];
+
+    // The workers are new threads, so this only sets the threads of this simulation
+    omp_set_num_threads(_threadsPerMember);
+
+    VSphSolver2DPtr solver = std::make_shared<VSphSolver2D>(settings.numberOfParticles, settings.fileName);
+    SphParticleSystemData2DPtr data = solver->getParticleSystemData();
+    data->setStiffness(settings.stiffness);
+    data->setStiffnessAtProximity(settings.stiffnessAtProximity);
+    data->setLinearViscosity(settings.linearViscosity);
+    data->setQuadraticViscosity(settings.quadraticViscosity);
+    data->setSurfaceTension(settings.surfaceTension);
+    solver->setTimeStepSettings(settings.timeStepSettings);
+    solver->setOutputFormat(OutputFormat::Binary);
+    solver->setOutputSettings(_outputSettings);
+
+    for (int update = 0; update < settings.numberOfUpdates; update++) {
+        solver->update();
+    }
+
+    // Only the result is kept, so the solver is released when this worker moves on
+    solver->closeOutput();
+    _results[member].positions = solver->getPositions();
+    _results[member].finished = true;
+}
\ No newline at end of file
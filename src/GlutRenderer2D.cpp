@@ -1,4 +1,240 @@
+/**
+ * @file GlutRenderer2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the Glut Renderer for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#define GL_GLEXT_PROTOTYPES
+
 #include "../include/GlutRenderer2D.h"
+#include "../include/FrameTripleBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The settings of the renderer.
+ * 
+ */
+static RenderSettings renderSettings;
+
+/**
+ * @brief Slots of the frames written by the solver and drawn by the renderer.
+ * 
+ */
+static FrameTripleBuffer frames;
+
+/**
+ * @brief Number of vertices of each frame slot.
+ * 
+ */
+static size_t frameCapacity = 0;
+
+/**
+ * @brief Number of vertices written to each frame slot.
+ * 
+ */
+static size_t frameVertices[3] = {0, 0, 0};
+
+/**
+ * @brief Fence of the last draw of each frame slot, used with the persistent mapping.
+ * 
+ */
+static GLsync frameFences[3] = {0, 0, 0};
+
+/**
+ * @brief The vertex buffer with the frames.
+ * 
+ */
+static GLuint vertexBuffer = 0;
+
+/**
+ * @brief The persistently mapped vertex buffer, with the three frame slots one after the
+ * other, or nullptr if the frames are written to hostVertices.
+ * 
+ */
+static float *mappedVertices = nullptr;
+
+/**
+ * @brief The three frame slots on the host, uploaded to the vertex buffer when drawn if it
+ * can not be persistently mapped.
+ * 
+ */
+static std::vector<float> hostVertices;
+
+/**
+ * @brief The thread that updates the solver, if solverThread is set.
+ * 
+ */
+static std::thread solverThread;
+
+/**
+ * @brief If true, the solver thread keeps updating the solver.
+ * 
+ */
+static std::atomic<bool> solverRunning{false};
+
+/**
+ * @brief Get the vertices of a frame slot.
+ * 
+ * @param slot: The frame slot.
+ * @return float* pointing to the first vertex of the slot.
+ */
+static float* getFrame(int slot) {
+    float *vertices = mappedVertices != nullptr ? mappedVertices : hostVertices.data();
+    return vertices + slot * frameCapacity * FLOATS_PER_VERTEX;
+}
+
+/**
+ * @brief Writes the current particles to the write slot and publishes it to the renderer.
+ * 
+ */
+static void produceFrame() {
+    int slot = frames.getWriteSlot();
+    frameVertices[slot] = writeFrame(*solver, renderSettings.colorMode, getFrame(slot), frameCapacity);
+    frames.publish();
+}
+
+/**
+ * @brief Updates the solver and produces its frames until solverRunning is cleared.
+ * 
+ */
+static void runSolver() {
+    while (solverRunning.load(std::memory_order_relaxed)) {
+        solver->update();
+        produceFrame();
+    }
+}
+
+/**
+ * @brief Stops the solver thread, if it runs. Registered with atexit, since glut exits the
+ * process when the window is closed.
+ * 
+ */
+static void stopSolver() {
+    solverRunning = false;
+
+    if (solverThread.joinable()) {
+        solverThread.join();
+    }
+}
+
+/**
+ * @brief Checks if the OpenGL context supports persistently mapped buffers.
+ * 
+ * @return true if the context is OpenGL 4.4 or has GL_ARB_buffer_storage.
+ * @return false otherwise.
+ */
+static bool supportsBufferStorage() {
+    int major = 0, minor = 0;
+    const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+
+    if (version != nullptr && std::sscanf(version, "%d.%d", &major, &minor) == 2 &&
+        (major > 4 || (major == 4 && minor >= 4))) {
+        return true;
+    }
+
+    return glutExtensionSupported("GL_ARB_buffer_storage");
+}
+
+/**
+ * @brief Creates the vertex buffer, writes the first frame and starts the solver thread if
+ * requested.
+ * 
+ */
+static void initVertexBuffer() {
+    frameCapacity = renderSettings.maxParticles > 0 ? renderSettings.maxParticles :
+        solver->getPositions().size();
+    GLsizeiptr bufferSize = 3 * frameCapacity * FLOATS_PER_VERTEX * sizeof(float);
+
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+
+    if (supportsBufferStorage()) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bufferSize, nullptr, flags);
+        mappedVertices = static_cast<float *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, flags));
+    }
+
+    if (mappedVertices == nullptr) {
+        hostVertices.resize(3 * frameCapacity * FLOATS_PER_VERTEX);
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    produceFrame();
+
+    if (renderSettings.solverThread) {
+        solverRunning = true;
+        solverThread = std::thread(runSolver);
+        std::atexit(stopSolver);
+    }
+}
+
+/**
+ * @brief Draws the latest frame from the vertex buffer.
+ * 
+ */
+static void renderVertexBuffer() {
+    int slot = frames.getReadSlot();
+
+    if (frames.isFresh()) {
+        // The slot goes back to the solver, so the previous draw from it must be done
+        if (frameFences[slot] != 0) {
+            glClientWaitSync(frameFences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(frameFences[slot]);
+            frameFences[slot] = 0;
+        }
+
+        frames.acquire();
+        slot = frames.getReadSlot();
+    }
+
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+    size_t offset = 0;
+
+    if (mappedVertices != nullptr) {
+        offset = slot * frameCapacity * stride;
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, frameVertices[slot] * stride, getFrame(slot), GL_STREAM_DRAW);
+    }
+
+    glVertexPointer(2, GL_FLOAT, stride, reinterpret_cast<void *>(offset));
+    glColorPointer(3, GL_FLOAT, stride, reinterpret_cast<void *>(offset + 2 * sizeof(float)));
+    glDrawArrays(GL_POINTS, 0, frameVertices[slot]);
+
+    if (mappedVertices != nullptr) {
+        if (frameFences[slot] != 0) {
+            glDeleteSync(frameFences[slot]);
+        }
+
+        frameFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+/**
+ * @brief Writes the color of a value between 0 and 1, from blue to red.
+ * 
+ * @param value: The value, clamped to between 0 and 1.
+ * @param color: Receives the red, green and blue components.
+ */
+static void writeColor(double value, float *color) {
+    float t = std::clamp(value, 0., 1.);
+
+    color[0] = 0.2f + t * 0.8f;
+    color[1] = 0.6f - t * 0.4f;
+    color[2] = 1.f - t * 0.9f;
+}
 
 void loop(int argc, char **argv) {
     glutInitWindowSize(solver->getWindowWidth(), solver->getWindowHeight());
@@ -19,10 +255,16 @@ void render() {
 	glLoadIdentity();
 	glOrtho(0, solver->getViewWidth(), 0, solver->getViewHeight(), 0, 1);
 
+	if (renderSettings.vertexBuffer) {
+		renderVertexBuffer();
+		glutSwapBuffers();
+		return;
+	}
+
 	glColor4f(0.2f, 0.6f, 1.f, 1);
 	glBegin(GL_POINTS);
 
-	std::vector<Eigen::Vector2d> positions = solver->getPositions();
+	const std::vector<Eigen::Vector2d>& positions = solver->getPositions();
 
 	for (auto &p : positions) {
 		glVertex2f(p(0), p(1));
@@ -34,8 +276,23 @@ void render() {
 }
 
 void update() {
+	if (renderSettings.vertexBuffer && renderSettings.solverThread) {
+		// The solver thread updates, so only redraw once it published a new frame
+		if (frames.isFresh()) {
+			glutPostRedisplay();
+		} else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return;
+	}
+
 	solver->update();
-	glutPostRedisplay(); 
+
+	if (renderSettings.vertexBuffer) {
+		produceFrame();
+	}
+
+	glutPostRedisplay();
 }
 
 void initGL() {
@@ -43,8 +300,63 @@ void initGL() {
 	glEnable(GL_POINT_SMOOTH);
     glPointSize(solver->getPointSize());
 	glMatrixMode(GL_PROJECTION);
+
+	if (renderSettings.vertexBuffer) {
+		initVertexBuffer();
+	}
 }
 
 void setSolver(SphSolver2DPtr solver_) {
     solver = solver_;
 }
+
+void setRenderSettings(RenderSettings settings) {
+    renderSettings = settings;
+}
+
+size_t writeFrame(SphSolver2D& sphSolver, ColorMode colorMode, float *vertices, size_t capacity) {
+    if (colorMode == ColorMode::Uniform) {
+        const std::vector<Eigen::Vector2d>& positions = sphSolver.getPositions();
+        size_t numberOfVertices = std::min(positions.size(), capacity);
+
+        #pragma omp parallel for
+        for (size_t i = 0; i < numberOfVertices; i++) {
+            float *vertex = vertices + i * FLOATS_PER_VERTEX;
+            vertex[0] = positions[i](0);
+            vertex[1] = positions[i](1);
+            writeColor(0., vertex + 2);
+        }
+
+        return numberOfVertices;
+    }
+
+    // The order of the vertices does not matter, so the particles are read in storage order
+    SphParticleSystemData2DPtr data = sphSolver.getParticleSystemData();
+    const std::vector<Eigen::Vector2d>& positions = data->getPositions();
+    const std::vector<Eigen::Vector2d>& velocities = data->getVelocities();
+    const std::vector<double>& densities = data->getDensities();
+    size_t numberOfVertices = std::min(data->numberOfParticles, capacity);
+    double scale = 1. / (2. * data->getRestDensity());
+
+    if (colorMode == ColorMode::Velocity) {
+        double maxSpeed = 0.;
+
+        #pragma omp parallel for reduction(max: maxSpeed)
+        for (size_t i = 0; i < numberOfVertices; i++) {
+            maxSpeed = std::max(maxSpeed, velocities[i].norm());
+        }
+
+        scale = maxSpeed > 0. ? 1. / maxSpeed : 0.;
+    }
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numberOfVertices; i++) {
+        float *vertex = vertices + i * FLOATS_PER_VERTEX;
+        double value = colorMode == ColorMode::Velocity ? velocities[i].norm() : densities[i];
+        vertex[0] = positions[i](0);
+        vertex[1] = positions[i](1);
+        writeColor(value * scale, vertex + 2);
+    }
+
+    return numberOfVertices;
+}
\ No newline at end of file
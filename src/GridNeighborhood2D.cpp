@@ -11,25 +11,12 @@
 
 #include "../include/GridNeighborhood2D.h"
 #include "../include/Constants.h"
+#include "../include/SolverStats.h"
 
-GridNeighborhood2D::GridNeighborhood2D() : ParticleNeighborhood2D() {
-    _sortedNeighbors = {};
-	_neighborhoods = {};
+GridNeighborhood2D::GridNeighborhood2D() : ParticleNeighborhood2D() { }
 
-	for (int i = 0; i < MAX_PARTICLES2D; i++) {
-		_sortedNeighbors.push_back(Neighbor(i));
-		_neighborhoods.push_back(Neighborhood());
-	}	
-}   
-
-GridNeighborhood2D::GridNeighborhood2D(const int numberOfpoints) : ParticleNeighborhood2D() {
-    _sortedNeighbors = {};
-	_neighborhoods = {};
-
-	for (int i = 0; i < numberOfpoints; i++) {
-		_sortedNeighbors.push_back(Neighbor(i));
-		_neighborhoods.push_back(Neighborhood());
-	}	
+GridNeighborhood2D::GridNeighborhood2D(const int numberOfPoints) : ParticleNeighborhood2D() {
+	reserve(numberOfPoints);
 }
 
 GridNeighborhood2D::~GridNeighborhood2D() { }
@@ -40,30 +27,52 @@ void GridNeighborhood2D::setGridResolution(int width, int height, double kernelR
     _height = (int) height / _cellSize;
     _numCells = _width * _height;
     _grid = std::vector<Neighbor *>(_numCells, nullptr);
-    _gridIndices = std::vector<Eigen::Vector2i>(MAX_PARTICLES2D, Eigen::Vector2i(0, 0));
+}
+
+void GridNeighborhood2D::reserve(int numberOfPoints) {
+	_sortedNeighbors.reserve(numberOfPoints);
+	_gridIndices.reserve(numberOfPoints);
+	_numNeighbors.reserve(numberOfPoints);
+	_neighbors.reserve((size_t) numberOfPoints * _maxNeighbors);
+	_distances.reserve((size_t) numberOfPoints * _maxNeighbors);
+}
+
+void GridNeighborhood2D::resize(int numberOfPoints) {
+	// Each list node keeps the index of its particle, so only the new nodes are created.
+	for (int i = _sortedNeighbors.size(); i < numberOfPoints; i++) {
+		_sortedNeighbors.push_back(Neighbor(i));
+	}
+
+	_gridIndices.resize(numberOfPoints);
+	_numNeighbors.resize(numberOfPoints);
+	_neighbors.resize((size_t) numberOfPoints * _maxNeighbors);
+	_distances.resize((size_t) numberOfPoints * _maxNeighbors);
 }
 
 void GridNeighborhood2D::forEachNearbyPoint( const int origin,
     const ForEachNearbyPointFunc& callback) const {
+    const int *neighbors = &_neighbors[(size_t) origin * _maxNeighbors];
+    const double *distances = &_distances[(size_t) origin * _maxNeighbors];
 
-	#ifndef TEST
-		#pragma omp parallel for
-	#endif
-    for (int i = 0; i < _neighborhoods[origin].numNeighbors; i++) {
-        callback(_neighborhoods[origin].neighbors[i]->index, _neighborhoods[origin].distances[i]);
+    for (int i = 0; i < _numNeighbors[origin]; i++) {
+        callback(neighbors[i], distances[i]);
     }
 }
 
+NeighborList2D GridNeighborhood2D::getNeighbors(const int origin) const {
+    return NeighborList2D{&_neighbors[(size_t) origin * _maxNeighbors],
+        &_distances[(size_t) origin * _maxNeighbors], _numNeighbors[origin]};
+}
+
 void GridNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
-	#ifndef TEST
-		#pragma omp parallel for
-	#endif
+	resize(points.size());
+
+	#pragma omp parallel for
 	for (auto &elem : _grid)
 		elem = nullptr;
 	
-	#ifndef TEST
-		#pragma omp parallel for
-	#endif
+	// Every particle is pushed onto the head of a list shared by its whole cell, so this
+	// loop stays serial. It is linear in the number of particles.
 	for (int i = 0; i < points.size(); i++) {
 		auto p = points[i];
         auto& n = _sortedNeighbors[i];
@@ -76,15 +85,19 @@ void GridNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
 		_gridIndices[i] = Eigen::Vector2i(xind, yind);
 	}
 
-	#ifndef TEST
-		#pragma omp parallel for
-	#endif
+	size_t truncatedCount = 0;
+
+	#pragma omp parallel for schedule(runtime) reduction(+: truncatedCount)
     for (int i = 0; i < points.size(); i++)
 	{
+		SPH_STATS(bool truncated = false);
+
 		auto &pi = points[i];
 
 		Eigen::Vector2i gridIndex = Eigen::Vector2i(_gridIndices[i](0), _gridIndices[i](1) * _width);
-		_neighborhoods[i].numNeighbors = 0;
+		int *neighbors = &_neighbors[(size_t) i * _maxNeighbors];
+		double *distances = &_distances[(size_t) i * _maxNeighbors];
+		int numNeighbors = 0;
 
 		double dens = 0.0f;
 		double dens_proj = 0.0f;
@@ -92,6 +105,9 @@ void GridNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
 			for (int jj = gridIndex(1) - _width; jj <= gridIndex(1) + _width; jj += _width) {
 				for (Neighbor *pgrid = _grid[ii + jj]; pgrid != NULL; pgrid = pgrid->next)
 				{
+					if (_halfNeighborList && pgrid->index <= i)
+						continue;
+
 					const Eigen::Vector2d &pj = points[pgrid->index];
 					Eigen::Vector2d dx = pj - pi;
 					double r2 = dx.squaredNorm();
@@ -99,18 +115,64 @@ void GridNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
 						continue;
 
                     double r = sqrt(r2);
-					if (_neighborhoods[i].numNeighbors < Neighborhood::MAX_NEIGHBORS)
+					if (numNeighbors < _maxNeighbors)
 					{
-						_neighborhoods[i].neighbors[_neighborhoods[i].numNeighbors] = pgrid;
-						_neighborhoods[i].distances[_neighborhoods[i].numNeighbors] = r;
-						++_neighborhoods[i].numNeighbors;
+						neighbors[numNeighbors] = pgrid->index;
+						distances[numNeighbors] = r;
+						++numNeighbors;
+					}
+					else
+					{
+						SPH_STATS(truncated = true);
 					}
 				}
             }
         }
+
+		_numNeighbors[i] = numNeighbors;
+		SPH_STATS(truncatedCount += truncated);
+
+		if (_sortByIndex) {
+			sortNeighborhood(i);
+		}
 	}
+
+	_truncatedCount = truncatedCount;
+}
+
+void GridNeighborhood2D::sortNeighborhood(int index) {
+	int *neighbors = &_neighbors[(size_t) index * _maxNeighbors];
+	double *distances = &_distances[(size_t) index * _maxNeighbors];
+
+	for (int k = 1; k < _numNeighbors[index]; k++) {
+		int neighbor = neighbors[k];
+		double distance = distances[k];
+		int l = k - 1;
+
+		while (l >= 0 && neighbors[l] > neighbor) {
+			neighbors[l + 1] = neighbors[l];
+			distances[l + 1] = distances[l];
+			l--;
+		}
+
+		neighbors[l + 1] = neighbor;
+		distances[l + 1] = distance;
+	}
+}
+
+void GridNeighborhood2D::setSortByIndex(bool sortByIndex) {
+	_sortByIndex = sortByIndex;
+}
+
+void GridNeighborhood2D::setHalfNeighborList(bool halfNeighborList) {
+	_halfNeighborList = halfNeighborList;
+}
+
+bool GridNeighborhood2D::isHalfNeighborList() const {
+	return _halfNeighborList;
 }
 
 std::vector<double> GridNeighborhood2D::getDistances(int index) {
-    return _neighborhoods[index].distances;
+    const double *distances = &_distances[(size_t) index * _maxNeighbors];
+    return std::vector<double>(distances, distances + _numNeighbors[index]);
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+/**
+ * @file HashNeighborhood2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the spatial hash Neighborhood for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/HashNeighborhood2D.h"
+#include "../include/Constants.h"
+#include "../include/SolverStats.h"
+#include <algorithm>
+#include <cmath>
+
+HashNeighborhood2D::HashNeighborhood2D() : ParticleNeighborhood2D() { }
+
+HashNeighborhood2D::~HashNeighborhood2D() { }
+
+void HashNeighborhood2D::setGridResolution(int, int, double kernelRadius) {
+    _cellSize = kernelRadius;
+}
+
+void HashNeighborhood2D::forEachNearbyPoint(const int origin,
+    const ForEachNearbyPointFunc& callback) const {
+    const int *neighbors = &_neighbors[(size_t) origin * _maxNeighbors];
+    const double *distances = &_distances[(size_t) origin * _maxNeighbors];
+
+    for (int k = 0; k < _numNeighbors[origin]; k++) {
+        callback(neighbors[k], distances[k]);
+    }
+}
+
+NeighborList2D HashNeighborhood2D::getNeighbors(const int origin) const {
+    return NeighborList2D{&_neighbors[(size_t) origin * _maxNeighbors],
+        &_distances[(size_t) origin * _maxNeighbors], _numNeighbors[origin]};
+}
+
+Eigen::Vector2i HashNeighborhood2D::cellOf(const Eigen::Vector2d& point) const {
+    const double limit = MAX_CELL_COORDINATE;
+    Eigen::Vector2i cell;
+
+    for (int d = 0; d < 2; d++) {
+        cell(d) = std::max(-limit, std::min(limit, std::floor(point(d) / _cellSize)));
+    }
+
+    return cell;
+}
+
+int HashNeighborhood2D::bucketOf(const Eigen::Vector2i& cell) const {
+    // Large primes of Teschner et al., spreading neighboring cells over the table.
+    const uint32_t hash = ((uint32_t) cell(0) * 73856093u) ^ ((uint32_t) cell(1) * 19349663u);
+    return hash & _bucketMask;
+}
+
+void HashNeighborhood2D::sortIntoBuckets(const std::vector<Eigen::Vector2d>& points) {
+    const int numberOfPoints = points.size();
+    size_t numberOfBuckets = 16;
+
+    while (numberOfBuckets < 2 * (size_t) numberOfPoints) {
+        numberOfBuckets *= 2;
+    }
+
+    _bucketMask = numberOfBuckets - 1;
+    _particleCells.resize(numberOfPoints);
+    _particleBuckets.resize(numberOfPoints);
+    _bucketParticles.resize(numberOfPoints);
+    _bucketStart.assign(numberOfBuckets + 1, 0);
+
+    #pragma omp parallel for
+    for (int i = 0; i < numberOfPoints; i++) {
+        _particleCells[i] = cellOf(points[i]);
+        _particleBuckets[i] = bucketOf(_particleCells[i]);
+    }
+
+    // The counting sort is linear in the number of particles, so it stays serial, which also
+    // keeps each bucket in increasing index order.
+    for (int i = 0; i < numberOfPoints; i++) {
+        _bucketStart[_particleBuckets[i] + 1]++;
+    }
+
+    for (size_t bucket = 0; bucket < numberOfBuckets; bucket++) {
+        _bucketStart[bucket + 1] += _bucketStart[bucket];
+    }
+
+    _bucketOffsets.assign(_bucketStart.begin(), _bucketStart.end() - 1);
+
+    for (int i = 0; i < numberOfPoints; i++) {
+        _bucketParticles[_bucketOffsets[_particleBuckets[i]]++] = i;
+    }
+}
+
+void HashNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
+    const int numberOfPoints = points.size();
+
+    sortIntoBuckets(points);
+
+    _numNeighbors.resize(numberOfPoints);
+    _neighbors.resize((size_t) numberOfPoints * _maxNeighbors);
+    _distances.resize((size_t) numberOfPoints * _maxNeighbors);
+
+    size_t truncatedCount = 0;
+
+    #pragma omp parallel for schedule(runtime) reduction(+: truncatedCount)
+    for (int i = 0; i < numberOfPoints; i++) {
+        const Eigen::Vector2d &pi = points[i];
+        SPH_STATS(bool truncated = false);
+        int *neighbors = &_neighbors[(size_t) i * _maxNeighbors];
+        double *distances = &_distances[(size_t) i * _maxNeighbors];
+        int numNeighbors = 0;
+
+        for (int ii = -1; ii <= 1; ii++) {
+            for (int jj = -1; jj <= 1; jj++) {
+                const Eigen::Vector2i cell = _particleCells[i] + Eigen::Vector2i(ii, jj);
+                const int bucket = bucketOf(cell);
+
+                for (int k = _bucketStart[bucket]; k < _bucketStart[bucket + 1]; k++) {
+                    int j = _bucketParticles[k];
+                    if ((_halfNeighborList && j <= i) || _particleCells[j] != cell)
+                        continue;
+
+                    Eigen::Vector2d dx = points[j] - pi;
+                    double r2 = dx.squaredNorm();
+                    if (r2 < EPS || r2 > _cellSize * _cellSize)
+                        continue;
+
+                    if (numNeighbors < _maxNeighbors) {
+                        neighbors[numNeighbors] = j;
+                        distances[numNeighbors] = sqrt(r2);
+                        ++numNeighbors;
+                    } else {
+                        SPH_STATS(truncated = true);
+                    }
+                }
+            }
+        }
+
+        _numNeighbors[i] = numNeighbors;
+        SPH_STATS(truncatedCount += truncated);
+
+        if (_sortByIndex) {
+            sortNeighborhood(i);
+        }
+    }
+
+    _truncatedCount = truncatedCount;
+}
+
+void HashNeighborhood2D::sortNeighborhood(int index) {
+    int *neighbors = &_neighbors[(size_t) index * _maxNeighbors];
+    double *distances = &_distances[(size_t) index * _maxNeighbors];
+
+    for (int k = 1; k < _numNeighbors[index]; k++) {
+        int neighbor = neighbors[k];
+        double distance = distances[k];
+        int l = k - 1;
+
+        while (l >= 0 && neighbors[l] > neighbor) {
+            neighbors[l + 1] = neighbors[l];
+            distances[l + 1] = distances[l];
+            l--;
+        }
+
+        neighbors[l + 1] = neighbor;
+        distances[l + 1] = distance;
+    }
+}
+
+void HashNeighborhood2D::setSortByIndex(bool sortByIndex) {
+    _sortByIndex = sortByIndex;
+}
+
+void HashNeighborhood2D::setHalfNeighborList(bool halfNeighborList) {
+    _halfNeighborList = halfNeighborList;
+}
+
+bool HashNeighborhood2D::isHalfNeighborList() const {
+    return _halfNeighborList;
+}
+
+size_t HashNeighborhood2D::getNumberOfBuckets() const {
+    return _bucketStart.empty() ? 0 : _bucketStart.size() - 1;
+}
+
+std::vector<double> HashNeighborhood2D::getDistances(int index) {
+    const double *distances = &_distances[(size_t) index * _maxNeighbors];
+    return std::vector<double>(distances, distances + _numNeighbors[index]);
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * @file ParticleAttributes.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the registry of named per-particle attributes for 2D and 3D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/ParticleAttributes.h"
+
+template <int Dimension>
+ParticleAttributesT<Dimension>::ParticleAttributesT() {}
+
+template <int Dimension>
+ParticleAttributesT<Dimension>::~ParticleAttributesT() {}
+
+template <int Dimension>
+size_t ParticleAttributesT<Dimension>::size() const {
+    return _size;
+}
+
+template <int Dimension>
+std::vector<double>& ParticleAttributesT<Dimension>::addScalarAttribute(const std::string& name, double defaultValue) {
+    auto it = _scalarAttributes.find(name);
+
+    if (it == _scalarAttributes.end()) {
+        it = _scalarAttributes.emplace(name, ScalarAttribute{std::vector<double>(_size, defaultValue), defaultValue}).first;
+    }
+
+    return it->second.values;
+}
+
+template <int Dimension>
+std::vector<typename ParticleAttributesT<Dimension>::Vector>& ParticleAttributesT<Dimension>::addVectorAttribute(const std::string& name,
+    const Vector& defaultValue) {
+    auto it = _vectorAttributes.find(name);
+
+    if (it == _vectorAttributes.end()) {
+        it = _vectorAttributes.emplace(name, VectorAttribute{std::vector<Vector>(_size, defaultValue), defaultValue}).first;
+    }
+
+    return it->second.values;
+}
+
+template <int Dimension>
+bool ParticleAttributesT<Dimension>::hasScalarAttribute(const std::string& name) const {
+    return _scalarAttributes.count(name) > 0;
+}
+
+template <int Dimension>
+bool ParticleAttributesT<Dimension>::hasVectorAttribute(const std::string& name) const {
+    return _vectorAttributes.count(name) > 0;
+}
+
+template <int Dimension>
+std::vector<double>& ParticleAttributesT<Dimension>::getScalarAttribute(const std::string& name) {
+    return _scalarAttributes.at(name).values;
+}
+
+template <int Dimension>
+std::vector<typename ParticleAttributesT<Dimension>::Vector>& ParticleAttributesT<Dimension>::getVectorAttribute(const std::string& name) {
+    return _vectorAttributes.at(name).values;
+}
+
+template <int Dimension>
+std::vector<std::string> ParticleAttributesT<Dimension>::getScalarAttributeNames() const {
+    std::vector<std::string> names = {};
+
+    for (auto& attribute : _scalarAttributes) {
+        names.push_back(attribute.first);
+    }
+
+    return names;
+}
+
+template <int Dimension>
+std::vector<std::string> ParticleAttributesT<Dimension>::getVectorAttributeNames() const {
+    std::vector<std::string> names = {};
+
+    for (auto& attribute : _vectorAttributes) {
+        names.push_back(attribute.first);
+    }
+
+    return names;
+}
+
+template <int Dimension>
+void ParticleAttributesT<Dimension>::addParticle() {
+    for (auto& attribute : _scalarAttributes) {
+        attribute.second.values.push_back(attribute.second.defaultValue);
+    }
+
+    for (auto& attribute : _vectorAttributes) {
+        attribute.second.values.push_back(attribute.second.defaultValue);
+    }
+
+    _size++;
+}
+
+template <int Dimension>
+void ParticleAttributesT<Dimension>::resize(size_t size) {
+    for (auto& attribute : _scalarAttributes) {
+        attribute.second.values.resize(size, attribute.second.defaultValue);
+    }
+
+    for (auto& attribute : _vectorAttributes) {
+        attribute.second.values.resize(size, attribute.second.defaultValue);
+    }
+
+    _size = size;
+}
+
+template <int Dimension>
+void ParticleAttributesT<Dimension>::removeParticle(size_t index) {
+    for (auto& attribute : _scalarAttributes) {
+        attribute.second.values[index] = attribute.second.values.back();
+        attribute.second.values.pop_back();
+    }
+
+    for (auto& attribute : _vectorAttributes) {
+        attribute.second.values[index] = attribute.second.values.back();
+        attribute.second.values.pop_back();
+    }
+
+    _size--;
+}
+
+template <int Dimension>
+void ParticleAttributesT<Dimension>::reserve(size_t size) {
+    for (auto& attribute : _scalarAttributes) {
+        attribute.second.values.reserve(size);
+    }
+
+    for (auto& attribute : _vectorAttributes) {
+        attribute.second.values.reserve(size);
+    }
+}
+
+/**
+ * @brief Permutes a list of values so that the value at order[k] moves to slot k.
+ * 
+ * @tparam T: type of the values.
+ * @param values: The list of values to be permuted.
+ * @param order: The permutation.
+ */
+template <typename T>
+static void permute(std::vector<T>& values, const std::vector<size_t>& order) {
+    std::vector<T> permuted(values.size());
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < order.size(); k++) {
+        permuted[k] = values[order[k]];
+    }
+
+    values.swap(permuted);
+}
+
+template <int Dimension>
+void ParticleAttributesT<Dimension>::reorder(const std::vector<size_t>& order) {
+    for (auto& attribute : _scalarAttributes) {
+        permute(attribute.second.values, order);
+    }
+
+    for (auto& attribute : _vectorAttributes) {
+        permute(attribute.second.values, order);
+    }
+}
+
+template class ParticleAttributesT<2>;
+template class ParticleAttributesT<3>;
\ No newline at end of file
@@ -0,0 +1,62 @@
+/**
+ * @file ParticleEmitter2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the particle emitter for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/ParticleEmitter2D.h"
+#include <cmath>
+
+ParticleEmitter2D::ParticleEmitter2D(Eigen::Vector2d start, Eigen::Vector2d end, Eigen::Vector2d velocity,
+    double spacing, size_t maxParticles) {
+    _start = start;
+    _end = end;
+    _velocity = velocity;
+    _spacing = spacing;
+    _maxParticles = maxParticles;
+
+    // The first row is emitted on the first step.
+    _travelled = spacing;
+}
+
+ParticleEmitter2D::~ParticleEmitter2D() {}
+
+size_t ParticleEmitter2D::emit(SphParticleSystemData2D& data, double timeStepSize) {
+    const double speed = _velocity.norm();
+    const Eigen::Vector2d segment = _end - _start;
+    const int particlesPerRow = std::floor(segment.norm() / _spacing) + 1;
+    const Eigen::Vector2d step = particlesPerRow > 1 ? Eigen::Vector2d(segment / (particlesPerRow - 1)) : Eigen::Vector2d(0, 0);
+    size_t emitted = 0;
+
+    if (speed == 0.0) {
+        return 0;
+    }
+
+    const Eigen::Vector2d direction = _velocity / speed;
+    _travelled += speed * timeStepSize;
+
+    while (_travelled >= _spacing && _emittedCount < _maxParticles) {
+        _travelled -= _spacing;
+
+        // Each row starts where it would be if it had been emitted exactly on time.
+        const Eigen::Vector2d offset = direction * _travelled;
+
+        for (int k = 0; k < particlesPerRow && _emittedCount < _maxParticles; k++) {
+            data.addParticle(_start + step * k + offset);
+            data.getVelocities().back() = _velocity;
+            _emittedCount++;
+            emitted++;
+        }
+    }
+
+    return emitted;
+}
+
+size_t ParticleEmitter2D::getEmittedCount() {
+    return _emittedCount;
+}
\ No newline at end of file
@@ -12,4 +12,18 @@
 #include "../include/ParticleNeighborhood2D.h"
 
 ParticleNeighborhood2D::ParticleNeighborhood2D(){ }
-ParticleNeighborhood2D::~ParticleNeighborhood2D(){ }
\ No newline at end of file
+ParticleNeighborhood2D::~ParticleNeighborhood2D(){ }
+
+size_t ParticleNeighborhood2D::getTruncatedCount() const {
+	return _truncatedCount;
+}
+
+void ParticleNeighborhood2D::setMaxNeighbors(int maxNeighbors) {
+	_maxNeighbors = maxNeighbors;
+}
+
+int ParticleNeighborhood2D::getMaxNeighbors() const {
+	return _maxNeighbors;
+}
+
+void ParticleNeighborhood2D::invalidate() { }
\ No newline at end of file
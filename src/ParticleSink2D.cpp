@@ -0,0 +1,41 @@
+/**
+ * @file ParticleSink2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the particle sink for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/ParticleSink2D.h"
+
+ParticleSink2D::ParticleSink2D(Eigen::Vector2d min, Eigen::Vector2d max) {
+    _min = min;
+    _max = max;
+}
+
+ParticleSink2D::~ParticleSink2D() {}
+
+size_t ParticleSink2D::absorb(SphParticleSystemData2D& data) {
+    const std::vector<Eigen::Vector2d>& positions = data.getPositions();
+    _indices.clear();
+
+    for (size_t i = 0; i < data.numberOfParticles; i++) {
+        const Eigen::Vector2d& position = positions[i];
+
+        if (position(0) >= _min(0) && position(0) <= _max(0) &&
+            position(1) >= _min(1) && position(1) <= _max(1)) {
+            _indices.push_back(i);
+        }
+    }
+
+    data.removeParticles(_indices);
+    _absorbedCount += _indices.size();
+    return _indices.size();
+}
+
+size_t ParticleSink2D::getAbsorbedCount() {
+    return _absorbedCount;
+}
\ No newline at end of file
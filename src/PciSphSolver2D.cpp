@@ -0,0 +1,340 @@
+/**
+ * @file PciSphSolver2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the predictive-corrective incompressible SPH (PCISPH) solver for
+ * 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/PciSphSolver2D.h"
+#include "../include/SphSolverCore2D.h"
+#include "../include/SphKernels.h"
+#include "../include/BinarySerialization.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+PciSphSolver2D::PciSphSolver2D(int numberOfParticles, std::string fileName, NeighborhoodType neighborhoodType) :
+    SphSolver2D(fileName) {
+    _particleSystemData = std::make_shared<SphParticleSystemData2D>(neighborhoodType);
+    _particleSystemData->getAttributes().addScalarAttribute("correctedPressures");
+    _boundaryDumping = 0.5;
+    _timeStepSizeInSeconds = 0.002;
+
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    const double spacing = 0.5 * kernelRadius;
+    const int columns = std::max(1, (int) std::sqrt(numberOfParticles));
+
+    _pointSize = spacing;
+
+    for (int count = 0; count < numberOfParticles; count++) {
+        addParticle(Eigen::Vector2d(_viewWidth / 4 + spacing * (count % columns),
+            kernelRadius + spacing * (count / columns)));
+    }
+
+    computePressureCorrectionFactor();
+
+    _particleSystemData->getNeighborhood()->setGridResolution(_viewWidth, _viewHeight, kernelRadius);
+    _particleSystemData->buildNeighborhood();
+}
+
+PciSphSolver2D::~PciSphSolver2D() {}
+
+void PciSphSolver2D::computePressureCorrectionFactor() {
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    const double mass = _particleSystemData->getMass();
+    const double spacing = 0.5 * kernelRadius;
+    const int reach = std::ceil(kernelRadius / spacing);
+    SphPoly6Kernel densityKernel(kernelRadius);
+    SphSpikyKernel pressureKernel(kernelRadius);
+
+    double restDensity = mass * densityKernel(kernelRadius * kernelRadius);
+    Eigen::Vector2d gradientSum(0.0, 0.0);
+    double gradientSquaredSum = 0.0;
+
+    for (int i = -reach; i <= reach; i++) {
+        for (int j = -reach; j <= reach; j++) {
+            const Eigen::Vector2d offset(spacing * i, spacing * j);
+            const double distance = offset.norm();
+
+            if (distance > 0.0 && distance < kernelRadius) {
+                const double distanceDifference = kernelRadius - distance;
+                double derivative;
+                pressureKernel.derivativesAt(&distanceDifference, &derivative, 1);
+
+                const Eigen::Vector2d gradient = -derivative * offset / distance;
+                restDensity += mass * densityKernel(kernelRadius * kernelRadius - distance * distance);
+                gradientSum += gradient;
+                gradientSquaredSum += gradient.squaredNorm();
+            }
+        }
+    }
+
+    // Pressure changes the predicted density by beta times the sums of the prototype gradients.
+    const double beta = 2.0 * std::pow(_timeStepSizeInSeconds * mass / restDensity, 2.0);
+    _particleSystemData->setRestDensity(restDensity);
+    _pressureCorrectionFactor = 1.0 / (beta * (gradientSum.squaredNorm() + gradientSquaredSum));
+}
+
+void PciSphSolver2D::computeKernelGradients() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    ParticleNeighborhood2DPtr neighborhood = _particleSystemData->getNeighborhood();
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    SphSpikyKernel pressureKernel(kernelRadius);
+
+    _gradientOffsets.resize(numberOfParticles + 1);
+    _gradientOffsets[0] = 0;
+    for (int i = 0; i < numberOfParticles; i++) {
+        _gradientOffsets[i + 1] = _gradientOffsets[i] + neighborhood->getNeighbors(i).size;
+    }
+    _kernelGradients.resize(_gradientOffsets[numberOfParticles]);
+
+    #pragma omp parallel
+    {
+        std::vector<double> distanceDifferences;
+        std::vector<double> derivatives;
+
+        #pragma omp for schedule(runtime)
+        for (int i = 0; i < numberOfParticles; i++) {
+            const NeighborList2D neighbors = neighborhood->getNeighbors(i);
+            Eigen::Vector2d *gradients = &_kernelGradients[_gradientOffsets[i]];
+            distanceDifferences.resize(neighbors.size);
+            derivatives.resize(neighbors.size);
+
+            for (int k = 0; k < neighbors.size; k++) {
+                distanceDifferences[k] = std::max(0.0, kernelRadius - neighbors.distances[k]);
+            }
+
+            pressureKernel.derivativesAt(distanceDifferences.data(), derivatives.data(), neighbors.size);
+
+            for (int k = 0; k < neighbors.size; k++) {
+                const double distance = neighbors.distances[k];
+                const Eigen::Vector2d dx = positions[i] - positions[neighbors.indices[k]];
+                gradients[k] = distance > 0.0 ? Eigen::Vector2d(derivatives[k] * dx / distance) :
+                    Eigen::Vector2d(0.0, 0.0);
+            }
+        }
+    }
+}
+
+void PciSphSolver2D::predictPositions() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    const std::vector<Eigen::Vector2d>& velocities = _particleSystemData->getVelocities();
+    const std::vector<Eigen::Vector2d>& forces = _particleSystemData->getForces();
+    const std::vector<double>& densities = _particleSystemData->getDensities();
+    std::vector<Eigen::Vector2d>& projectedPositions = _particleSystemData->getProjectedPositions();
+    const double particleRadius = _particleSystemData->getParticleRadius();
+    const bool colliders = prepareColliders();
+
+    #pragma omp parallel for
+    for (int i = 0; i < numberOfParticles; i++) {
+        const Eigen::Vector2d acceleration = forces[i] / densities[i] + _pressureAccelerations[i];
+        const Eigen::Vector2d velocity = velocities[i] + _timeStepSizeInSeconds * acceleration;
+        Eigen::Vector2d projectedPosition = positions[i] + _timeStepSizeInSeconds * velocity;
+
+        // The predicted positions stay inside the boundaries, as enforceBoundary keeps them,
+        // and out of the colliders. Colliders have no particles on their side to push back,
+        // so the predictions are only moved onto their surface: moving them one particle
+        // radius out raised the predicted densities along the obstacle, and the corrected
+        // pressures then drove the fluid into it.
+        for (const Eigen::Vector3d& b : _boundaries) {
+            const double d = projectedPosition.dot(b.segment<2>(0)) - b(2);
+            if (d < particleRadius) {
+                projectedPosition += (particleRadius - d) * b.segment<2>(0);
+            }
+        }
+
+        if (colliders) {
+            projectedPosition = pushOutOfColliders(projectedPosition);
+        }
+
+        projectedPositions[i] = projectedPosition;
+    }
+}
+
+double PciSphSolver2D::correctPressures() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const std::vector<Eigen::Vector2d>& projectedPositions = _particleSystemData->getProjectedPositions();
+    std::vector<double>& pressures = _particleSystemData->getPressures();
+    std::vector<double>& densityVariations = _particleSystemData->getDensityVariations();
+    std::vector<double>& pressureVariations = _particleSystemData->getPressureVariations();
+    ParticleNeighborhood2DPtr neighborhood = _particleSystemData->getNeighborhood();
+    const double kernelRadiusSquared = std::pow(_particleSystemData->getKernelRadius(), 2.0);
+    const double mass = _particleSystemData->getMass();
+    const double restDensity = _particleSystemData->getRestDensity();
+    SphPoly6Kernel densityKernel(_particleSystemData->getKernelRadius());
+    const double selfDensity = mass * densityKernel(kernelRadiusSquared);
+    double densityErrorSum = 0.0;
+
+    #pragma omp parallel for schedule(runtime) reduction(+:densityErrorSum)
+    for (int i = 0; i < numberOfParticles; i++) {
+        const NeighborList2D neighbors = neighborhood->getNeighbors(i);
+        double density = selfDensity;
+
+        for (int k = 0; k < neighbors.size; k++) {
+            const double distanceSquared = (projectedPositions[neighbors.indices[k]] - projectedPositions[i]).squaredNorm();
+            if (distanceSquared < kernelRadiusSquared) {
+                density += mass * densityKernel(kernelRadiusSquared - distanceSquared);
+            }
+        }
+
+        // Pressures only push particles apart, so the free surface does not clump, and only
+        // compression counts as error.
+        const double densityError = density - restDensity;
+        const double pressure = std::max(0.0, pressures[i] + _pressureCorrectionFactor * densityError);
+        densityVariations[i] = densityError;
+        pressureVariations[i] = pressure - pressures[i];
+        pressures[i] = pressure;
+
+        if (!_deterministic) {
+            densityErrorSum += std::max(0.0, densityError) / restDensity;
+        }
+    }
+
+    // The reduction rounds differently for each number of threads, so the deterministic mode
+    // sums the errors in a fixed order instead
+    if (_deterministic) {
+        densityErrorSum = _densityErrorSum.sum(numberOfParticles,
+            [&](size_t i) { return std::max(0.0, densityVariations[i]) / restDensity; }, 0.0);
+    }
+
+    return numberOfParticles > 0 ? densityErrorSum / numberOfParticles : 0.0;
+}
+
+void PciSphSolver2D::computePressureAccelerations() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const std::vector<double>& pressures = _particleSystemData->getPressures();
+    ParticleNeighborhood2DPtr neighborhood = _particleSystemData->getNeighborhood();
+    const double mass = _particleSystemData->getMass();
+    const double restDensity = _particleSystemData->getRestDensity();
+    const double factor = -mass / (restDensity * restDensity);
+
+    #pragma omp parallel for schedule(runtime)
+    for (int i = 0; i < numberOfParticles; i++) {
+        const NeighborList2D neighbors = neighborhood->getNeighbors(i);
+        const Eigen::Vector2d *gradients = &_kernelGradients[_gradientOffsets[i]];
+        Eigen::Vector2d acceleration(0.0, 0.0);
+
+        for (int k = 0; k < neighbors.size; k++) {
+            acceleration += (pressures[i] + pressures[neighbors.indices[k]]) * gradients[k];
+        }
+
+        _pressureAccelerations[i] = factor * acceleration;
+    }
+}
+
+void PciSphSolver2D::setTimeStepSize(double timeStepSizeInSeconds) {
+    _timeStepSizeInSeconds = timeStepSizeInSeconds;
+    computePressureCorrectionFactor();
+}
+
+void PciSphSolver2D::setPressureSolverSettings(const PressureSolverSettings& settings) {
+    _pressureSolverSettings = settings;
+    _pressureSolverSettings.maxIterations = std::max(1, settings.maxIterations);
+}
+
+int PciSphSolver2D::getPressureIterations() {
+    return _pressureIterations;
+}
+
+double PciSphSolver2D::getDensityError() {
+    return _densityError;
+}
+
+std::string PciSphSolver2D::getCheckpointName() {
+    return "PciSphSolver2D";
+}
+
+void PciSphSolver2D::writeState(std::ostream& stream) {
+    SphSolver2D::writeState(stream);
+    writeBinary(stream, _pressureSolverSettings.densityErrorTolerance);
+    writeBinary(stream, _pressureSolverSettings.minIterations);
+    writeBinary(stream, _pressureSolverSettings.maxIterations);
+    writeBinary(stream, _pressureCorrectionFactor);
+    writeBinary(stream, _pressureIterations);
+    writeBinary(stream, _densityError);
+}
+
+bool PciSphSolver2D::readState(std::istream& stream) {
+    return SphSolver2D::readState(stream) && readBinary(stream, _pressureSolverSettings.densityErrorTolerance) &&
+        readBinary(stream, _pressureSolverSettings.minIterations) &&
+        readBinary(stream, _pressureSolverSettings.maxIterations) && readBinary(stream, _pressureCorrectionFactor) && readBinary(stream, _pressureIterations) &&
+        readBinary(stream, _densityError);
+}
+
+bool PciSphSolver2D::setPrecision(SolverPrecision precision) {
+    return precision == SolverPrecision::Double && SphSolver2D::setPrecision(precision);
+}
+
+void PciSphSolver2D::update() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    std::vector<double>& densities = _particleSystemData->getDensities();
+    std::vector<double>& pressures = _particleSystemData->getPressures();
+    std::vector<Eigen::Vector2d>& forces = _particleSystemData->getForces();
+    std::vector<double>& correctedPressures = _particleSystemData->getAttributes().getScalarAttribute("correctedPressures");
+    SphSolverCore2D<double> core(_particleSystemData->getKernelRadius(),
+        _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+    PhaseTimer timer;
+
+    applyEmittersAndSinks();
+    timer.lap(_stats.timings.boundary);
+    LoopScheduleScope loopSchedule = applyLoopSchedule();
+    reorderParticles();
+    _particleSystemData->buildNeighborhood();
+    SPH_STATS(collectNeighborStats());
+    timer.lap(_stats.timings.neighborBuild);
+    _particleSystemData->computeDensityPressure();
+    SPH_STATS(collectDensityStats());
+
+    // The pressures of the equation of state are replaced by the corrected ones, so the
+    // forces of the base solver only hold viscosity and gravity.
+    std::fill(pressures.begin(), pressures.end(), 0.0);
+    core.computeForces(*_particleSystemData->getNeighborhood(), _particleSystemData->getPositions(),
+        _particleSystemData->getVelocities(), densities, pressures, forces);
+    timer.lap(_stats.timings.forces);
+
+    // The corrected pressures of the previous step are the first guess of this one.
+    std::copy(correctedPressures.begin(), correctedPressures.end(), pressures.begin());
+    computeKernelGradients();
+    _pressureAccelerations.resize(numberOfParticles);
+    computePressureAccelerations();
+    _pressureIterations = 0;
+
+    do {
+        predictPositions();
+        _densityError = correctPressures();
+        computePressureAccelerations();
+        _pressureIterations++;
+    } while ((_pressureIterations < _pressureSolverSettings.minIterations ||
+        _densityError > _pressureSolverSettings.densityErrorTolerance) &&
+        _pressureIterations < _pressureSolverSettings.maxIterations);
+    std::copy(pressures.begin(), pressures.end(), correctedPressures.begin());
+    timer.lap(_stats.timings.densityPressure);
+
+    #pragma omp parallel for
+    for (int i = 0; i < numberOfParticles; i++) {
+        forces[i] += densities[i] * _pressureAccelerations[i];
+    }
+
+    core.integrate(_particleSystemData->getPositions(), _particleSystemData->getVelocities(),
+        forces, densities, _timeStepSizeInSeconds);
+    timer.lap(_stats.timings.integrate);
+    enforceBoundary();
+    timer.lap(_stats.timings.boundary);
+
+    if (_fileName != "") {
+        writeToFile();
+        timer.lap(_stats.timings.output);
+    }
+
+    SPH_STATS(_stats.solverSteps++);
+    SPH_STATS(_stats.pressureIterations += _pressureIterations);
+    SPH_STATS(finishUpdateStats());
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+/**
+ * @file PolygonCollider2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the polygon collider for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/PolygonCollider2D.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Corner with the lowest coordinates of the box around the vertices, grown by a margin.
+ * 
+ */
+static Eigen::Vector2d boxMin(const std::vector<Eigen::Vector2d>& vertices, double margin) {
+    if (vertices.empty()) {
+        return Eigen::Vector2d::Zero();
+    }
+
+    Eigen::Vector2d min = vertices.front();
+    for (const Eigen::Vector2d& vertex : vertices) {
+        min = min.cwiseMin(vertex);
+    }
+    return min - Eigen::Vector2d(margin, margin);
+}
+
+/**
+ * @brief Corner with the highest coordinates of the box around the vertices, grown by a margin.
+ * 
+ */
+static Eigen::Vector2d boxMax(const std::vector<Eigen::Vector2d>& vertices, double margin) {
+    if (vertices.empty()) {
+        return Eigen::Vector2d::Zero();
+    }
+
+    Eigen::Vector2d max = vertices.front();
+    for (const Eigen::Vector2d& vertex : vertices) {
+        max = max.cwiseMax(vertex);
+    }
+    return max + Eigen::Vector2d(margin, margin);
+}
+
+PolygonCollider2D::PolygonCollider2D(const std::vector<Eigen::Vector2d>& vertices, double cellSize, double margin) :
+    SdfCollider2D(boxMin(vertices, margin), boxMax(vertices, margin), cellSize,
+        [&vertices](const Eigen::Vector2d& position) { return signedDistance(vertices, position); }) {
+    _vertices = vertices;
+
+    if (vertices.size() < 3) {
+        invalidate();
+    }
+}
+
+PolygonCollider2D::~PolygonCollider2D() {}
+
+double PolygonCollider2D::signedDistance(const std::vector<Eigen::Vector2d>& vertices, const Eigen::Vector2d& position) {
+    double distanceSquared = std::numeric_limits<double>::max();
+    bool inside = false;
+
+    for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++) {
+        const Eigen::Vector2d& a = vertices[j];
+        const Eigen::Vector2d& b = vertices[i];
+        const Eigen::Vector2d edge = b - a;
+        const double t = std::clamp((position - a).dot(edge) / edge.squaredNorm(), 0.0, 1.0);
+        distanceSquared = std::min(distanceSquared, (position - a - t * edge).squaredNorm());
+
+        // Even-odd rule: count the edges crossed by a ray towards +x
+        if ((a(1) > position(1)) != (b(1) > position(1)) &&
+            position(0) < a(0) + (position(1) - a(1)) * edge(0) / edge(1)) {
+            inside = !inside;
+        }
+    }
+
+    return inside ? -std::sqrt(distanceSquared) : std::sqrt(distanceSquared);
+}
+
+const std::vector<Eigen::Vector2d>& PolygonCollider2D::getVertices() const {
+    return _vertices;
+}
\ No newline at end of file
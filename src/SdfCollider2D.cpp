@@ -0,0 +1,116 @@
+/**
+ * @file SdfCollider2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the signed distance field collider for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/SdfCollider2D.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SdfCollider2D::SdfCollider2D(Eigen::Vector2d min, Eigen::Vector2d max, double cellSize,
+    const std::function<double(const Eigen::Vector2d&)>& signedDistance) {
+    _min = min;
+    _cellSize = cellSize;
+
+    if (!(cellSize > 0.0 && std::isfinite(cellSize) && min.allFinite() && max.allFinite() &&
+        max(0) >= min(0) && max(1) >= min(1))) {
+        invalidate();
+        return;
+    }
+
+    _width = std::max(2, (int) std::ceil((max(0) - min(0)) / cellSize) + 1);
+    _height = std::max(2, (int) std::ceil((max(1) - min(1)) / cellSize) + 1);
+    _distances.resize((size_t) _width * _height);
+
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < _width; x++) {
+            _distances[(size_t) y * _width + x] = signedDistance(_min + Eigen::Vector2d(x, y) * _cellSize);
+        }
+    }
+}
+
+SdfCollider2D::SdfCollider2D(Eigen::Vector2d min, double cellSize, int width, int height,
+    std::vector<double> distances) {
+    _min = min;
+    _cellSize = cellSize;
+    _width = width;
+    _height = height;
+    _distances = std::move(distances);
+
+    if (!(cellSize > 0.0 && std::isfinite(cellSize) && min.allFinite() && width >= 2 && height >= 2 &&
+        _distances.size() == (size_t) width * height)) {
+        invalidate();
+    }
+}
+
+SdfCollider2D::~SdfCollider2D() {}
+
+bool SdfCollider2D::isValid() const {
+    return _width >= 2 && _height >= 2;
+}
+
+void SdfCollider2D::invalidate() {
+    // A unit cell keeps the divisions of lookup finite, and no nodes make it fail
+    _min = Eigen::Vector2d::Zero();
+    _cellSize = 1.0;
+    _width = 0;
+    _height = 0;
+    _distances.clear();
+}
+
+bool SdfCollider2D::lookup(const Eigen::Vector2d& position, double& distance, Eigen::Vector2d& normal) const {
+    const double gx = (position(0) - _min(0)) / _cellSize;
+    const double gy = (position(1) - _min(1)) / _cellSize;
+
+    if (!(gx >= 0.0 && gy >= 0.0 && gx <= _width - 1 && gy <= _height - 1)) {
+        return false;
+    }
+
+    // Points on the last row or column interpolate in the cell before it
+    const int x = std::min((int) gx, _width - 2);
+    const int y = std::min((int) gy, _height - 2);
+    const double tx = gx - x;
+    const double ty = gy - y;
+
+    const double *row = &_distances[(size_t) y * _width + x];
+    const double d00 = row[0];
+    const double d10 = row[1];
+    const double d01 = row[_width];
+    const double d11 = row[_width + 1];
+
+    distance = (d00 * (1.0 - tx) + d10 * tx) * (1.0 - ty) + (d01 * (1.0 - tx) + d11 * tx) * ty;
+
+    // Gradient of the bilinear interpolation, pointing out of the obstacle
+    Eigen::Vector2d gradient((d10 - d00) * (1.0 - ty) + (d11 - d01) * ty,
+        (d01 - d00) * (1.0 - tx) + (d11 - d10) * tx);
+    const double norm = gradient.norm();
+    normal = norm > 0.0 ? Eigen::Vector2d(gradient / norm) : Eigen::Vector2d(0.0, 1.0);
+
+    return true;
+}
+
+double SdfCollider2D::getDistance(const Eigen::Vector2d& position) const {
+    double distance;
+    Eigen::Vector2d normal;
+
+    if (!lookup(position, distance, normal)) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return distance;
+}
+
+Eigen::Vector2d SdfCollider2D::getMin() const {
+    return _min;
+}
+
+Eigen::Vector2d SdfCollider2D::getMax() const {
+    return _min + Eigen::Vector2d(_width - 1, _height - 1) * _cellSize;
+}
\ No newline at end of file
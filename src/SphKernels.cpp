@@ -11,27 +11,101 @@
 
 #include "../include/SphKernels.h"
 #include "../include/Constants.h"
+#include <cmath>
+#include <type_traits>
 
-SphPoly6Kernel::SphPoly6Kernel(double kernelRadius_) {
+// The double cubes are computed with pow, which rounds differently than x * x * x, to keep
+// the results of the reference solvers reproducible. The float kernels are only used by the
+// single precision steps, which have their own benchmark, so they multiply instead and the
+// batched loops vectorize. The 3D normalizations are the ones of Muller et al., while the 2D
+// ones keep the constants of the reference implementation.
+
+template <typename Scalar>
+static inline Scalar cube(Scalar value) {
+    if constexpr (std::is_same<Scalar, float>::value) {
+        return value * value * value;
+    } else {
+        return std::pow(value, Scalar(3.0));
+    }
+}
+
+template <typename Scalar, int Dimension>
+SphPoly6KernelT<Scalar, Dimension>::SphPoly6KernelT(Scalar kernelRadius_) {
     kernelRadius = kernelRadius_;
+    normalization = Dimension == 2 ? 4.f / (M_PI * pow(kernelRadius, 8.0)) :
+        315.0 / (64.0 * M_PI * pow(kernelRadius, 9.0));
 }
 
-double SphPoly6Kernel::operator()(double distanceSquaredDifference) const {
-    return (4.f / (M_PI * pow(kernelRadius, 8.0))) * pow(distanceSquaredDifference, 3.0);
+template <typename Scalar, int Dimension>
+Scalar SphPoly6KernelT<Scalar, Dimension>::operator()(Scalar distanceSquaredDifference) const {
+    return normalization * cube(distanceSquaredDifference);
 }
 
-SphSpikyKernel::SphSpikyKernel(double kernelRadius_) {
+template <typename Scalar, int Dimension>
+void SphPoly6KernelT<Scalar, Dimension>::operator()(const Scalar *distanceSquaredDifferences, Scalar *values, int count) const {
+    #pragma omp simd
+    for (int k = 0; k < count; k++) {
+        values[k] = normalization * cube(distanceSquaredDifferences[k]);
+    }
+}
+
+template <typename Scalar, int Dimension>
+SphSpikyKernelT<Scalar, Dimension>::SphSpikyKernelT(Scalar kernelRadius_) {
     kernelRadius = kernelRadius_;
+    normalization = Dimension == 2 ? -10.0 / (M_PI * pow(kernelRadius, 5.0)) :
+        -15.0 / (M_PI * pow(kernelRadius, 6.0));
 }   
 
-double SphSpikyKernel::gradientAt(double distanceSquaredDifference) const {
-    return (-10.0 / (M_PI * pow(kernelRadius, 5.0))) * pow(distanceSquaredDifference, 3.0);
+template <typename Scalar, int Dimension>
+Scalar SphSpikyKernelT<Scalar, Dimension>::gradientAt(Scalar distanceSquaredDifference) const {
+    return normalization * cube(distanceSquaredDifference);
 }   
 
-SphViscosityKernel::SphViscosityKernel(double kernelRadius_) {
+template <typename Scalar, int Dimension>
+void SphSpikyKernelT<Scalar, Dimension>::gradientsAt(const Scalar *distanceSquaredDifferences, Scalar *values, int count) const {
+    #pragma omp simd
+    for (int k = 0; k < count; k++) {
+        values[k] = normalization * cube(distanceSquaredDifferences[k]);
+    }
+}
+
+template <typename Scalar, int Dimension>
+void SphSpikyKernelT<Scalar, Dimension>::derivativesAt(const Scalar *distanceDifferences, Scalar *values, int count) const {
+    #pragma omp simd
+    for (int k = 0; k < count; k++) {
+        values[k] = Scalar(3.0) * normalization * distanceDifferences[k] * distanceDifferences[k];
+    }
+}
+
+template <typename Scalar, int Dimension>
+SphViscosityKernelT<Scalar, Dimension>::SphViscosityKernelT(Scalar kernelRadius_) {
     kernelRadius = kernelRadius_;
+    normalization = Dimension == 2 ? 40.0 / (M_PI * pow(kernelRadius, 5.0)) :
+        45.0 / (M_PI * pow(kernelRadius, 6.0));
+}
+
+template <typename Scalar, int Dimension>
+Scalar SphViscosityKernelT<Scalar, Dimension>::laplacianAt(Scalar distanceSquaredDifference) const {
+    return normalization * distanceSquaredDifference;
+}
+
+template <typename Scalar, int Dimension>
+void SphViscosityKernelT<Scalar, Dimension>::laplaciansAt(const Scalar *distanceSquaredDifferences, Scalar *values, int count) const {
+    #pragma omp simd
+    for (int k = 0; k < count; k++) {
+        values[k] = normalization * distanceSquaredDifferences[k];
+    }
 }
 
-double SphViscosityKernel::laplacianAt(double distanceSquaredDifference) const {
-    return (40.0 / (M_PI * pow(kernelRadius, 5.0))) * distanceSquaredDifference;
-}
\ No newline at end of file
+template struct SphPoly6KernelT<double>;
+template struct SphPoly6KernelT<float>;
+template struct SphSpikyKernelT<double>;
+template struct SphSpikyKernelT<float>;
+template struct SphViscosityKernelT<double>;
+template struct SphViscosityKernelT<float>;
+template struct SphPoly6KernelT<double, 3>;
+template struct SphPoly6KernelT<float, 3>;
+template struct SphSpikyKernelT<double, 3>;
+template struct SphSpikyKernelT<float, 3>;
+template struct SphViscosityKernelT<double, 3>;
+template struct SphViscosityKernelT<float, 3>;
\ No newline at end of file
@@ -10,39 +10,101 @@
  */
 
 #include "../include/SphParticleSystemData2D.h"
-#include "../include/SphKernels.h"
+#include "../include/GridNeighborhood2D.h"
+#include "../include/CellListNeighborhood2D.h"
+#include "../include/HashNeighborhood2D.h"
+#include "../include/SphSolverCore2D.h"
 #include "../include/Constants.h"
+#include "../include/BinarySerialization.h"
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <functional>
+
+SphParticleSystemData2D::SphParticleSystemData2D(NeighborhoodType neighborhoodType) :
+    _positions(_attributes.addVectorAttribute("positions")),
+    _velocities(_attributes.addVectorAttribute("velocities")),
+    _forces(_attributes.addVectorAttribute("forces")),
+    _densities(_attributes.addScalarAttribute("densities")),
+    _pressures(_attributes.addScalarAttribute("pressures")),
+    _lastPositions(_attributes.addVectorAttribute("lastPositions")),
+    _projectedPositions(_attributes.addVectorAttribute("projectedPositions")),
+    _densityVariations(_attributes.addScalarAttribute("densityVariations")),
+    _pressureVariations(_attributes.addScalarAttribute("pressureVariations")),
+    _persistentIds(_attributes.addScalarAttribute("persistentIds")) {
+    if (neighborhoodType == NeighborhoodType::CellList) {
+        _neighborhood = std::make_shared<CellListNeighborhood2D>();
+    } else if (neighborhoodType == NeighborhoodType::Hash) {
+        _neighborhood = std::make_shared<HashNeighborhood2D>();
+    } else {
+        _neighborhood = std::make_shared<GridNeighborhood2D>();
+    }
 
-SphParticleSystemData2D::SphParticleSystemData2D() {}
+    _neighborhood->setSortByIndex(true);
+}
 
 SphParticleSystemData2D::~SphParticleSystemData2D() {}
 
 void SphParticleSystemData2D::addParticle(Eigen::Vector2d positon) {
-    _positions.push_back(positon);
-    _velocities.push_back(Eigen::Vector2d(0, 0));
-    _forces.push_back(Eigen::Vector2d(0, 0));
-    _densities.push_back(0);
-    _pressures.push_back(0);
+    _attributes.addParticle();
+    _positions.back() = positon;
+    _lastPositions.back() = positon;
+    _persistentIds.back() = _nextPersistentId++;
+    _particleIds.push_back(numberOfParticles);
+    _particleSlots.push_back(numberOfParticles);
     numberOfParticles++;
+    _neighborhood->invalidate();
+}
+
+void SphParticleSystemData2D::removeParticle(size_t index) {
+    const size_t last = numberOfParticles - 1;
+    const size_t removedId = _particleIds[index];
+
+    // The last slot moves into the removed one.
+    _attributes.removeParticle(index);
+    _particleIds[index] = _particleIds[last];
+    _particleSlots[_particleIds[index]] = index;
+    _particleIds.pop_back();
+
+    // The particle with the highest id takes the removed id.
+    if (removedId != last) {
+        const size_t slot = _particleSlots[last];
+        _particleIds[slot] = removedId;
+        _particleSlots[removedId] = slot;
+    }
+    _particleSlots.pop_back();
+
+    numberOfParticles--;
+    _reordered = true;
+    _neighborhood->invalidate();
+}
+
+void SphParticleSystemData2D::removeParticles(std::vector<size_t>& indices) {
+    // Removing the highest slot first never moves a particle that is still to be removed.
+    std::sort(indices.begin(), indices.end(), std::greater<size_t>());
+
+    for (size_t index : indices) {
+        removeParticle(index);
+    }
+}
+
+void SphParticleSystemData2D::reserve(size_t size) {
+    _attributes.reserve(size);
+    _particleIds.reserve(size);
+    _particleSlots.reserve(size);
 }
 
 void SphParticleSystemData2D::computeDensityPressure() {
-    SphPoly6Kernel kernel(_kernelRadius);
+    SphSolverCore2D<double> core(_kernelRadius, _mass, _viscosityConstant);
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < numberOfParticles; i++) {
-        _densities[i] = 0;
-        for (size_t j = 0; j < numberOfParticles; j++) {
-            Eigen::Vector2d resultingVector = _positions[j] - _positions[i];
-			float distanceSquared = resultingVector.squaredNorm();
-
-            if (distanceSquared < _kernelRadiusSquared)
-			{
-				_densities[i] += _mass * kernel(_kernelRadiusSquared - distanceSquared);
-			}
-        }
-        _pressures[i] = GAS_CONSTANT * (_densities[i] - REST_DENSITY);
+    if (_neighborhood->isHalfNeighborList()) {
+        core.computeDensityPressureSymmetric(*_neighborhood, _positions, _densityBuffers, _densities, _pressures);
+        return;
     }
+
+    core.computeDensityPressure(*_neighborhood, _positions, _densities, _pressures);
 }
 
 std::vector<Eigen::Vector2d>& SphParticleSystemData2D::getPositions() {
@@ -78,6 +140,14 @@ const double SphParticleSystemData2D::getMass() {
     return _mass;
 }
 
+double SphParticleSystemData2D::getRestDensity() {
+    return _restDensity;
+}
+
+void SphParticleSystemData2D::setRestDensity(double newRestDensity) {
+    _restDensity = newRestDensity;
+}
+
 void SphParticleSystemData2D::setMass(double newMass) {
     _mass = newMass;
 }
@@ -130,22 +200,252 @@ double SphParticleSystemData2D::getStiffness() {
     return _stiffness;
 }
 
+void SphParticleSystemData2D::setStiffness(double newStiffness) {
+    _stiffness = newStiffness;
+}
+
 double SphParticleSystemData2D::getStiffnessAtProximity() {
     return _stiffnessAtProximity;
 }
 
+void SphParticleSystemData2D::setStiffnessAtProximity(double newStiffnessAtProximity) {
+    _stiffnessAtProximity = newStiffnessAtProximity;
+}
+
 double SphParticleSystemData2D::getLinearViscosity() {
     return _linearViscosity;
 }
 
+void SphParticleSystemData2D::setLinearViscosity(double newLinearViscosity) {
+    _linearViscosity = newLinearViscosity;
+}
+
 double SphParticleSystemData2D::getQuadraticViscosity() {
     return _quadraticViscosity;
 }
 
+void SphParticleSystemData2D::setQuadraticViscosity(double newQuadraticViscosity) {
+    _quadraticViscosity = newQuadraticViscosity;
+}
+
 double SphParticleSystemData2D::getSurfaceTension() {
     return _surfaceTension;
 }  
 
+void SphParticleSystemData2D::setSurfaceTension(double newSurfaceTension) {
+    _surfaceTension = newSurfaceTension;
+}
+
 ParticleNeighborhood2DPtr SphParticleSystemData2D::getNeighborhood() {
     return _neighborhood;
+}
+
+void SphParticleSystemData2D::setNeighborhood(ParticleNeighborhood2DPtr neighborhood) {
+    _neighborhood = neighborhood;
+}
+
+ParticleAttributes2D& SphParticleSystemData2D::getAttributes() {
+    return _attributes;
+}
+
+/**
+ * @brief Spreads the lower 32 bits of a value so that there is a zero bit between each of them.
+ * 
+ * @param value: The value to be spread.
+ * @return uint64_t representing the spread value.
+ */
+static uint64_t spreadBits(uint64_t value) {
+    value &= 0x00000000FFFFFFFF;
+    value = (value | (value << 16)) & 0x0000FFFF0000FFFF;
+    value = (value | (value << 8)) & 0x00FF00FF00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0F;
+    value = (value | (value << 2)) & 0x3333333333333333;
+    value = (value | (value << 1)) & 0x5555555555555555;
+    return value;
+}
+
+void SphParticleSystemData2D::sortParticles() {
+    std::vector<uint64_t> keys(numberOfParticles);
+    std::vector<size_t> order(numberOfParticles);
+    std::iota(order.begin(), order.end(), 0);
+
+    // Converting infinities, NaN or values past 64 bits is undefined, so clamp first
+    double minX = std::numeric_limits<double>::infinity();
+    double minY = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        if (std::isfinite(_positions[i](0))) {
+            minX = std::min(minX, _positions[i](0));
+        }
+        if (std::isfinite(_positions[i](1))) {
+            minY = std::min(minY, _positions[i](1));
+        }
+    }
+
+    auto cellOf = [&](double coordinate, double min) -> uint64_t {
+        const double cell = (coordinate - min) / _kernelRadius;
+        return cell >= 0.0 ? (uint64_t) std::min(cell, 4294967295.0) : 0;
+    };
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        uint64_t x = cellOf(_positions[i](0), minX);
+        uint64_t y = cellOf(_positions[i](1), minY);
+        keys[i] = spreadBits(x) | (spreadBits(y) << 1);
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+        [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    _attributes.reorder(order);
+
+    std::vector<size_t> particleIds(numberOfParticles);
+    for (size_t k = 0; k < numberOfParticles; k++) {
+        particleIds[k] = _particleIds[order[k]];
+    }
+    _particleIds.swap(particleIds);
+
+    for (size_t k = 0; k < numberOfParticles; k++) {
+        _particleSlots[_particleIds[k]] = k;
+    }
+
+    _reordered = true;
+    _neighborhood->invalidate();
+}
+
+const std::vector<size_t>& SphParticleSystemData2D::getParticleIds() {
+    return _particleIds;
+}
+
+std::vector<double>& SphParticleSystemData2D::getPersistentIds() {
+    return _persistentIds;
+}
+
+bool SphParticleSystemData2D::isReordered() {
+    return _reordered;
+}
+
+void SphParticleSystemData2D::toIdOrder(const std::vector<Eigen::Vector2d>& values, std::vector<Eigen::Vector2d>& result) {
+    result.resize(values.size());
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < values.size(); k++) {
+        result[_particleIds[k]] = values[k];
+    }
+}
+
+void SphParticleSystemData2D::toIdOrder(const std::vector<double>& values, std::vector<double>& result) {
+    result.resize(values.size());
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < values.size(); k++) {
+        result[_particleIds[k]] = values[k];
+    }
+}
+
+void SphParticleSystemData2D::writeState(std::ostream& stream) {
+    const std::vector<std::string> scalarNames = _attributes.getScalarAttributeNames();
+    const std::vector<std::string> vectorNames = _attributes.getVectorAttributeNames();
+
+    writeBinary(stream, static_cast<uint64_t>(numberOfParticles));
+    writeBinary(stream, static_cast<uint64_t>(scalarNames.size()));
+    for (const std::string& name : scalarNames) {
+        writeBinary(stream, name);
+        writeBinary(stream, _attributes.getScalarAttribute(name));
+    }
+
+    writeBinary(stream, static_cast<uint64_t>(vectorNames.size()));
+    for (const std::string& name : vectorNames) {
+        writeBinary(stream, name);
+        writeBinary(stream, _attributes.getVectorAttribute(name));
+    }
+
+    writeBinary(stream, _particleIds);
+    writeBinary(stream, _reordered);
+    writeBinary(stream, _nextPersistentId);
+
+    for (double parameter : {_kernelFactor, _kernelFactorNorm, _stiffness, _stiffnessAtProximity,
+        _linearViscosity, _quadraticViscosity, _surfaceTension, _kernelRadius, _kernelRadiusSquared,
+        _mass, _viscosityConstant, _particleRadius, _restDensity}) {
+        writeBinary(stream, parameter);
+    }
+}
+
+bool SphParticleSystemData2D::readState(std::istream& stream) {
+    const std::vector<std::string> scalarNames = _attributes.getScalarAttributeNames();
+    const std::vector<std::string> vectorNames = _attributes.getVectorAttributeNames();
+    std::vector<std::vector<double>> scalars(scalarNames.size());
+    std::vector<std::vector<Eigen::Vector2d>> vectors(vectorNames.size());
+    std::vector<size_t> particleIds;
+    bool reordered;
+    uint64_t nextPersistentId;
+    double parameters[13];
+    uint64_t particles, numberOfScalars, numberOfVectors;
+
+    // Everything is read into temporaries and checked against the registered attributes, so
+    // a stream that ends early or belongs to another system leaves this one untouched.
+    if (!readBinary(stream, particles) || !readBinary(stream, numberOfScalars) ||
+        numberOfScalars != scalarNames.size()) {
+        return false;
+    }
+    for (size_t k = 0; k < scalarNames.size(); k++) {
+        std::string name;
+        if (!readBinary(stream, name, scalarNames[k].size()) || name != scalarNames[k] ||
+            !readBinary(stream, scalars[k], particles) || scalars[k].size() != particles) {
+            return false;
+        }
+    }
+
+    if (!readBinary(stream, numberOfVectors) || numberOfVectors != vectorNames.size()) {
+        return false;
+    }
+    for (size_t k = 0; k < vectorNames.size(); k++) {
+        std::string name;
+        if (!readBinary(stream, name, vectorNames[k].size()) || name != vectorNames[k] ||
+            !readBinary(stream, vectors[k], particles) || vectors[k].size() != particles) {
+            return false;
+        }
+    }
+
+    if (!readBinary(stream, particleIds, particles) || particleIds.size() != particles ||
+        !readBinary(stream, reordered) || !readBinary(stream, nextPersistentId)) {
+        return false;
+    }
+
+    std::vector<size_t> particleSlots(particles, particles);
+    for (size_t k = 0; k < particles; k++) {
+        if (particleIds[k] >= particles || particleSlots[particleIds[k]] != particles) {
+            return false;
+        }
+        particleSlots[particleIds[k]] = k;
+    }
+
+    for (double& parameter : parameters) {
+        if (!readBinary(stream, parameter)) {
+            return false;
+        }
+    }
+
+    numberOfParticles = particles;
+    _attributes.resize(numberOfParticles);
+    for (size_t k = 0; k < scalarNames.size(); k++) {
+        _attributes.getScalarAttribute(scalarNames[k]).swap(scalars[k]);
+    }
+    for (size_t k = 0; k < vectorNames.size(); k++) {
+        _attributes.getVectorAttribute(vectorNames[k]).swap(vectors[k]);
+    }
+
+    _particleIds.swap(particleIds);
+    _particleSlots.swap(particleSlots);
+    _reordered = reordered;
+    _nextPersistentId = nextPersistentId;
+    _neighborhood->invalidate();
+
+    double *parameter = parameters;
+    for (double *member : {&_kernelFactor, &_kernelFactorNorm, &_stiffness, &_stiffnessAtProximity,
+        &_linearViscosity, &_quadraticViscosity, &_surfaceTension, &_kernelRadius, &_kernelRadiusSquared,
+        &_mass, &_viscosityConstant, &_particleRadius, &_restDensity}) {
+        *member = *parameter++;
+    }
+
+    return true;
 }
\ No newline at end of file
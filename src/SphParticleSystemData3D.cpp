@@ -0,0 +1,96 @@
+/**
+ * @file SphParticleSystemData3D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the particle system data for 3D SPH simulators.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/SphParticleSystemData3D.h"
+#include "../include/SphSolverCore.h"
+
+SphParticleSystemData3D::SphParticleSystemData3D() :
+    _neighborhood(std::make_shared<CellListNeighborhood3D>()),
+    _positions(_attributes.addVectorAttribute("positions")),
+    _velocities(_attributes.addVectorAttribute("velocities")),
+    _forces(_attributes.addVectorAttribute("forces")),
+    _densities(_attributes.addScalarAttribute("densities")),
+    _pressures(_attributes.addScalarAttribute("pressures")) {
+    _neighborhood->setSortByIndex(true);
+}
+
+SphParticleSystemData3D::~SphParticleSystemData3D() {}
+
+void SphParticleSystemData3D::addParticle(Eigen::Vector3d position) {
+    _attributes.addParticle();
+    _positions.back() = position;
+    numberOfParticles++;
+}
+
+void SphParticleSystemData3D::reserve(size_t size) {
+    _attributes.reserve(size);
+}
+
+void SphParticleSystemData3D::computeDensityPressure() {
+    SphSolverCore3D<double> core(_kernelRadius, _mass, _viscosityConstant);
+    core.computeDensityPressure(*_neighborhood, _positions, _densities, _pressures);
+}
+
+std::vector<Eigen::Vector3d>& SphParticleSystemData3D::getPositions() {
+    return _positions;
+}
+
+std::vector<Eigen::Vector3d>& SphParticleSystemData3D::getVelocities() {
+    return _velocities;
+}
+
+std::vector<Eigen::Vector3d>& SphParticleSystemData3D::getForces() {
+    return _forces;
+}
+
+std::vector<double>& SphParticleSystemData3D::getDensities() {
+    return _densities;
+}
+
+std::vector<double>& SphParticleSystemData3D::getPressures() {
+    return _pressures;
+}
+
+double SphParticleSystemData3D::getKernelRadius() {
+    return _kernelRadius;
+}
+
+double SphParticleSystemData3D::getMass() {
+    return _mass;
+}
+
+void SphParticleSystemData3D::setMass(double newMass) {
+    _mass = newMass;
+}
+
+double SphParticleSystemData3D::getViscosityConstant() {
+    return _viscosityConstant;
+}
+
+void SphParticleSystemData3D::setViscosityConstant(double newViscosityConstant) {
+    _viscosityConstant = newViscosityConstant;
+}
+
+double SphParticleSystemData3D::getParticleRadius() {
+    return _particleRadius;
+}
+
+CellListNeighborhood3DPtr SphParticleSystemData3D::getNeighborhood() {
+    return _neighborhood;
+}
+
+void SphParticleSystemData3D::buildNeighborhood() {
+    _neighborhood->build(_positions);
+}
+
+ParticleAttributes3D& SphParticleSystemData3D::getAttributes() {
+    return _attributes;
+}
\ No newline at end of file
@@ -10,12 +10,19 @@
  */
 
 #include "../include/Constants.h"
-#include "../include/SphKernels.h"
+#include "../include/SphSolverCore2D.h"
 #include "../include/SphSolver2D.h"
+#include "../include/VerletNeighborhood2D.h"
+#include "../include/BinarySerialization.h"
 #include <eigen3/Eigen/Dense>
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 
 SphSolver2D::SphSolver2D(std::string fileName) {
     _boundaries.push_back(Eigen::Vector3d(1, 0, 0));
@@ -32,7 +39,7 @@ SphSolver2D::SphSolver2D(std::string fileName) {
 
 SphSolver2D::~SphSolver2D() {}
 
-SphSolver2D::SphSolver2D(int numberOfParticles, std::string fileName) {
+SphSolver2D::SphSolver2D(int numberOfParticles, std::string fileName, NeighborhoodType neighborhoodType) {
     _boundaryDumping = 1.0;
     _fileName = fileName;
     
@@ -45,48 +52,484 @@ SphSolver2D::SphSolver2D(int numberOfParticles, std::string fileName) {
 	_boundaries.push_back(Eigen::Vector3d(-1, 0, -_viewWidth));
 	_boundaries.push_back(Eigen::Vector3d(0, -1, -_viewHeight));
 
-    _particleSystemData = std::make_shared<SphParticleSystemData2D>(); 
+    _particleSystemData = std::make_shared<SphParticleSystemData2D>(neighborhoodType); 
     double kernelRadius = _particleSystemData->getKernelRadius();
     int count = 0;
 
     _pointSize = getKernelRadius() / 2.0;
 
-	for (double y = kernelRadius; y < _viewHeight - kernelRadius * 2.f; y += kernelRadius) {
-		for (double x = _viewWidth / 4; x <= _viewWidth / 2; x += kernelRadius) {
-            if (count == numberOfParticles) {
-                return;
-            }
-
+	for (double y = kernelRadius; y < _viewHeight - kernelRadius * 2.f && count < numberOfParticles; y += kernelRadius) {
+		for (double x = _viewWidth / 4; x <= _viewWidth / 2 && count < numberOfParticles; x += kernelRadius) {
             float jitter = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
             Eigen::Vector2d position = Eigen::Vector2d(x + jitter, y + jitter);
             addParticle(position);
             count++;
 		}
 	}
+
+    _particleSystemData->getNeighborhood()->setGridResolution(_viewWidth, _viewHeight, kernelRadius);
+    _particleSystemData->buildNeighborhood();
 }
 
 void SphSolver2D::addParticle(Eigen::Vector2d positon) {
+    synchronizeMixed();
     _particleSystemData->addParticle(positon);
 }
 
-std::vector<Eigen::Vector2d>& SphSolver2D::getPositions() {
-    return _particleSystemData->getPositions(); 
+const std::vector<Eigen::Vector2d>& SphSolver2D::getPositions() {
+    if (!_particleSystemData->isReordered()) {
+        return _particleSystemData->getPositions(); 
+    }
+
+    _particleSystemData->toIdOrder(_particleSystemData->getPositions(), _positionsInIdOrder);
+    return _positionsInIdOrder;
+}
+
+SphParticleSystemData2DPtr SphSolver2D::getParticleSystemData() {
+    // The caller may change the attributes, so the mixed precision steps load them again.
+    synchronizeMixed();
+    _mixedParticles = -1;
+    return _particleSystemData;
+}
+
+bool SphSolver2D::setReorderInterval(int reorderInterval) {
+    _reorderInterval = reorderInterval;
+    _updatesSinceReorder = 0;
+    return true;
+}
+
+void SphSolver2D::setLoopSchedule(LoopSchedule schedule, int chunkSize) {
+    _loopSchedule = schedule;
+    _loopChunkSize = chunkSize;
+}
+
+bool SphSolver2D::setPrecision(SolverPrecision precision) {
+    synchronizeMixed();
+    _mixedParticles = -1;
+    _precision = precision;
+    return true;
+}
+
+void SphSolver2D::setDeterministic(bool deterministic) {
+    _deterministic = deterministic;
+}
+
+bool SphSolver2D::isDeterministic() {
+    return _deterministic;
+}
+
+void SphSolver2D::setVerletSkin(double skin) {
+    ParticleNeighborhood2DPtr neighborhood = _particleSystemData->getNeighborhood();
+    VerletNeighborhood2DPtr verletNeighborhood = std::dynamic_pointer_cast<VerletNeighborhood2D>(neighborhood);
+
+    if (verletNeighborhood) {
+        neighborhood = verletNeighborhood->getNeighborhood();
+    }
+
+    if (skin > 0.0) {
+        neighborhood = std::make_shared<VerletNeighborhood2D>(neighborhood, skin);
+    }
+
+    neighborhood->setGridResolution(_viewWidth, _viewHeight, getKernelRadius());
+    _particleSystemData->setNeighborhood(neighborhood);
+    _particleSystemData->buildNeighborhood();
+}
+
+bool SphSolver2D::addEmitter(ParticleEmitter2DPtr emitter) {
+    _emitters.push_back(emitter);
+    return true;
+}
+
+bool SphSolver2D::addSink(ParticleSink2DPtr sink) {
+    _sinks.push_back(sink);
+    return true;
+}
+
+bool SphSolver2D::addCollider(SdfCollider2DPtr collider) {
+    if (!collider || !collider->isValid()) {
+        return false;
+    }
+
+    _colliders.push_back(collider);
+    _colliderCellSize = 0.0;
+    return true;
+}
+
+void SphSolver2D::applyEmittersAndSinks() {
+    if (_emitters.empty() && _sinks.empty()) {
+        return;
+    }
+
+    synchronizeMixed();
+    _mixedParticles = -1;
+
+    for (ParticleEmitter2DPtr& emitter : _emitters) {
+        emitter->emit(*_particleSystemData, getTimeStepSize());
+    }
+
+    for (ParticleSink2DPtr& sink : _sinks) {
+        sink->absorb(*_particleSystemData);
+    }
+}
+
+LoopScheduleScope SphSolver2D::applyLoopSchedule() {
+    omp_sched_t kind = omp_sched_static;
+
+    if (_loopSchedule == LoopSchedule::Dynamic) {
+        kind = omp_sched_dynamic;
+    } else if (_loopSchedule == LoopSchedule::Guided) {
+        kind = omp_sched_guided;
+    }
+
+    return LoopScheduleScope(kind, _loopChunkSize);
+}
+
+void SphSolver2D::reorderParticles() {
+    if (_reorderInterval <= 0) {
+        return;
+    }
+
+    if (++_updatesSinceReorder >= _reorderInterval) {
+        synchronizeMixed();
+        _mixedParticles = -1;
+        _particleSystemData->sortParticles();
+        _updatesSinceReorder = 0;
+    }
+}
+
+bool SphSolver2D::isReorderDue() {
+    return _reorderInterval > 0 && _updatesSinceReorder + 1 >= _reorderInterval;
 }
 
 void SphSolver2D::update() {
-    _particleSystemData->computeDensityPressure();
+    PhaseTimer timer;
+
+    applyEmittersAndSinks();
+    timer.lap(_stats.timings.boundary);
+    LoopScheduleScope loopSchedule = applyLoopSchedule();
+    reorderParticles();
+    _particleSystemData->buildNeighborhood();
+    SPH_STATS(collectNeighborStats());
+    timer.lap(_stats.timings.neighborBuild);
+    if (_precision == SolverPrecision::Mixed) {
+        computeDensityPressureMixed();
+    } else {
+        _particleSystemData->computeDensityPressure();
+    }
+    SPH_STATS(collectDensityStats());
+    timer.lap(_stats.timings.densityPressure);
     computeForces();
+    timer.lap(_stats.timings.forces);
     integrate();
+    timer.lap(_stats.timings.integrate);
     enforceBoundary();
+    timer.lap(_stats.timings.boundary);
 
     if (_fileName != "") {
         writeToFile();
+        timer.lap(_stats.timings.output);
+    }
+
+    SPH_STATS(_stats.solverSteps++);
+    SPH_STATS(finishUpdateStats());
+}
+
+const SolverStats& SphSolver2D::getStats() {
+    return _stats;
+}
+
+void SphSolver2D::resetStats() {
+    _stats = SolverStats();
+    _tracedStats = SolverStats();
+}
+
+bool SphSolver2D::setStatsTraceFile(const std::string& fileName) {
+    if (_statsTrace.is_open()) {
+        _statsTrace.close();
+    }
+
+    if (fileName == "") {
+        return true;
+    }
+
+    if (!SOLVER_STATS_ENABLED) {
+        return false;
+    }
+
+    _statsTrace.open(fileName.c_str(), std::ios::out | std::ios::trunc);
+    _statsTrace << "update,neighbor_build,density_pressure,forces,integrate,boundary,output,"
+        << "average_neighbors,truncated_neighborhoods,neighbor_rebuilds,solver_steps,pressure_iterations,max_density_error\n";
+    _tracedStats = _stats;
+    return _statsTrace.good();
+}
+
+void SphSolver2D::collectNeighborStats() {
+    ParticleNeighborhood2DPtr neighborhood = _particleSystemData->getNeighborhood();
+    VerletNeighborhood2DPtr verletNeighborhood = std::dynamic_pointer_cast<VerletNeighborhood2D>(neighborhood);
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const size_t count = neighborhood->getNeighbors(i).size;
+
+        if (count >= _stats.neighborCounts.size()) {
+            _stats.neighborCounts.resize(count + 1, 0);
+        }
+        _stats.neighborCounts[count]++;
+    }
+
+    if (verletNeighborhood) {
+        _stats.neighborRebuilds += verletNeighborhood->getRebuildCount() - _verletRebuilds;
+        _verletRebuilds = verletNeighborhood->getRebuildCount();
+    } else {
+        _stats.neighborRebuilds++;
+    }
+
+    _stats.neighborBuilds++;
+    _stats.truncatedNeighborhoods += neighborhood->getTruncatedCount();
+}
+
+void SphSolver2D::collectDensityStats() {
+    const double restDensity = _particleSystemData->getRestDensity();
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    double maxDensityError = 0.0;
+
+    auto collect = [&](const auto& densities) {
+        #pragma omp parallel for reduction(max: maxDensityError)
+        for (int i = 0; i < numberOfParticles; i++) {
+            maxDensityError = std::max(maxDensityError, std::abs(densities[i] - restDensity) / restDensity);
+        }
+    };
+
+    if (_precision == SolverPrecision::Mixed) {
+        collect(_mixedDensities);
+    } else {
+        collect(_particleSystemData->getDensities());
+    }
+
+    _updateDensityError = std::max(_updateDensityError, maxDensityError);
+    _stats.maxDensityError = std::max(_stats.maxDensityError, maxDensityError);
+}
+
+void SphSolver2D::finishUpdateStats() {
+    _stats.timings.updates++;
+
+    if (_statsTrace.is_open()) {
+        const PhaseTimings& timings = _stats.timings;
+        const PhaseTimings& tracedTimings = _tracedStats.timings;
+        size_t particles = 0;
+        double neighbors = 0.0;
+
+        for (size_t count = 0; count < _stats.neighborCounts.size(); count++) {
+            const size_t traced = count < _tracedStats.neighborCounts.size() ? _tracedStats.neighborCounts[count] : 0;
+            particles += _stats.neighborCounts[count] - traced;
+            neighbors += (double) count * (_stats.neighborCounts[count] - traced);
+        }
+
+        _statsTrace << timings.updates << ","
+            << timings.neighborBuild - tracedTimings.neighborBuild << ","
+            << timings.densityPressure - tracedTimings.densityPressure << ","
+            << timings.forces - tracedTimings.forces << ","
+            << timings.integrate - tracedTimings.integrate << ","
+            << timings.boundary - tracedTimings.boundary << ","
+            << timings.output - tracedTimings.output << ","
+            << (particles > 0 ? neighbors / particles : 0.0) << ","
+            << _stats.truncatedNeighborhoods - _tracedStats.truncatedNeighborhoods << ","
+            << _stats.neighborRebuilds - _tracedStats.neighborRebuilds << ","
+            << _stats.solverSteps - _tracedStats.solverSteps << ","
+            << _stats.pressureIterations - _tracedStats.pressureIterations << ","
+            << _updateDensityError << "\n";
+        _tracedStats = _stats;
+    }
+
+    _updateDensityError = 0.0;
+}
+
+void SphSolver2D::setOutputFormat(OutputFormat outputFormat) {
+    _outputFormat = outputFormat;
+    _asyncSnapshotWriter.reset();
+    _snapshotWriter.reset();
+}
+
+bool SphSolver2D::setOutputSettings(const OutputSettings& outputSettings) {
+    const ParticleAttributes2D& attributes = _particleSystemData->getAttributes();
+
+    for (const std::string& name: outputSettings.fields) {
+        if (!attributes.hasScalarAttribute(name) && !attributes.hasVectorAttribute(name)) {
+            return false;
+        }
+    }
+
+    _outputSettings = outputSettings;
+    _outputSettings.interval = std::max(1, outputSettings.interval);
+    _updatesSinceOutputStart = 0;
+    _asyncSnapshotWriter.reset();
+    _snapshotWriter.reset();
+    return true;
+}
+
+void SphSolver2D::setAsyncOutput(int queueDepth, BackpressurePolicy policy) {
+    _outputQueueDepth = queueDepth;
+    _outputPolicy = policy;
+    _asyncSnapshotWriter.reset();
+    _snapshotWriter.reset();
+}
+
+void SphSolver2D::closeOutput() {
+    _asyncSnapshotWriter.reset();
+    _snapshotWriter.reset();
+}
+
+double SphSolver2D::getTimeStepSize() {
+    return _timeStepSizeInSeconds;
+}
+
+/**
+ * @brief Magic bytes at the start of every checkpoint file.
+ * 
+ */
+static const std::string CHECKPOINT_MAGIC = "SPHCKPT1";
+
+bool SphSolver2D::saveCheckpoint(const std::string& fileName) {
+    synchronizeMixed();
+    std::ofstream file(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    writeBinary(file, CHECKPOINT_MAGIC);
+    writeBinary(file, getCheckpointName());
+    _particleSystemData->writeState(file);
+    writeState(file);
+    file.close();
+    return file.good();
+}
+
+bool SphSolver2D::loadCheckpoint(const std::string& fileName) {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    std::string magic, name;
+
+    if (!file.is_open() || !readBinary(file, magic) || magic != CHECKPOINT_MAGIC ||
+        !readBinary(file, name) || name != getCheckpointName()) {
+        return false;
+    }
+
+    // The solver parameters are read straight into the members, so the current state is
+    // kept in memory and restored when the file ends early or does not match.
+    synchronizeMixed();
+    std::stringstream backup(std::ios::in | std::ios::out | std::ios::binary);
+    _particleSystemData->writeState(backup);
+    writeState(backup);
+
+    if (!_particleSystemData->readState(file) || !readState(file)) {
+        _particleSystemData->readState(backup);
+        readState(backup);
+        return false;
+    }
+
+    _particleSystemData->getNeighborhood()->setGridResolution(_viewWidth, _viewHeight, getKernelRadius());
+    _particleSystemData->buildNeighborhood();
+    return true;
+}
+
+std::string SphSolver2D::getCheckpointName() {
+    return "SphSolver2D";
+}
+
+void SphSolver2D::writeState(std::ostream& stream) {
+    writeBinary(stream, _timeStepSizeInSeconds);
+    writeBinary(stream, _boundaryDumping);
+    writeBinary(stream, _viewWidth);
+    writeBinary(stream, _viewHeight);
+    writeBinary(stream, _boundaries);
+    writeBinary(stream, _reorderInterval);
+    writeBinary(stream, _updatesSinceReorder);
+    writeBinary(stream, _precision);
+}
+
+bool SphSolver2D::readState(std::istream& stream) {
+    _mixedParticles = -1;
+    return readBinary(stream, _timeStepSizeInSeconds) && readBinary(stream, _boundaryDumping) &&
+        readBinary(stream, _viewWidth) && readBinary(stream, _viewHeight) &&
+        readBinary(stream, _boundaries) && readBinary(stream, _reorderInterval) &&
+        readBinary(stream, _updatesSinceReorder) && readBinary(stream, _precision);
+}
+
+void SphSolver2D::writeSnapshot() {
+    synchronizeMixed();
+    ParticleAttributes2D& attributes = _particleSystemData->getAttributes();
+    const size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    const size_t numberOfFields = _outputSettings.fields.size();
+    std::vector<const double *> values(numberOfFields);
+
+    if (!_snapshotWriter) {
+        std::vector<SnapshotField> fields;
+        for (const std::string& name: _outputSettings.fields) {
+            fields.push_back({name, attributes.hasVectorAttribute(name) ? 2u : 1u});
+        }
+
+        const bool ids = _outputSettings.ids || !_emitters.empty() || !_sinks.empty();
+        _snapshotWriter = std::make_shared<SnapshotWriter>(_fileName, numberOfParticles,
+            getTimeStepSize() * _outputSettings.interval, fields, _outputSettings.precision,
+            _outputSettings.compression, _outputSettings.keyframeInterval, ids);
+
+        if (_outputQueueDepth > 0) {
+            _asyncSnapshotWriter = std::make_shared<AsyncSnapshotWriter>(_snapshotWriter,
+                _outputQueueDepth, _outputPolicy);
+        }
+
+        _outputVectors.resize(numberOfFields);
+        _outputScalars.resize(numberOfFields);
+    }
+
+    // Files with ids take the particles in storage order, since each one is found by its
+    // id. Otherwise the particles are written in id order, so each keeps its index while
+    // they are sorted.
+    const bool ids = _snapshotWriter->storesIds();
+    const bool reordered = !ids && _particleSystemData->isReordered();
+
+    if (ids) {
+        const std::vector<double>& persistentIds = _particleSystemData->getPersistentIds();
+        _outputIds.assign(persistentIds.begin(), persistentIds.end());
+    }
+
+    for (size_t field = 0; field < numberOfFields; field++) {
+        const std::string& name = _outputSettings.fields[field];
+
+        if (attributes.hasVectorAttribute(name)) {
+            std::vector<Eigen::Vector2d>& vectors = attributes.getVectorAttribute(name);
+            if (reordered) {
+                _particleSystemData->toIdOrder(vectors, _outputVectors[field]);
+            }
+            values[field] = flatData(reordered ? _outputVectors[field] : vectors);
+        } else {
+            std::vector<double>& scalars = attributes.getScalarAttribute(name);
+            if (reordered) {
+                _particleSystemData->toIdOrder(scalars, _outputScalars[field]);
+            }
+            values[field] = reordered ? _outputScalars[field].data() : scalars.data();
+        }
+    }
+
+    const uint64_t *particleIds = ids ? _outputIds.data() : nullptr;
+    if (_asyncSnapshotWriter) {
+        _asyncSnapshotWriter->writeFrame(values, numberOfParticles, particleIds);
+    } else {
+        _snapshotWriter->writeFrame(values, numberOfParticles, particleIds);
     }
 }
 
 void SphSolver2D::writeToFile() {
 
-    auto& positions = _particleSystemData->getPositions();
+    if (_updatesSinceOutputStart++ % _outputSettings.interval != 0) {
+        return;
+    }
+
+    if (_outputFormat == OutputFormat::Binary) {
+        writeSnapshot();
+        return;
+    }
+
+    const std::vector<Eigen::Vector2d>& positions = getPositions();
 
 	for (int i = 0; i < positions.size(); ++i) {
         // Create an output string stream
@@ -113,79 +556,292 @@ void SphSolver2D::writeToFile() {
 	_csv.resetContent();
 }
 
-void SphSolver2D::computeForces() {
-    size_t numberOfParticles = _particleSystemData->numberOfParticles;
-    std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+void SphSolver2D::uploadMixed() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+    const std::vector<Eigen::Vector2d>& velocities = _particleSystemData->getVelocities();
+    const std::vector<Eigen::Vector2d>& forces = _particleSystemData->getForces();
+    const std::vector<double>& densities = _particleSystemData->getDensities();
+    const std::vector<double>& pressures = _particleSystemData->getPressures();
+
+    _mixedPositions.resize(numberOfParticles);
+    _mixedVelocities.resize(numberOfParticles);
+    _mixedForces.resize(numberOfParticles);
+    _mixedDensities.resize(numberOfParticles);
+    _mixedPressures.resize(numberOfParticles);
+
+    #pragma omp parallel for
+    for (int i = 0; i < numberOfParticles; i++) {
+        _mixedPositions[i] = positions[i].cast<float>();
+        _mixedVelocities[i] = velocities[i].cast<float>();
+        _mixedForces[i] = forces[i].cast<float>();
+        _mixedDensities[i] = densities[i];
+        _mixedPressures[i] = pressures[i];
+    }
+
+    _mixedParticles = numberOfParticles;
+}
+
+void SphSolver2D::synchronizeMixed() {
+    if (_mixedStateOnHost) {
+        return;
+    }
+
+    const int numberOfParticles = _mixedParticles;
     std::vector<Eigen::Vector2d>& velocities = _particleSystemData->getVelocities();
     std::vector<Eigen::Vector2d>& forces = _particleSystemData->getForces();
-    std::vector<double>& pressures = _particleSystemData->getPressures();
     std::vector<double>& densities = _particleSystemData->getDensities();
-    double kernelRadius = _particleSystemData->getKernelRadius();
-    double mass = _particleSystemData->getMass();
-    double viscosityConstant = _particleSystemData->getViscosityConstant();
-    SphViscosityKernel viscosityKernel(kernelRadius);
-    SphSpikyKernel spikyKernel(kernelRadius);
+    std::vector<double>& pressures = _particleSystemData->getPressures();
 
-    // #pragma omp parallel for
-    for (size_t i = 0; i < numberOfParticles; i++) {
-        Eigen::Vector2d fpress(0.0, 0.0);
-        Eigen::Vector2d fvisc(0.0, 0.0);
-
-        for (size_t j = 0; j < numberOfParticles; j++) {
-			if (i == j) {
-				continue;
-			}
-            
-			Eigen::Vector2d resultingVector = positions[j] - positions[i];
-			float distance = resultingVector.norm();
-
-            if (distance < kernelRadius) {
-				// compute pressure force contribution
-				fpress += -resultingVector.normalized() * mass * (pressures[i] + pressures[j]) / 
-                            (2.0 * densities[j]) * spikyKernel.gradientAt(kernelRadius - distance);
-				// compute viscosity force contribution
-				fvisc += viscosityConstant * mass * (velocities[j] - velocities[i]) / 
-                            densities[j] * viscosityKernel.laplacianAt(kernelRadius - distance);
-			}
-		}
+    // The positions were already widened by the last update.
+    #pragma omp parallel for
+    for (int i = 0; i < numberOfParticles; i++) {
+        velocities[i] = _mixedVelocities[i].cast<double>();
+        forces[i] = _mixedForces[i].cast<double>();
+        densities[i] = _mixedDensities[i];
+        pressures[i] = _mixedPressures[i];
+    }
 
-        Eigen::Vector2d fgrav = G2D * mass / densities[i];
-		forces[i] = fpress + fvisc + fgrav;
-	}
+    _mixedStateOnHost = true;
 }
 
-void SphSolver2D::enforceBoundary() {
-    size_t numberOfParticles = _particleSystemData->numberOfParticles;
-    std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
-    std::vector<Eigen::Vector2d>& velocities = _particleSystemData->getVelocities();
-    double particleRadius = _particleSystemData->getParticleRadius();
-    
+void SphSolver2D::computeDensityPressureMixed() {
+    SphSolverCore2D<float, double> core(_particleSystemData->getKernelRadius(),
+        _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+    if (_mixedParticles != (int) _particleSystemData->numberOfParticles) {
+        uploadMixed();
+    }
+
+    core.computeDensityPressure(*_particleSystemData->getNeighborhood(), _mixedPositions,
+        _mixedDensities, _mixedPressures);
+    _mixedStateOnHost = false;
+}
+
+void SphSolver2D::computeForces() {
+    if (_precision == SolverPrecision::Mixed) {
+        SphSolverCore2D<float, double> core(_particleSystemData->getKernelRadius(),
+            _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+        core.computeForces(*_particleSystemData->getNeighborhood(), _mixedPositions, _mixedVelocities,
+            _mixedDensities, _mixedPressures, _mixedForces);
+        return;
+    }
+
+    SphSolverCore2D<double> core(_particleSystemData->getKernelRadius(),
+        _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+    core.computeForces(*_particleSystemData->getNeighborhood(),
+        _particleSystemData->getPositions(), _particleSystemData->getVelocities(),
+        _particleSystemData->getDensities(), _particleSystemData->getPressures(),
+        _particleSystemData->getForces());
+}
+
+/**
+ * @brief Pushes the particles out of the walls, in the precision of the attributes.
+ * 
+ * @tparam Scalar: type of the components of the positions and velocities.
+ * @param numberOfParticles: Number of particles.
+ * @param positions: The positions, laid out as x0, y0, x1, y1, ...
+ * @param velocities: The velocities, laid out as the positions.
+ * @param particleRadius: Radius of the particles.
+ * @param timeStepSize: Size of the time step.
+ * @param boundaryDumping: Factor applied to the velocities pushed out of a wall.
+ * @param numberOfBoundaries: Number of walls.
+ * @param boundaries: The normal and offset of each wall.
+ */
+template <typename Scalar>
+static void enforceWalls(int numberOfParticles, const Scalar *positions, Scalar *velocities, double particleRadius,
+    double timeStepSize, double boundaryDumping, int numberOfBoundaries, const double *boundaries) {
+    const int blockSize = 256;
+    const int numberOfBlocks = (numberOfParticles + blockSize - 1) / blockSize;
+
+    // Each block is split into contiguous components, so the loop over the particles of a wall
+    // vectorizes, and every particle still meets the walls in order, as in a scalar loop
     #pragma omp parallel for
-	for (size_t i = 0; i < numberOfParticles; i++) {
-		for (auto b : _boundaries) {
-			double d = positions[i](0) * b(0) + positions[i](1) * b(1) - b(2);
-			if ((d = std::max(0., d)) < particleRadius){
-				velocities[i] += (particleRadius - d) * b.segment<2>(0) / _timeStepSizeInSeconds;
-                velocities[i] *= _boundaryDumping;
+    for (int block = 0; block < numberOfBlocks; block++) {
+        const int start = block * blockSize;
+        const int count = std::min(numberOfParticles, start + blockSize) - start;
+        Scalar positionsX[blockSize], positionsY[blockSize];
+        Scalar velocitiesX[blockSize], velocitiesY[blockSize];
+
+        for (int i = 0; i < count; i++) {
+            positionsX[i] = positions[2 * (start + i)];
+            positionsY[i] = positions[2 * (start + i) + 1];
+            velocitiesX[i] = velocities[2 * (start + i)];
+            velocitiesY[i] = velocities[2 * (start + i) + 1];
+        }
+
+        for (int b = 0; b < numberOfBoundaries; b++) {
+            const double normalX = boundaries[3 * b];
+            const double normalY = boundaries[3 * b + 1];
+            const double offset = boundaries[3 * b + 2];
+
+            #pragma omp simd
+            for (int i = 0; i < count; i++) {
+                const double distance = positionsX[i] * normalX + positionsY[i] * normalY - offset;
+                const double d = distance > 0. ? distance : 0.;
+                const Scalar pushedX = (velocitiesX[i] + (particleRadius - d) * normalX / timeStepSize) * boundaryDumping;
+                const Scalar pushedY = (velocitiesY[i] + (particleRadius - d) * normalY / timeStepSize) * boundaryDumping;
+                velocitiesX[i] = d < particleRadius ? pushedX : velocitiesX[i];
+                velocitiesY[i] = d < particleRadius ? pushedY : velocitiesY[i];
             }
-		}
+        }
+
+        for (int i = 0; i < count; i++) {
+            velocities[2 * (start + i)] = velocitiesX[i];
+            velocities[2 * (start + i) + 1] = velocitiesY[i];
+        }
     }
 }
 
-void SphSolver2D::integrate() {
-    size_t numberOfParticles = _particleSystemData->numberOfParticles;
-    std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
-    std::vector<Eigen::Vector2d>& velocities = _particleSystemData->getVelocities();
-    std::vector<Eigen::Vector2d>& forces = _particleSystemData->getForces();
-    std::vector<double>& densities = _particleSystemData->getDensities();
-    std::vector<double>& pressures = _particleSystemData->getPressures();
-    double kernelRadius = _particleSystemData->getKernelRadius(); 
+void SphSolver2D::enforceBoundary() {
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const double particleRadius = _particleSystemData->getParticleRadius();
+    const int numberOfBoundaries = _boundaries.size();
+    const double *boundaries = _boundaries.data()->data();
+
+    if (_precision == SolverPrecision::Mixed) {
+        enforceWalls(numberOfParticles, _mixedPositions.data()->data(), _mixedVelocities.data()->data(),
+            particleRadius, _timeStepSizeInSeconds, _boundaryDumping, numberOfBoundaries, boundaries);
+    } else {
+        enforceWalls(numberOfParticles, flatData(_particleSystemData->getPositions()),
+            flatData(_particleSystemData->getVelocities()), particleRadius, _timeStepSizeInSeconds,
+            _boundaryDumping, numberOfBoundaries, boundaries);
+    }
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < numberOfParticles; i++) {
-        velocities[i] += (forces[i] / densities[i]) * _timeStepSizeInSeconds;
-        positions[i] += velocities[i] * _timeStepSizeInSeconds;
+    applyColliders();
+}
+
+void SphSolver2D::buildColliderCells() {
+    _colliderCellSize = getKernelRadius();
+    _colliderGridWidth = std::max(1, (int) std::ceil(_viewWidth / _colliderCellSize));
+    _colliderGridHeight = std::max(1, (int) std::ceil(_viewHeight / _colliderCellSize));
+    _colliderCellStarts.assign((size_t) _colliderGridWidth * _colliderGridHeight + 1, 0);
+
+    auto cellRange = [&](const SdfCollider2DPtr& collider, int& minX, int& minY, int& maxX, int& maxY) {
+        minX = std::clamp((int) std::floor(collider->getMin()(0) / _colliderCellSize), 0, _colliderGridWidth - 1);
+        minY = std::clamp((int) std::floor(collider->getMin()(1) / _colliderCellSize), 0, _colliderGridHeight - 1);
+        maxX = std::clamp((int) std::floor(collider->getMax()(0) / _colliderCellSize), 0, _colliderGridWidth - 1);
+        maxY = std::clamp((int) std::floor(collider->getMax()(1) / _colliderCellSize), 0, _colliderGridHeight - 1);
+    };
+
+    int minX, minY, maxX, maxY;
+    for (const SdfCollider2DPtr& collider : _colliders) {
+        cellRange(collider, minX, minY, maxX, maxY);
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                _colliderCellStarts[(size_t) y * _colliderGridWidth + x + 1]++;
+            }
+        }
     }
+
+    for (size_t cell = 1; cell < _colliderCellStarts.size(); cell++) {
+        _colliderCellStarts[cell] += _colliderCellStarts[cell - 1];
+    }
+
+    std::vector<int> next(_colliderCellStarts.begin(), _colliderCellStarts.end() - 1);
+    _colliderCellIndices.resize(_colliderCellStarts.back());
+    for (size_t c = 0; c < _colliders.size(); c++) {
+        cellRange(_colliders[c], minX, minY, maxX, maxY);
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                _colliderCellIndices[next[(size_t) y * _colliderGridWidth + x]++] = c;
+            }
+        }
+    }
+}
+
+bool SphSolver2D::prepareColliders() {
+    if (_colliders.empty()) {
+        return false;
+    }
+
+    if (_colliderCellSize != getKernelRadius()) {
+        buildColliderCells();
+    }
+    return true;
+}
+
+Eigen::Vector2d SphSolver2D::pushOutOfColliders(Eigen::Vector2d position) {
+    const int x = std::clamp((int) std::floor(position(0) / _colliderCellSize), 0, _colliderGridWidth - 1);
+    const int y = std::clamp((int) std::floor(position(1) / _colliderCellSize), 0, _colliderGridHeight - 1);
+    const size_t cell = (size_t) y * _colliderGridWidth + x;
+
+    for (int k = _colliderCellStarts[cell]; k < _colliderCellStarts[cell + 1]; k++) {
+        double d;
+        Eigen::Vector2d normal;
+
+        if (_colliders[_colliderCellIndices[k]]->lookup(position, d, normal) && d < 0.0) {
+            position -= d * normal;
+        }
+    }
+
+    return position;
+}
+
+void SphSolver2D::applyColliders() {
+    if (!prepareColliders()) {
+        return;
+    }
+
+    const int numberOfParticles = _particleSystemData->numberOfParticles;
+    const double particleRadius = _particleSystemData->getParticleRadius();
+
+    // The colliders are looked up in double precision, in either precision of the attributes.
+    auto push = [&](const auto& positions, auto& velocities) {
+        using Scalar = typename std::decay_t<decltype(velocities)>::value_type::Scalar;
+
+        #pragma omp parallel for
+        for (int i = 0; i < numberOfParticles; i++) {
+            const Eigen::Vector2d position = positions[i].template cast<double>();
+            const int x = std::clamp((int) std::floor(position(0) / _colliderCellSize), 0, _colliderGridWidth - 1);
+            const int y = std::clamp((int) std::floor(position(1) / _colliderCellSize), 0, _colliderGridHeight - 1);
+            const size_t cell = (size_t) y * _colliderGridWidth + x;
+
+            for (int k = _colliderCellStarts[cell]; k < _colliderCellStarts[cell + 1]; k++) {
+                double d;
+                Eigen::Vector2d normal;
+
+                if (_colliders[_colliderCellIndices[k]]->lookup(position, d, normal) &&
+                    (d = std::max(0., d)) < particleRadius) {
+                    velocities[i] += ((particleRadius - d) * normal / _timeStepSizeInSeconds).template cast<Scalar>();
+                    velocities[i] *= static_cast<Scalar>(_boundaryDumping);
+                }
+            }
+        }
+    };
+
+    if (_precision == SolverPrecision::Mixed) {
+        push(_mixedPositions, _mixedVelocities);
+    } else {
+        push(_particleSystemData->getPositions(), _particleSystemData->getVelocities());
+    }
+}
+
+void SphSolver2D::integrate() {
+    if (_precision == SolverPrecision::Mixed) {
+        const int numberOfParticles = _particleSystemData->numberOfParticles;
+        std::vector<Eigen::Vector2d>& positions = _particleSystemData->getPositions();
+        SphSolverCore2D<float, double> core(_particleSystemData->getKernelRadius(),
+            _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+        core.integrate(_mixedPositions, _mixedVelocities, _mixedForces, _mixedDensities,
+            _timeStepSizeInSeconds);
+
+        // Only the positions are widened, since the neighborhoods are built from them.
+        #pragma omp parallel for
+        for (int i = 0; i < numberOfParticles; i++) {
+            positions[i] = _mixedPositions[i].cast<double>();
+        }
+        return;
+    }
+
+    SphSolverCore2D<double> core(_particleSystemData->getKernelRadius(),
+        _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+    core.integrate(_particleSystemData->getPositions(), _particleSystemData->getVelocities(),
+        _particleSystemData->getForces(), _particleSystemData->getDensities(), _timeStepSizeInSeconds);
 }
 
 double SphSolver2D::getKernelRadius() {
@@ -0,0 +1,157 @@
+/**
+ * @file SphSolver3D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the base SPH solver for 3D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/SphSolver3D.h"
+#include "../include/SphSolverCore.h"
+#include <algorithm>
+
+SphSolver3D::SphSolver3D(int numberOfParticles, std::string fileName) {
+    _fileName = fileName;
+
+    _boundaries.push_back(Eigen::Vector4d(1, 0, 0, 0));
+    _boundaries.push_back(Eigen::Vector4d(0, 1, 0, 0));
+    _boundaries.push_back(Eigen::Vector4d(0, 0, 1, 0));
+    _boundaries.push_back(Eigen::Vector4d(-1, 0, 0, -_viewWidth));
+    _boundaries.push_back(Eigen::Vector4d(0, -1, 0, -_viewHeight));
+    _boundaries.push_back(Eigen::Vector4d(0, 0, -1, -_viewDepth));
+
+    _particleSystemData = std::make_shared<SphParticleSystemData3D>();
+    _particleSystemData->reserve(numberOfParticles);
+    double kernelRadius = _particleSystemData->getKernelRadius();
+    int count = 0;
+
+    for (double y = kernelRadius; y < _viewHeight - kernelRadius * 2.0 && count < numberOfParticles; y += kernelRadius) {
+        for (double x = _viewWidth / 4; x <= _viewWidth / 2 && count < numberOfParticles; x += kernelRadius) {
+            for (double z = _viewDepth / 4; z <= 3 * _viewDepth / 4 && count < numberOfParticles; z += kernelRadius) {
+                float jitter = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+                addParticle(Eigen::Vector3d(x + jitter, y + jitter, z + jitter));
+                count++;
+            }
+        }
+    }
+
+    _particleSystemData->getNeighborhood()->setGridResolution(
+        Eigen::Vector3d(_viewWidth, _viewHeight, _viewDepth), kernelRadius);
+    _particleSystemData->buildNeighborhood();
+}
+
+SphSolver3D::~SphSolver3D() {}
+
+void SphSolver3D::addParticle(Eigen::Vector3d position) {
+    _particleSystemData->addParticle(position);
+}
+
+std::vector<Eigen::Vector3d>& SphSolver3D::getPositions() {
+    return _particleSystemData->getPositions();
+}
+
+SphParticleSystemData3DPtr SphSolver3D::getParticleSystemData() {
+    return _particleSystemData;
+}
+
+double SphSolver3D::getTimeStepSize() {
+    return _timeStepSizeInSeconds;
+}
+
+const SolverStats& SphSolver3D::getStats() {
+    return _stats;
+}
+
+void SphSolver3D::resetStats() {
+    _stats = SolverStats();
+}
+
+void SphSolver3D::update() {
+    PhaseTimer timer;
+
+    _particleSystemData->buildNeighborhood();
+    SPH_STATS(_stats.neighborBuilds++);
+    SPH_STATS(_stats.neighborRebuilds++);
+    SPH_STATS(_stats.truncatedNeighborhoods += _particleSystemData->getNeighborhood()->getTruncatedCount());
+    timer.lap(_stats.timings.neighborBuild);
+    _particleSystemData->computeDensityPressure();
+    timer.lap(_stats.timings.densityPressure);
+    computeForces();
+    timer.lap(_stats.timings.forces);
+    integrate();
+    timer.lap(_stats.timings.integrate);
+    enforceBoundary();
+    timer.lap(_stats.timings.boundary);
+
+    if (_fileName != "") {
+        writeSnapshot();
+        timer.lap(_stats.timings.output);
+    }
+
+    SPH_STATS(_stats.solverSteps++);
+    SPH_STATS(_stats.timings.updates++);
+}
+
+void SphSolver3D::computeForces() {
+    SphSolverCore3D<double> core(_particleSystemData->getKernelRadius(),
+        _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+    core.computeForces(*_particleSystemData->getNeighborhood(),
+        _particleSystemData->getPositions(), _particleSystemData->getVelocities(),
+        _particleSystemData->getDensities(), _particleSystemData->getPressures(),
+        _particleSystemData->getForces());
+}
+
+void SphSolver3D::integrate() {
+    SphSolverCore3D<double> core(_particleSystemData->getKernelRadius(),
+        _particleSystemData->getMass(), _particleSystemData->getViscosityConstant());
+
+    core.integrate(_particleSystemData->getPositions(), _particleSystemData->getVelocities(),
+        _particleSystemData->getForces(), _particleSystemData->getDensities(), _timeStepSizeInSeconds);
+}
+
+void SphSolver3D::enforceBoundary() {
+    size_t numberOfParticles = _particleSystemData->numberOfParticles;
+    std::vector<Eigen::Vector3d>& positions = _particleSystemData->getPositions();
+    std::vector<Eigen::Vector3d>& velocities = _particleSystemData->getVelocities();
+    double particleRadius = _particleSystemData->getParticleRadius();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        for (const Eigen::Vector4d& b : _boundaries) {
+            double d = positions[i].dot(b.head<3>()) - b(3);
+            if ((d = std::max(0., d)) < particleRadius) {
+                velocities[i] += (particleRadius - d) * b.head<3>() / _timeStepSizeInSeconds;
+                velocities[i] *= _boundaryDumping;
+            }
+        }
+    }
+}
+
+void SphSolver3D::writeSnapshot() {
+    if (!_snapshotWriter) {
+        _snapshotWriter = std::make_shared<SnapshotWriter>(_fileName, _particleSystemData->numberOfParticles,
+            getTimeStepSize(), std::vector<SnapshotField>{{"positions", 3u}});
+    }
+
+    _snapshotWriter->writeFrame({flatData(_particleSystemData->getPositions())});
+}
+
+double SphSolver3D::getKernelRadius() {
+    return _particleSystemData->getKernelRadius();
+}
+
+double SphSolver3D::getViewWidth() {
+    return _viewWidth;
+}
+
+double SphSolver3D::getViewHeight() {
+    return _viewHeight;
+}
+
+double SphSolver3D::getViewDepth() {
+    return _viewDepth;
+}
\ No newline at end of file
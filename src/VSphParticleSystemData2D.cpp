@@ -10,37 +10,34 @@
  */
 
 #include "../include/VSphParticleSystemData2D.h"
-#include "../include/GridNeighborhood2D.h" 
 #include "../include/Constants.h"
 #include <memory>
 
-VSphParticleSystemData2D::VSphParticleSystemData2D() : SphParticleSystemData2D() {
+VSphParticleSystemData2D::VSphParticleSystemData2D(NeighborhoodType neighborhoodType) :
+    SphParticleSystemData2D(neighborhoodType) {
     _particleRadius = 0.03;
     _kernelRadius = 6.0 * _particleRadius;
     _kernelFactor = 20. / (2. * M_PI * _kernelRadius * _kernelRadius);
     _kernelFactorNorm = 30. / (2. * M_PI * _kernelRadius * _kernelRadius);
     _mass = 1.0;
 
-    _neighborhood = std::make_shared<GridNeighborhood2D>();
+    _neighborhood->setSortByIndex(false);
 }
 
 VSphParticleSystemData2D::~VSphParticleSystemData2D() {}
 
-void VSphParticleSystemData2D::addParticle(Eigen::Vector2d positon) {
-    SphParticleSystemData2D::addParticle(positon);
-    _projectedPositions.push_back(Eigen::Vector2d(0.0, 0.0));
-    _densityVariations.push_back(0.0);
-    _pressureVariations.push_back(0.0);
-    _lastPositions.push_back(positon);
-}
-
 void VSphParticleSystemData2D::computeDensityPressure() {
-    #pragma omp parallel for
+    if (_neighborhood->isHalfNeighborList()) {
+        computeDensityPressureSymmetric();
+        return;
+    }
+
+    #pragma omp parallel for schedule(runtime)
     for (int i = 0; i < numberOfParticles; i++) {
         _densities[i] = 0.0;
         _densityVariations[i] = 0.0;
 
-        _neighborhood->forEachNearbyPoint(i, 
+        _neighborhood->forEachNeighbor(i, 
             [&](int j, double distance) {
                 double a = 1. - distance / _kernelRadius;
                 _densities[i] += _mass * a * a * a * _kernelFactor;
@@ -51,4 +48,42 @@ void VSphParticleSystemData2D::computeDensityPressure() {
         _pressures[i] = _stiffness * (_densities[i] - _mass * ELASTIC_REST_DENSITY);
         _pressureVariations[i] = _stiffnessAtProximity * _densityVariations[i];
     }
+}
+
+void VSphParticleSystemData2D::computeDensityPressureSymmetric() {
+    _densityBuffers.reset(numberOfParticles, 0.0);
+    _densityVariationBuffers.reset(numberOfParticles, 0.0);
+
+    #pragma omp parallel
+    {
+        double *densities = _densityBuffers.buffer(omp_get_thread_num());
+        double *densityVariations = _densityVariationBuffers.buffer(omp_get_thread_num());
+
+        #pragma omp for schedule(runtime)
+        for (int i = 0; i < numberOfParticles; i++) {
+            _neighborhood->forEachNeighbor(i,
+                [&](int j, double distance) {
+                    double a = 1. - distance / _kernelRadius;
+                    double density = _mass * a * a * a * _kernelFactor;
+                    double densityVariation = _mass * a * a * a * a * _kernelFactorNorm;
+                    densities[i] += density;
+                    densities[j] += density;
+                    densityVariations[i] += densityVariation;
+                    densityVariations[j] += densityVariation;
+                }
+            );
+        }
+    }
+
+    #pragma omp parallel for
+    for (int i = 0; i < numberOfParticles; i++) {
+        _densities[i] = _densityBuffers.sum(i);
+        _densityVariations[i] = _densityVariationBuffers.sum(i);
+        _pressures[i] = _stiffness * (_densities[i] - _mass * ELASTIC_REST_DENSITY);
+        _pressureVariations[i] = _stiffnessAtProximity * _densityVariations[i];
+    }
+}
+
+double VSphParticleSystemData2D::getRestDensity() {
+    return _mass * ELASTIC_REST_DENSITY;
 }
\ No newline at end of file
@@ -13,13 +13,17 @@
 #include "../include/ParticleNeighborhood2D.h" 
 #include "../include/VSphParticleSystemData2D.h"
 #include "../include/Constants.h"
+#include "../include/BinarySerialization.h"
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 VSphSolver2D::VSphSolver2D() : SphSolver2D() {}
 
 VSphSolver2D::~VSphSolver2D() {}
 
-VSphSolver2D::VSphSolver2D(int numberOfParticles_, std::string fileName) : SphSolver2D(fileName) {
+VSphSolver2D::VSphSolver2D(int numberOfParticles_, std::string fileName, NeighborhoodType neighborhoodType) :
+    SphSolver2D(fileName) {
     _viewWidth = 12.5;
     _viewHeight = _windowHeight * _viewWidth / _windowWidth;
 
@@ -31,7 +35,7 @@ VSphSolver2D::VSphSolver2D(int numberOfParticles_, std::string fileName) : SphSo
     _timeStepSizeInSeconds = ((1.0 / _fps) / _solverSteps);
     _timeStepSizeInSecondsSquared = _timeStepSizeInSeconds * _timeStepSizeInSeconds;
 
-    _particleSystemData = std::make_shared<VSphParticleSystemData2D>();
+    _particleSystemData = std::make_shared<VSphParticleSystemData2D>(neighborhoodType);
 
     auto particleRadius = _particleSystemData->getParticleRadius();
     auto kernelRadius = _particleSystemData->getKernelRadius();
@@ -62,23 +66,26 @@ VSphSolver2D::VSphSolver2D(int numberOfParticles_, std::string fileName) : SphSo
 
 
 void VSphSolver2D::applyExternalForces() {
-    auto& velocities = _particleSystemData->getVelocities();
+    double *velocities = flatData(_particleSystemData->getVelocities());
+    const double gravity[2] = {_timeStepSizeInSeconds * G2D(0), _timeStepSizeInSeconds * G2D(1)};
+    const int numberOfComponents = 2 * _particleSystemData->numberOfParticles;
 
-    #pragma omp parallel for
-	for (int i = 0; i < _particleSystemData->numberOfParticles; i++) {
-		velocities[i] += _timeStepSizeInSeconds * G2D;
+    #pragma omp parallel for simd
+	for (int k = 0; k < numberOfComponents; k++) {
+		velocities[k] += gravity[k & 1];
 	}
 }
 
 void VSphSolver2D::integrate() {
-    auto& positions = _particleSystemData->getPositions();
-    auto& velocities = _particleSystemData->getVelocities();
-    auto& lastPositions = _particleSystemData->getLastPositions();
-
-    #pragma omp parallel for
-	for (int i = 0; i < _particleSystemData->numberOfParticles; i++) {
-		lastPositions[i] = positions[i];
-		positions[i] += _timeStepSizeInSeconds * velocities[i];
+    double *positions = flatData(_particleSystemData->getPositions());
+    const double *velocities = flatData(_particleSystemData->getVelocities());
+    double *lastPositions = flatData(_particleSystemData->getLastPositions());
+    const int numberOfComponents = 2 * _particleSystemData->numberOfParticles;
+
+    #pragma omp parallel for simd
+	for (int k = 0; k < numberOfComponents; k++) {
+		lastPositions[k] = positions[k];
+		positions[k] += _timeStepSizeInSeconds * velocities[k];
 	}
 }
 
@@ -100,13 +107,18 @@ void VSphSolver2D::project() {
     auto linearViscosity = _particleSystemData->getLinearViscosity();
     auto quadraticViscosity = _particleSystemData->getQuadraticViscosity();
 
-    #pragma omp parallel for
+    if (neighborhood->isHalfNeighborList()) {
+        projectSymmetric();
+        return;
+    }
+
+    #pragma omp parallel for schedule(runtime)
 	for (int i = 0; i < _particleSystemData->numberOfParticles; i++)
 	{
 		Eigen::Vector2d projectedPosition = positions[i];
         // auto distances = neighborhood->getDistances(i);
 
-        neighborhood->forEachNearbyPoint(i, 
+        neighborhood->forEachNeighbor(i, 
             [&](int j, double distance) {
                 double r = distance;
                 Eigen::Vector2d dx = positions[j] - positions[i];
@@ -138,34 +150,246 @@ void VSphSolver2D::project() {
 	}
 }
 
-void VSphSolver2D::correct() {
+void VSphSolver2D::projectSymmetric() {
     auto& positions = _particleSystemData->getPositions();
     auto& velocities = _particleSystemData->getVelocities();
+    auto& pressures = _particleSystemData->getPressures();
     auto& projectedPositions = _particleSystemData->getProjectedPositions();
-    auto& lastPositions = _particleSystemData->getLastPositions();
+    auto& pressureVariations = _particleSystemData->getPressureVariations();
+    auto kernelFactor = _particleSystemData->getKernelFactor();
+    auto kernelFactorNorm = _particleSystemData->getKernelFactorNorm();
+    auto neighborhood = _particleSystemData->getNeighborhood();
+    auto kernelRadius = _particleSystemData->getKernelRadius();
+    auto mass = _particleSystemData->getMass();
+    auto surfaceTension = _particleSystemData->getSurfaceTension();
+    auto linearViscosity = _particleSystemData->getLinearViscosity();
+    auto quadraticViscosity = _particleSystemData->getQuadraticViscosity();
+    int numberOfParticles = _particleSystemData->numberOfParticles;
+
+    _displacementBuffers.reset(numberOfParticles, Eigen::Vector2d(0.0, 0.0));
+
+    #pragma omp parallel
+    {
+        Eigen::Vector2d *displacements = _displacementBuffers.buffer(omp_get_thread_num());
+
+        #pragma omp for schedule(runtime)
+        for (int i = 0; i < numberOfParticles; i++) {
+            neighborhood->forEachNeighbor(i,
+                [&](int j, double distance) {
+                    double r = distance;
+                    Eigen::Vector2d dx = positions[j] - positions[i];
+
+                    double a = 1. - r / kernelRadius;
+                    double d = _timeStepSizeInSecondsSquared *
+                                 ((pressureVariations[i] + pressureVariations[j])
+                                  * a * a * a * kernelFactorNorm + (pressures[i] + pressures[j])
+                                   * a * a * kernelFactor) / 2.;
+
+                    // relaxation
+                    Eigen::Vector2d displacement = -d * dx / (r * mass);
+
+                    displacement += (surfaceTension / mass) * mass * a * a * kernelFactor * dx;
+
+                    // linear and quadratic visc
+                    Eigen::Vector2d dv = velocities[i] - velocities[j];
+                    double u = dv.dot(dx);
+                    if (u > 0) {
+                        u /= r;
+                        double I = 0.5 * _timeStepSizeInSeconds * a * (linearViscosity * u + quadraticViscosity * u * u);
+                        displacement -= I * dx * _timeStepSizeInSeconds;
+                    }
+
+                    // Every term flips sign when i and j are swapped.
+                    displacements[i] += displacement;
+                    displacements[j] -= displacement;
+                }
+            );
+        }
+    }
 
     #pragma omp parallel for
-	for (int i = 0; i < _particleSystemData->numberOfParticles; i++) {
-		positions[i] = projectedPositions[i];
-		velocities[i] = (positions[i] - lastPositions[i]) / _timeStepSizeInSeconds;
+    for (int i = 0; i < numberOfParticles; i++) {
+        projectedPositions[i] = positions[i] + _displacementBuffers.sum(i);
+    }
+}
+
+bool VSphSolver2D::setSymmetricPairs(bool symmetricPairs) {
+    _symmetricPairs = symmetricPairs;
+
+    // Symmetric pairs add each pair to per-thread buffers, so their rounding depends on how
+    // the particles are split between the threads
+    ParticleNeighborhood2DPtr neighborhood = _particleSystemData->getNeighborhood();
+    neighborhood->setHalfNeighborList(_symmetricPairs && !_deterministic);
+    neighborhood->build(_particleSystemData->getPositions());
+    return true;
+}
+
+void VSphSolver2D::setDeterministic(bool deterministic) {
+    SphSolver2D::setDeterministic(deterministic);
+    setSymmetricPairs(_symmetricPairs);
+}
+
+bool VSphSolver2D::setPrecision(SolverPrecision precision) {
+    return precision == SolverPrecision::Double && SphSolver2D::setPrecision(precision);
+}
+
+std::string VSphSolver2D::getCheckpointName() {
+    return "VSphSolver2D";
+}
+
+void VSphSolver2D::writeState(std::ostream& stream) {
+    SphSolver2D::writeState(stream);
+    writeBinary(stream, _solverSteps);
+    writeBinary(stream, _fps);
+    writeBinary(stream, _timeStepSizeInSecondsSquared);
+    writeBinary(stream, _timeStepSettings.adaptive);
+    writeBinary(stream, _timeStepSettings.courantNumber);
+    writeBinary(stream, _timeStepSettings.forceNumber);
+    writeBinary(stream, _timeStepSettings.minTimeStepSize);
+    writeBinary(stream, _timeStepSettings.maxTimeStepSize);
+    writeBinary(stream, _substeps);
+    writeBinary(stream, _maxAcceleration);
+}
+
+bool VSphSolver2D::readState(std::istream& stream) {
+    return SphSolver2D::readState(stream) && readBinary(stream, _solverSteps) &&
+        readBinary(stream, _fps) && readBinary(stream, _timeStepSizeInSecondsSquared) &&
+        readBinary(stream, _timeStepSettings.adaptive) && readBinary(stream, _timeStepSettings.courantNumber) &&
+        readBinary(stream, _timeStepSettings.forceNumber) && readBinary(stream, _timeStepSettings.minTimeStepSize) &&
+        readBinary(stream, _timeStepSettings.maxTimeStepSize) && readBinary(stream, _substeps) &&
+        readBinary(stream, _maxAcceleration);
+}
+
+double VSphSolver2D::getTimeStepSize() {
+    if (_timeStepSettings.adaptive) {
+        return 1.0 / _fps;
+    }
+
+    return _solverSteps * _timeStepSizeInSeconds;
+}
+
+void VSphSolver2D::setTimeStepSettings(const TimeStepSettings& settings) {
+    _timeStepSettings = settings;
+    _timeStepSettings.minTimeStepSize = std::max(settings.minTimeStepSize, 1e-9);
+    _timeStepSettings.maxTimeStepSize = std::max(settings.maxTimeStepSize, _timeStepSettings.minTimeStepSize);
+
+    _timeStepSizeInSeconds = ((1.0 / _fps) / _solverSteps);
+    _timeStepSizeInSecondsSquared = _timeStepSizeInSeconds * _timeStepSizeInSeconds;
+    _maxAcceleration = 0.0;
+}
+
+int VSphSolver2D::getSubsteps() {
+    return _substeps;
+}
+
+double VSphSolver2D::computeMaxSpeedSquared() {
+    const Eigen::Vector2d *velocities = _particleSystemData->getVelocities().data();
+    double maxSpeedSquared = 0.0;
+
+    #pragma omp parallel for reduction(max:maxSpeedSquared)
+    for (int i = 0; i < _particleSystemData->numberOfParticles; i++) {
+        maxSpeedSquared = std::max(maxSpeedSquared, velocities[i].squaredNorm());
+    }
+
+    return maxSpeedSquared;
+}
+
+double VSphSolver2D::computeTimeStepSize(double remainingTime) {
+    const double kernelRadius = _particleSystemData->getKernelRadius();
+    const double speed = std::sqrt(computeMaxSpeedSquared());
+    // The correction only tracks the largest component, which bounds the norm within sqrt(2).
+    const double acceleration = std::sqrt(2.0) * _maxAcceleration + G2D.norm();
+    double timeStepSize = _timeStepSettings.maxTimeStepSize;
+
+    if (speed > 0.0) {
+        timeStepSize = std::min(timeStepSize, _timeStepSettings.courantNumber * kernelRadius / speed);
+    }
+    if (acceleration > 0.0) {
+        timeStepSize = std::min(timeStepSize, _timeStepSettings.forceNumber * std::sqrt(kernelRadius / acceleration));
+    }
+    timeStepSize = std::max(timeStepSize, _timeStepSettings.minTimeStepSize);
+
+    // Splitting the rest of the update evenly avoids a tiny last step.
+    return remainingTime / std::ceil(remainingTime / timeStepSize);
+}
+
+void VSphSolver2D::correct() {
+    double *positions = flatData(_particleSystemData->getPositions());
+    double *velocities = flatData(_particleSystemData->getVelocities());
+    const double *projectedPositions = flatData(_particleSystemData->getProjectedPositions());
+    const double *lastPositions = flatData(_particleSystemData->getLastPositions());
+    const int numberOfComponents = 2 * _particleSystemData->numberOfParticles;
+    double maxVelocityChange = 0.0;
+
+    #pragma omp parallel for simd reduction(max:maxVelocityChange)
+	for (int k = 0; k < numberOfComponents; k++) {
+		positions[k] = projectedPositions[k];
+		const double velocity = (positions[k] - lastPositions[k]) / _timeStepSizeInSeconds;
+		maxVelocityChange = std::max(maxVelocityChange, std::abs(velocity - velocities[k]));
+		velocities[k] = velocity;
 	}
+
+    _maxAcceleration = maxVelocityChange / _timeStepSizeInSeconds;
 }
 
 void VSphSolver2D::update() {
-    ParticleNeighborhood2DPtr neighorhood = _particleSystemData->getNeighborhood();
-    auto& positions = _particleSystemData->getPositions();
+    PhaseTimer timer;
 
-    for (int i = 0; i < _solverSteps; i++) {
-		applyExternalForces();
-		integrate();
-		neighorhood->build(positions);
-		_particleSystemData->computeDensityPressure();
-		project();
-		correct();
-		enforceBoundary();
-    }
+    applyEmittersAndSinks();
+    timer.lap(_stats.timings.boundary);
+    LoopScheduleScope loopSchedule = applyLoopSchedule();
+    reorderParticles();
+    timer.lap(_stats.timings.neighborBuild);
+    runSteps(timer);
 
     if (_fileName != "") {
         writeToFile();
+        timer.lap(_stats.timings.output);
     }
+
+    SPH_STATS(_stats.solverSteps += _substeps);
+    SPH_STATS(finishUpdateStats());
+}
+
+void VSphSolver2D::runSteps(PhaseTimer& timer) {
+    if (_timeStepSettings.adaptive) {
+        double remainingTime = 1.0 / _fps;
+        _substeps = 0;
+
+        // The last step takes the whole remaining time, so the loop ends on exactly zero.
+        while (remainingTime > 0.0) {
+            _timeStepSizeInSeconds = computeTimeStepSize(remainingTime);
+            _timeStepSizeInSecondsSquared = _timeStepSizeInSeconds * _timeStepSizeInSeconds;
+            step(timer);
+            remainingTime -= _timeStepSizeInSeconds;
+            _substeps++;
+        }
+    } else {
+        for (int i = 0; i < _solverSteps; i++) {
+            step(timer);
+        }
+        _substeps = _solverSteps;
+    }
+}
+
+void VSphSolver2D::step(PhaseTimer& timer) {
+    ParticleNeighborhood2DPtr neighorhood = _particleSystemData->getNeighborhood();
+    auto& positions = _particleSystemData->getPositions();
+
+    applyExternalForces();
+    timer.lap(_stats.timings.forces);
+    integrate();
+    timer.lap(_stats.timings.integrate);
+    neighorhood->build(positions);
+    SPH_STATS(collectNeighborStats());
+    timer.lap(_stats.timings.neighborBuild);
+    _particleSystemData->computeDensityPressure();
+    SPH_STATS(collectDensityStats());
+    timer.lap(_stats.timings.densityPressure);
+    project();
+    timer.lap(_stats.timings.forces);
+    correct();
+    timer.lap(_stats.timings.integrate);
+    enforceBoundary();
+    timer.lap(_stats.timings.boundary);
 }
\ No newline at end of file
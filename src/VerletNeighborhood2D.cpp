@@ -0,0 +1,132 @@
+/**
+ * @file VerletNeighborhood2D.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the Verlet list Neighborhood for 2D particle systems.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../include/VerletNeighborhood2D.h"
+#include "../include/Constants.h"
+#include <cmath>
+
+VerletNeighborhood2D::VerletNeighborhood2D(ParticleNeighborhood2DPtr neighborhood, double skin) :
+    ParticleNeighborhood2D(), _neighborhood(neighborhood), _skin(skin) { }
+
+VerletNeighborhood2D::~VerletNeighborhood2D() { }
+
+void VerletNeighborhood2D::setGridResolution(int width, int height, double kernelRadius) {
+    _kernelRadius = kernelRadius;
+    _neighborhood->setGridResolution(width, height, kernelRadius + _skin);
+    setMaxNeighbors(_maxNeighbors);
+}
+
+void VerletNeighborhood2D::setMaxNeighbors(int maxNeighbors) {
+    const double candidateRatio = (_kernelRadius + _skin) / _kernelRadius;
+    _maxNeighbors = maxNeighbors;
+    _neighborhood->setMaxNeighbors((int) std::ceil(maxNeighbors * candidateRatio * candidateRatio));
+    _buildPositions.clear();
+}
+
+void VerletNeighborhood2D::forEachNearbyPoint(const int origin,
+    const ForEachNearbyPointFunc& callback) const {
+    forEachNeighbor(origin, callback);
+}
+
+NeighborList2D VerletNeighborhood2D::getNeighbors(const int origin) const {
+    return NeighborList2D{&_neighbors[(size_t) origin * _maxNeighbors],
+        &_distances[(size_t) origin * _maxNeighbors], _numNeighbors[origin]};
+}
+
+bool VerletNeighborhood2D::needsRebuild(const std::vector<Eigen::Vector2d>& points) {
+    if (points.size() != _buildPositions.size()) {
+        return true;
+    }
+
+    double maxDisplacementSquared = 0.0;
+
+    #pragma omp parallel for reduction(max: maxDisplacementSquared)
+    for (size_t i = 0; i < points.size(); i++) {
+        maxDisplacementSquared = std::max(maxDisplacementSquared, (points[i] - _buildPositions[i]).squaredNorm());
+    }
+
+    // Two particles moving towards each other by half the skin each close a gap of one skin.
+    return maxDisplacementSquared > 0.25 * _skin * _skin;
+}
+
+void VerletNeighborhood2D::build(const std::vector<Eigen::Vector2d>& points) {
+    const int numberOfPoints = points.size();
+
+    if (needsRebuild(points)) {
+        _neighborhood->build(points);
+        _buildPositions = points;
+        _rebuildCount++;
+    }
+
+    _numNeighbors.resize(numberOfPoints);
+    _neighbors.resize((size_t) numberOfPoints * _maxNeighbors);
+    _distances.resize((size_t) numberOfPoints * _maxNeighbors);
+
+    #pragma omp parallel for schedule(runtime)
+    for (int i = 0; i < numberOfPoints; i++) {
+        const NeighborList2D candidates = _neighborhood->getNeighbors(i);
+        int *neighbors = &_neighbors[(size_t) i * _maxNeighbors];
+        double *distances = &_distances[(size_t) i * _maxNeighbors];
+        int numNeighbors = 0;
+
+        for (int k = 0; k < candidates.size && numNeighbors < _maxNeighbors; k++) {
+            int j = candidates.indices[k];
+            double r2 = (points[j] - points[i]).squaredNorm();
+            if (r2 < EPS || r2 > _kernelRadius * _kernelRadius)
+                continue;
+
+            neighbors[numNeighbors] = j;
+            distances[numNeighbors] = sqrt(r2);
+            ++numNeighbors;
+        }
+
+        _numNeighbors[i] = numNeighbors;
+    }
+}
+
+size_t VerletNeighborhood2D::getTruncatedCount() const {
+    return _neighborhood->getTruncatedCount();
+}
+
+std::vector<double> VerletNeighborhood2D::getDistances(int index) {
+    const double *distances = &_distances[(size_t) index * _maxNeighbors];
+    return std::vector<double>(distances, distances + _numNeighbors[index]);
+}
+
+void VerletNeighborhood2D::setSortByIndex(bool sortByIndex) {
+    _neighborhood->setSortByIndex(sortByIndex);
+    _buildPositions.clear();
+}
+
+void VerletNeighborhood2D::setHalfNeighborList(bool halfNeighborList) {
+    _neighborhood->setHalfNeighborList(halfNeighborList);
+    _buildPositions.clear();
+}
+
+void VerletNeighborhood2D::invalidate() {
+    _buildPositions.clear();
+}
+
+bool VerletNeighborhood2D::isHalfNeighborList() const {
+    return _neighborhood->isHalfNeighborList();
+}
+
+ParticleNeighborhood2DPtr VerletNeighborhood2D::getNeighborhood() {
+    return _neighborhood;
+}
+
+double VerletNeighborhood2D::getSkin() {
+    return _skin;
+}
+
+int VerletNeighborhood2D::getRebuildCount() {
+    return _rebuildCount;
+}
\ No newline at end of file
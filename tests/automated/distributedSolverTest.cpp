@@ -0,0 +1,129 @@
+/**
+ * @file distributedSolverTest.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the automated tests for the domain decomposed 2D solver. Built with
+ * SPH_MPI and run on several ranks.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../../include/CsvReader.h"
+#include "../../include/DistributedVSphSolver2D.h"
+
+#include <iostream>
+#include <cmath>
+#include <eigen3/Eigen/Dense>
+
+/**
+ * @brief The tolerance for the tests. The sums over the ghosts take a different order than
+ * the serial ones, so the positions only match up to rounding, which grows once the block
+ * hits the floor.
+ * 
+ */
+static const double ERROR_TOLERANCE = 1e-5;
+
+/**
+ * @brief Print the result of a test on the first rank.
+ * 
+ * @param testName: Name of the test.
+ * @param passed: If the test passed on every rank.
+ */
+void printResult(const std::string& testName, bool passed) {
+    int rank = 0;
+    int allPassed = passed;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Allreduce(MPI_IN_PLACE, &allPassed, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        std::cout << testName << " Test: " << (allPassed ? "PASSED!" : "FAILED!") << std::endl;
+    }
+}
+
+/**
+ * @brief Test function for DistributedVSphSolver2D: Compare the gathered positions to the
+ * benchmark of VSphSolver2D on CSV file, rebalancing the slabs every few updates, and check
+ * that no particle is lost and the slabs stay balanced.
+ * 
+ */
+void distributedVSphSolver2DTest() {
+    DistributedVSphSolver2D solver(50*50);
+    std::ifstream file("VSphSolver2DData.csv");
+    std::vector<Eigen::Vector2d> positions = {};
+    bool passed = true;
+    int rows = 0;
+
+    solver.setRebalanceInterval(5);
+
+    for (auto& row : CSVRange(file)) {
+        if (rows++ == 15) {
+            break;
+        }
+
+        solver.update();
+
+        if (solver.gatherPositions(positions)) {
+            for (size_t i = 0; i < positions.size(); i++) {
+                passed = passed && (positions[i] - get2DVector(std::string(row[i]))).norm() < ERROR_TOLERANCE;
+            }
+        }
+    }
+
+    unsigned long owned = solver.getNumberOfOwnedParticles();
+    unsigned long total = 0;
+    unsigned long largest = 0;
+
+    MPI_Allreduce(&owned, &total, 1, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&owned, &largest, 1, MPI_UNSIGNED_LONG, MPI_MAX, MPI_COMM_WORLD);
+
+    const double average = (double) total / solver.getNumberOfRanks();
+    const Eigen::Vector2d slab = solver.getSlab(solver.getRank());
+
+    for (const Eigen::Vector2d& position : solver.getPositions()) {
+        passed = passed && position(0) >= slab(0) && position(0) < slab(1);
+    }
+
+    passed = passed && total == solver.getGlobalNumberOfParticles() && largest < 1.25 * average;
+    printResult("DistributedVSphSolver2D", passed);
+}
+
+/**
+ * @brief Test function for DistributedVSphSolver2D: Check that emitters, sinks, spatial sorts
+ * and symmetric pairs are rejected, and that the solver still matches the benchmark after.
+ * 
+ */
+void distributedRejectedSettingsTest() {
+    DistributedVSphSolver2D solver(50*50);
+    std::ifstream file("VSphSolver2DData.csv");
+    std::vector<Eigen::Vector2d> positions = {};
+    CSVRange rows(file);
+    auto row = rows.begin();
+
+    bool passed = !solver.addEmitter(std::make_shared<ParticleEmitter2D>(Eigen::Vector2d(1.0, 4.0),
+        Eigen::Vector2d(1.0, 3.0), Eigen::Vector2d(3.0, 0.0), 0.09)) &&
+        !solver.addSink(std::make_shared<ParticleSink2D>(Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.0, 1.0))) &&
+        !solver.setReorderInterval(5) && solver.setReorderInterval(0) &&
+        !solver.setSymmetricPairs(true) && solver.setSymmetricPairs(false);
+
+    solver.update();
+
+    if (solver.gatherPositions(positions)) {
+        for (size_t i = 0; i < positions.size(); i++) {
+            passed = passed && (positions[i] - get2DVector(std::string((*row)[i]))).norm() < ERROR_TOLERANCE;
+        }
+    }
+
+    printResult("DistributedVSphSolver2D Rejected Settings", passed);
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+    distributedVSphSolver2DTest();
+    distributedRejectedSettingsTest();
+    MPI_Finalize();
+
+    return 0;
+}
\ No newline at end of file
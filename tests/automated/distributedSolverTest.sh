@@ -0,0 +1,2 @@
+mpicxx -fdiagnostics-color=always -g -D SPH_MPI -std=c++2a distributedSolverTest.cpp ../../src/*.cpp -o ../../out/distributedSolverTest -lglut -lGL -fopenmp
+mpirun -np ${1:-2} ../../out/distributedSolverTest
\ No newline at end of file
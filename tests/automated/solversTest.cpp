@@ -12,8 +12,30 @@
 #include "../../include/CsvReader.h"
 #include "../../include/SphSolver2D.h"
 #include "../../include/VSphSolver2D.h"
+#include "../../include/PciSphSolver2D.h"
+#include "../../include/SphSolverCore2D.h"
+#include "../../include/SnapshotReader.h"
+#include "../../include/RecordingReader.h"
+#include "../../include/CellListNeighborhood2D.h"
+#include "../../include/GridNeighborhood2D.h"
+#include "../../include/HashNeighborhood2D.h"
+#include "../../include/VerletNeighborhood2D.h"
+#include "../../include/SphSolver3D.h"
+#include "../../include/DeviceVSphSolver2D.h"
+#include "../../include/GlutRenderer2D.h"
+#include "../../include/FrameTripleBuffer.h"
+#include "../../include/EnsembleRunner.h"
+#include "../../include/PolygonCollider2D.h"
 
 #include <iostream>
+#include <cstdio>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <map>
+#include <filesystem>
+#include <omp.h>
 #include <eigen3/Eigen/Dense>
 
 /**
@@ -22,62 +44,1249 @@
  */
 static const double ERROR_TOLERANCE = 1e-5;
 
+/**
+ * @brief Compare the positions of a solver, update by update, to a benchmark CSV file.
+ * 
+ * @param solver: The solver to be tested.
+ * @param fileName: Name of the CSV file with the benchmark positions.
+ * @param maxRows: Maximum number of rows to compare, -1 to compare every row.
+ * @param firstRow: Number of rows skipped, for solvers that start from a saved state.
+ * @param tolerance: Largest distance accepted between a position and the benchmark.
+ * @return true if every position matches the benchmark.
+ * @return false otherwise.
+ */
+bool matchesBenchmark(SphSolver2D& solver, const std::string& fileName, int maxRows = -1, int firstRow = 0,
+    double tolerance = ERROR_TOLERANCE) {
+    RecordingReader reader(fileName);
+    std::vector<Eigen::Vector2d> expectedPositions;
+    size_t rows = reader.getNumberOfFrames();
+
+    if (maxRows >= 0) {
+        rows = std::min<size_t>(rows, maxRows);
+    }
+
+    for (size_t row = firstRow; row < rows; row++) {
+        solver.update();
+        const std::vector<Eigen::Vector2d>& positions = solver.getPositions();
+
+        if (!reader.readPositions(row, expectedPositions) || expectedPositions.size() != positions.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < positions.size(); i++) {
+            if (!((positions[i] - expectedPositions[i]).norm() < tolerance)) {
+                return false;
+            }
+        }
+    }
+
+    return reader.isOpen();
+}
+
+/**
+ * @brief Print the result of a test.
+ * 
+ * @param testName: Name of the test.
+ * @param passed: If the test passed.
+ */
+void printResult(const std::string& testName, bool passed) {
+    std::cout << testName << " Test: " << (passed ? "PASSED!" : "FAILED!") << std::endl;
+}
+
 /**
  * @brief Test function for SphSolver2D: Compare current solver to benchmark on CSV file.
  * 
  */
 void sphSolver2DTest() {
-    std::ifstream file("SphSolver2DData.csv");
     SphSolver2D solver(500);
+    printResult("SphSolver2D", matchesBenchmark(solver, "SphSolver2DData.csv"));
+}
+
+/**
+ * @brief Test function for VSphSolver2D: Compare current solver to benchmark on CSV file.
+ * 
+ */
+void vSphSolver2DTest() {
+    VSphSolver2D solver(50*50);
+    printResult("VSphSolver2D", matchesBenchmark(solver, "VSphSolver2DData.csv"));
+}
+
+/**
+ * @brief Test function for the cell list neighborhood: both solvers must match the
+ * benchmarks created with the grid neighborhood.
+ * 
+ */
+void cellListNeighborhood2DTest() {
+    // SphSolver2D jitters the initial positions with rand(), so the default seed used to
+    // create the benchmark is restored.
+    srand(1);
+    SphSolver2D sphSolver(500, "", NeighborhoodType::CellList);
+    printResult("SphSolver2D CellList", matchesBenchmark(sphSolver, "SphSolver2DData.csv"));
+
+    VSphSolver2D vSphSolver(50*50, "", NeighborhoodType::CellList);
+    printResult("VSphSolver2D CellList", matchesBenchmark(vSphSolver, "VSphSolver2DData.csv"));
+}
+
+/**
+ * @brief Test function for the spatial hash neighborhood: SphSolver2D must match the benchmark
+ * created with the grid neighborhood, and a sparse scene spread far outside the view must
+ * find the same neighbors as an all-pairs loop, with a table that follows the number of
+ * particles.
+ * 
+ */
+void hashNeighborhood2DTest() {
+    srand(1);
+    SphSolver2D sphSolver(500, "", NeighborhoodType::Hash);
+    printResult("SphSolver2D Hash", matchesBenchmark(sphSolver, "SphSolver2DData.csv"));
+
+    std::vector<Eigen::Vector2d> points;
+    for (int i = 0; i < 2000; i++) {
+        Eigen::Vector2d center = i % 2 == 0 ? Eigen::Vector2d(50.0, 50.0) : Eigen::Vector2d(-3e7, 1e9);
+        points.push_back(center + 20.0 * Eigen::Vector2d::Random());
+    }
+
+    HashNeighborhood2D hash;
+    hash.setGridResolution(100, 100, 1.0);
+    hash.setSortByIndex(true);
+    hash.build(points);
+
+    bool passed = hash.getNumberOfBuckets() <= 4 * points.size();
+    for (size_t i = 0; i < points.size(); i++) {
+        std::vector<int> expected;
+        for (size_t j = 0; j < points.size(); j++) {
+            double r2 = (points[j] - points[i]).squaredNorm();
+            if (r2 >= EPS && r2 <= 1.0) {
+                expected.push_back(j);
+            }
+        }
+
+        NeighborList2D neighbors = hash.getNeighbors(i);
+        passed = passed && neighbors.size == (int) expected.size() &&
+            std::equal(expected.begin(), expected.end(), neighbors.indices);
+    }
+
+    printResult("HashNeighborhood2D Sparse", passed);
+}
+
+/**
+ * @brief Test function for symmetric pair-wise evaluation on VSphSolver2D. Evaluating each
+ * pair once only changes rounding, which the fluid amplifies until single particles part
+ * ways with the benchmark after about fifteen updates. The run then goes on next to a
+ * solver with full lists, whose centroid and mean density it must keep following, so a
+ * pair that is lost or added twice shows up as drift. The densities of the base particle
+ * system must also match on half and full neighbor lists.
+ * 
+ */
+void symmetricPairsTest() {
+    VSphSolver2D solver(50*50);
+    VSphSolver2D fullSolver(50*50);
+    solver.setSymmetricPairs(true);
+    bool passed = matchesBenchmark(solver, "VSphSolver2DData.csv", 15) &&
+        matchesBenchmark(fullSolver, "VSphSolver2DData.csv", 15);
 
-    for(auto& row: CSVRange(file)) {
+    for (int update = 15; passed && update < 200; update++) {
         solver.update();
-        auto positions = solver.getPositions();
+        fullSolver.update();
 
-        for (int i = 0; i < positions.size(); i++) {
-            Eigen::Vector2d position = positions[i];
-            std::string expectedPositionStr = std::string(row[i]);
-            Eigen::Vector2d expectedPosition = get2DVector(expectedPositionStr);
+        Eigen::Vector2d centroidDistance = Eigen::Vector2d::Zero();
+        double meanDensity = 0.0;
+        double fullMeanDensity = 0.0;
 
-            if (!((position - expectedPosition).norm() < ERROR_TOLERANCE)) {
-                std::cout << "SphSolver2D Test: FAILED!" << std::endl;
-                return;
-            }   
+        for (size_t i = 0; i < solver.getPositions().size(); i++) {
+            centroidDistance += solver.getPositions()[i] - fullSolver.getPositions()[i];
+            meanDensity += solver.getParticleSystemData()->getDensities()[i];
+            fullMeanDensity += fullSolver.getParticleSystemData()->getDensities()[i];
         }
+
+        passed = centroidDistance.norm() < 0.2 * solver.getPositions().size() &&
+            std::abs(meanDensity - fullMeanDensity) < 0.1 * fullMeanDensity;
     }
 
-    std::cout << "SphSolver2D Test: PASSED!" << std::endl;
+    printResult("VSphSolver2D SymmetricPairs", passed);
+
+    SphParticleSystemData2D particleSystemData;
+    for (int i = 0; i < 500; i++) {
+        particleSystemData.addParticle(Eigen::Vector2d(100 + 9.0 * (i % 25), 100 + 9.0 * (i / 25)));
+    }
+
+    particleSystemData.getNeighborhood()->setGridResolution(400, 400, particleSystemData.getKernelRadius());
+    particleSystemData.buildNeighborhood();
+    particleSystemData.computeDensityPressure();
+    const std::vector<double> densities = particleSystemData.getDensities();
+
+    particleSystemData.getNeighborhood()->setHalfNeighborList(true);
+    particleSystemData.buildNeighborhood();
+    particleSystemData.computeDensityPressure();
+    passed = true;
+
+    for (size_t i = 0; i < densities.size(); i++) {
+        passed = passed && std::abs(particleSystemData.getDensities()[i] - densities[i]) < 1e-9 * densities[i];
+    }
+
+    printResult("SphParticleSystemData2D SymmetricPairs", passed);
 }
 
 /**
- * @brief Test function for VSphSolver2D: Compare current solver to benchmark on CSV file.
+ * @brief Test function for Verlet lists on VSphSolver2D, which must match the benchmark over
+ * the first updates. On a lattice with more candidates than the default slots, the Verlet
+ * lists must still hold the same neighbors as a grid built with the kernel radius.
  * 
  */
-void vSphSolver2DTest() {
+void verletNeighborhood2DTest() {
+    VSphSolver2D solver(50*50);
+    solver.setVerletSkin(0.03);
+    printResult("VSphSolver2D VerletNeighborhood2D", matchesBenchmark(solver, "VSphSolver2DData.csv", 10));
+
+    std::vector<Eigen::Vector2d> points;
+    for (int i = 0; i < 41 * 41; i++) {
+        points.push_back(Eigen::Vector2d(2.0 + 0.25 * (i % 41), 2.0 + 0.25 * (i / 41)));
+    }
+
+    GridNeighborhood2D grid;
+    VerletNeighborhood2D verlet(std::make_shared<GridNeighborhood2D>(), 0.5);
+    grid.setGridResolution(15, 15, 1.0);
+    verlet.setGridResolution(15, 15, 1.0);
+    grid.setSortByIndex(true);
+    verlet.setSortByIndex(true);
+    grid.build(points);
+    verlet.build(points);
+    bool passed = true;
+
+    for (size_t i = 0; i < points.size(); i++) {
+        NeighborList2D expected = grid.getNeighbors(i);
+        NeighborList2D neighbors = verlet.getNeighbors(i);
+        passed = passed && neighbors.size == expected.size &&
+            std::equal(neighbors.indices, neighbors.indices + neighbors.size, expected.indices);
+    }
+
+    printResult("VerletNeighborhood2D Dense", passed);
+}
+
+/**
+ * @brief Saves a checkpoint halfway through the benchmark and checks that a new solver
+ * restored from it produces the rest of the benchmark. Loading the checkpoint cut in the
+ * particle attributes or in the solver parameters must fail and leave the solver unchanged.
+ * The time step and pressure solver settings must be restored as well.
+ * 
+ */
+void checkpointTest() {
+    const std::string checkpointFileName = "checkpointTest.ckpt";
+    VSphSolver2D solver(50*50);
+    bool passed = matchesBenchmark(solver, "VSphSolver2DData.csv", 5) &&
+        solver.saveCheckpoint(checkpointFileName);
+
+    VSphSolver2D restoredSolver(50*50);
+    passed = passed && restoredSolver.loadCheckpoint(checkpointFileName) &&
+        matchesBenchmark(restoredSolver, "VSphSolver2DData.csv", 10, 5);
+
+    const std::string truncatedFileName = "checkpointTest.truncated.ckpt";
+    const uintmax_t size = std::filesystem::file_size(checkpointFileName);
+    VSphSolver2D untouchedSolver(50*50);
+
+    for (uintmax_t truncatedSize : {size / 2, size - 1}) {
+        std::filesystem::copy_file(checkpointFileName, truncatedFileName,
+            std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(truncatedFileName, truncatedSize);
+        passed = passed && !untouchedSolver.loadCheckpoint(truncatedFileName);
+    }
+
+    passed = passed && matchesBenchmark(untouchedSolver, "VSphSolver2DData.csv", 5);
+    std::remove(truncatedFileName.c_str());
+
+    TimeStepSettings timeStepSettings;
+    timeStepSettings.adaptive = true;
+    timeStepSettings.courantNumber = 0.3;
+    VSphSolver2D adaptiveSolver(500);
+    adaptiveSolver.setTimeStepSettings(timeStepSettings);
+    adaptiveSolver.update();
+    VSphSolver2D restoredAdaptiveSolver(500);
+    passed = passed && adaptiveSolver.saveCheckpoint(checkpointFileName) &&
+        restoredAdaptiveSolver.loadCheckpoint(checkpointFileName);
+    adaptiveSolver.update();
+    restoredAdaptiveSolver.update();
+    passed = passed && restoredAdaptiveSolver.getSubsteps() == adaptiveSolver.getSubsteps() &&
+        restoredAdaptiveSolver.getPositions() == adaptiveSolver.getPositions();
+
+    PressureSolverSettings pressureSolverSettings;
+    pressureSolverSettings.densityErrorTolerance = 0.001;
+    pressureSolverSettings.maxIterations = 7;
+    PciSphSolver2D pciSolver(500);
+    pciSolver.setPressureSolverSettings(pressureSolverSettings);
+    pciSolver.update();
+    PciSphSolver2D restoredPciSolver(500);
+    passed = passed && pciSolver.saveCheckpoint(checkpointFileName) &&
+        restoredPciSolver.loadCheckpoint(checkpointFileName);
+    pciSolver.update();
+    restoredPciSolver.update();
+    passed = passed && restoredPciSolver.getPressureIterations() == pciSolver.getPressureIterations() &&
+        restoredPciSolver.getPositions() == pciSolver.getPositions();
+
+    std::remove(checkpointFileName.c_str());
+    printResult("VSphSolver2D Checkpoint", passed);
+}
+
+/**
+ * @brief Checks the statistics of the solvers: collected when compiled with
+ * SPH_INSTRUMENTATION, all zero otherwise. A cluster with more particles than a neighborhood
+ * can store must be reported as truncated.
+ * 
+ */
+void solverStatsTest() {
+    const int steps = 5;
+    VSphSolver2D solver(50*50);
+
+    for (int i = 0; i < steps; i++) {
+        solver.update();
+    }
+
+    const SolverStats& stats = solver.getStats();
+    bool passed;
+
+    std::vector<Eigen::Vector2d> cluster;
+    for (int i = 0; i < 2 * CellListNeighborhood2D::MAX_NEIGHBORS; i++) {
+        cluster.push_back(Eigen::Vector2d(1.0 + 1e-3 * i, 1.0));
+    }
+
+    CellListNeighborhood2D neighborhood;
+    neighborhood.setGridResolution(10, 10, 0.5);
+    neighborhood.build(cluster);
+
+    if (SOLVER_STATS_ENABLED) {
+        passed = stats.timings.updates == steps && stats.timings.total() > 0.0 &&
+            stats.neighborBuilds == stats.neighborRebuilds && stats.neighborBuilds > 0 &&
+            stats.averageNeighbors() > 0.0 && stats.maxDensityError > 0.0 &&
+            neighborhood.getTruncatedCount() == cluster.size();
+    } else {
+        passed = stats.timings.updates == 0 && stats.timings.total() == 0.0 &&
+            stats.neighborBuilds == 0 && neighborhood.getTruncatedCount() == 0;
+    }
+
+    printResult("VSphSolver2D SolverStats", passed);
+}
+
+/**
+ * @brief Checks that two neighborhoods, sorted by index, store the same neighbors.
+ * 
+ * @param first: The first neighborhood.
+ * @param second: The second neighborhood.
+ * @param numberOfPoints: Number of particles of the last build.
+ * @return true if every particle has the same neighbors on both.
+ * @return false otherwise.
+ */
+bool sameNeighbors(const ParticleNeighborhood2D& first, const ParticleNeighborhood2D& second, int numberOfPoints) {
+    for (int i = 0; i < numberOfPoints; i++) {
+        NeighborList2D a = first.getNeighbors(i);
+        NeighborList2D b = second.getNeighbors(i);
+
+        if (a.size != b.size || !std::equal(a.indices, a.indices + a.size, b.indices)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Builds GridNeighborhood2D with more particles than it used to hold, then with fewer
+ * and more again, and compares it to CellListNeighborhood2D.
+ * 
+ */
+void gridNeighborhoodCapacityTest() {
+    std::vector<Eigen::Vector2d> points;
+    srand(1);
+    for (int i = 0; i < 20000; i++) {
+        points.push_back(Eigen::Vector2d(100.0 * rand() / RAND_MAX, 100.0 * rand() / RAND_MAX));
+    }
+
+    GridNeighborhood2D grid;
+    CellListNeighborhood2D cellList;
+    grid.setGridResolution(100, 100, 1.0);
+    cellList.setGridResolution(100, 100, 1.0);
+    grid.setSortByIndex(true);
+    cellList.setSortByIndex(true);
+    bool passed = true;
+
+    for (int numberOfPoints : {20000, 3000, 12000}) {
+        std::vector<Eigen::Vector2d> subset(points.begin(), points.begin() + numberOfPoints);
+        grid.build(subset);
+        cellList.build(subset);
+        passed = passed && sameNeighbors(grid, cellList, numberOfPoints);
+    }
+
+    printResult("GridNeighborhood2D Capacity", passed);
+}
+
+/**
+ * @brief Removes particles from a particle system and checks that the ids stay dense, the
+ * persistent ids are kept and the remaining particles keep their positions. Then runs a
+ * solver with an emitter and a sink and checks the particle count, and that the snapshots
+ * hold the particles of every frame under their persistent ids.
+ * 
+ */
+void emittersAndSinksTest() {
+    SphParticleSystemData2D data;
+    for (int i = 0; i < 10; i++) {
+        data.addParticle(Eigen::Vector2d(i, 0.0));
+    }
+
+    std::vector<size_t> removed = {2, 7, 0};
+    data.removeParticles(removed);
+
+    std::vector<bool> seenIds(data.numberOfParticles, false);
+    std::vector<bool> seenPositions(10, false);
+    bool passed = data.numberOfParticles == 7;
+
+    for (size_t k = 0; passed && k < data.numberOfParticles; k++) {
+        const size_t id = data.getParticleIds()[k];
+        const int position = data.getPositions()[k](0);
+        passed = id < seenIds.size() && !seenIds[id] && !seenPositions[position] &&
+            position != 2 && position != 7 && position != 0 && data.getPersistentIds()[k] == position;
+        seenIds[id] = true;
+        seenPositions[position] = true;
+    }
+
+    data.addParticle(Eigen::Vector2d(10.0, 0.0));
+    passed = passed && data.getPersistentIds().back() == 10.0;
+
+    const std::string snapshotFileName = "VSphSolver2DEmitters.snap";
+    const int numberOfUpdates = 30;
+    std::vector<std::map<uint64_t, Eigen::Vector2d>> frames(numberOfUpdates);
+    ParticleEmitter2DPtr emitter;
+    ParticleSink2DPtr sink;
+    size_t numberOfParticles;
+
+    {
+        VSphSolver2D solver(20*20, snapshotFileName);
+        const double height = solver.getViewHeight();
+        emitter = std::make_shared<ParticleEmitter2D>(Eigen::Vector2d(1.0, height - 1.0),
+            Eigen::Vector2d(1.0, height - 2.0), Eigen::Vector2d(3.0, 0.0), 0.09);
+        sink = std::make_shared<ParticleSink2D>(Eigen::Vector2d(0.0, 0.0),
+            Eigen::Vector2d(solver.getViewWidth(), 0.5));
+        solver.addEmitter(emitter);
+        solver.addSink(sink);
+
+        OutputSettings outputSettings;
+        outputSettings.compression = SnapshotCompression::Delta;
+        outputSettings.keyframeInterval = 8;
+        solver.setOutputFormat(OutputFormat::Binary);
+        solver.setOutputSettings(outputSettings);
+        solver.setReorderInterval(5);
+
+        for (int update = 0; update < numberOfUpdates; update++) {
+            solver.update();
+            SphParticleSystemData2DPtr particleSystemData = solver.getParticleSystemData();
+            for (size_t k = 0; k < particleSystemData->numberOfParticles; k++) {
+                frames[update][particleSystemData->getPersistentIds()[k]] = particleSystemData->getPositions()[k];
+            }
+        }
+
+        numberOfParticles = solver.getPositions().size();
+        for (const Eigen::Vector2d& position : solver.getPositions()) {
+            passed = passed && position.allFinite();
+        }
+    }
+
+    passed = passed && emitter->getEmittedCount() > 0 && sink->getAbsorbedCount() > 0 &&
+        numberOfParticles == 400 + emitter->getEmittedCount() - sink->getAbsorbedCount();
+
+    // Read the frames backwards, so compressed frames are decoded from their keyframes.
+    SnapshotReader reader(snapshotFileName);
+    const int positionsField = reader.getFieldIndex("positions");
+    passed = passed && reader.isOpen() && reader.storesIds() && reader.getNumberOfFrames() == numberOfUpdates &&
+        reader.getNumberOfParticles(numberOfUpdates - 1) == numberOfParticles;
+
+    for (int frame = numberOfUpdates - 1; passed && frame >= 0; frame--) {
+        const uint64_t *ids = reader.getIds(frame);
+        passed = ids && reader.getNumberOfParticles(frame) == frames[frame].size();
+
+        for (size_t i = 0; passed && i < reader.getNumberOfParticles(frame); i++) {
+            Eigen::Vector2d position;
+            passed = frames[frame].count(ids[i]) == 1 && reader.getVector2d(frame, positionsField, i, position) &&
+                position == frames[frame][ids[i]];
+        }
+    }
+
+    std::remove(snapshotFileName.c_str());
+
+    // A scene that starts empty still records a frame for every update, before and after
+    // its inflow starts.
+    {
+        VSphSolver2D solver(0, snapshotFileName);
+        solver.setOutputFormat(OutputFormat::Binary);
+        for (int update = 0; update < 5; update++) {
+            if (update == 2) {
+                solver.addEmitter(std::make_shared<ParticleEmitter2D>(Eigen::Vector2d(1.0, 4.0),
+                    Eigen::Vector2d(1.0, 3.0), Eigen::Vector2d(3.0, 0.0), 0.09));
+            }
+            solver.update();
+        }
+    }
+
+    SnapshotReader emptyReader(snapshotFileName);
+    passed = passed && emptyReader.isOpen() && emptyReader.getNumberOfFrames() == 5 &&
+        emptyReader.getNumberOfParticles(1) == 0 && emptyReader.getNumberOfParticles(4) > 0;
+    std::remove(snapshotFileName.c_str());
+
+    printResult("VSphSolver2D Emitters and Sinks", passed);
+}
+
+/**
+ * @brief The tolerance of the mixed precision positions against the double precision
+ * benchmark. The flow is chaotic, so only the first MIXED_PRECISION_ROWS updates are
+ * compared, and the whole run is compared to its own benchmark.
+ * 
+ */
+static const double MIXED_PRECISION_TOLERANCE = 5e-3;
+
+/**
+ * @brief Number of updates compared to the double precision benchmark in mixed precision.
+ * 
+ */
+static const int MIXED_PRECISION_ROWS = 25;
+
+/**
+ * @brief Runs the base solver in mixed precision and checks it against its own benchmark, and
+ * against the double precision benchmark within MIXED_PRECISION_TOLERANCE. A checkpoint of a
+ * mixed precision run must continue it bit for bit, and the solvers without single precision
+ * steps must reject it.
+ * 
+ */
+void mixedPrecisionTest() {
+    srand(1);
+    SphSolver2D solver(500);
+    solver.setPrecision(SolverPrecision::Mixed);
+    printResult("SphSolver2D Mixed Precision", matchesBenchmark(solver, "SphSolver2DMixedData.csv"));
+
+    srand(1);
+    SphSolver2D bandSolver(500);
+    bandSolver.setPrecision(SolverPrecision::Mixed);
+    printResult("SphSolver2D Mixed Precision Band", matchesBenchmark(bandSolver, "SphSolver2DData.csv",
+        MIXED_PRECISION_ROWS, 0, MIXED_PRECISION_TOLERANCE));
+
+    const std::string checkpointFileName = "mixedPrecisionTest.ckpt";
+    srand(1);
+    SphSolver2D checkpointSolver(500);
+    checkpointSolver.setPrecision(SolverPrecision::Mixed);
+    bool passed = matchesBenchmark(checkpointSolver, "SphSolver2DMixedData.csv", 10) &&
+        checkpointSolver.saveCheckpoint(checkpointFileName);
+
+    SphSolver2D restoredSolver(500);
+    passed = passed && restoredSolver.loadCheckpoint(checkpointFileName) &&
+        matchesBenchmark(restoredSolver, "SphSolver2DMixedData.csv", 10, 10);
+    std::remove(checkpointFileName.c_str());
+    printResult("SphSolver2D Mixed Precision Checkpoint", passed);
+
+    VSphSolver2D vSphSolver(10);
+    PciSphSolver2D pciSphSolver(10);
+    printResult("Mixed Precision Rejected", !vSphSolver.setPrecision(SolverPrecision::Mixed) &&
+        !pciSphSolver.setPrecision(SolverPrecision::Mixed) && vSphSolver.setPrecision(SolverPrecision::Double));
+}
+
+/**
+ * @brief Runs the viscoelastic solver with adaptive time steps and checks that every update
+ * stays within the step limits and the view, and that the scene needs fewer steps on
+ * average than the fixed updates.
+ * 
+ */
+void adaptiveTimeStepTest() {
+    srand(1);
+    VSphSolver2D solver(500);
+    const int updates = 100;
+    solver.update();
+    bool passed = solver.getSubsteps() == 10;
+
+    TimeStepSettings settings;
+    settings.adaptive = true;
+    solver.setTimeStepSettings(settings);
+
+    const double updateTime = solver.getTimeStepSize();
+    const int minSubsteps = std::ceil(updateTime / settings.maxTimeStepSize - 1e-9);
+    const int maxSubsteps = std::ceil(updateTime / settings.minTimeStepSize + 1e-9);
+    int substeps = 0;
+
+    for (int i = 0; passed && i < updates; i++) {
+        solver.update();
+        substeps += solver.getSubsteps();
+        passed = solver.getSubsteps() >= minSubsteps && solver.getSubsteps() <= maxSubsteps;
+
+        for (const Eigen::Vector2d& position : solver.getPositions()) {
+            passed = passed && position.allFinite() && position(0) > -1.0 && position(1) > -1.0 &&
+                position(0) < solver.getViewWidth() + 1.0 && position(1) < solver.getViewHeight() + 1.0;
+        }
+    }
+
+    printResult("VSphSolver2D Adaptive Time Step", passed && substeps < 10 * updates);
+}
+
+/**
+ * @brief Test function for DeviceVSphSolver2D: Compare the device steps to the benchmark on
+ * CSV file and to adaptive VSphSolver2D steps, and check that the positions are only copied
+ * back from the device when they are read or sorted. Symmetric pairs must be rejected.
+ * 
+ */
+void deviceVSphSolver2DTest() {
+    DeviceVSphSolver2D solver(50*50);
+    bool passed = matchesBenchmark(solver, "VSphSolver2DData.csv", 50);
+    const size_t downloads = solver.getPositionDownloads();
+
+    for (int i = 0; i < 5; i++) {
+        solver.update();
+    }
+
+    passed = passed && solver.getPositionDownloads() == downloads;
+    solver.getPositions();
+    solver.getPositions();
+    passed = passed && solver.getPositionDownloads() == downloads + 1;
+
+    // With a reorder interval of 5, only the fifth update copies the particles back to sort them.
+    passed = passed && !solver.setSymmetricPairs(true) && solver.setSymmetricPairs(false) &&
+        solver.setReorderInterval(5);
+    for (int i = 0; i < 4; i++) {
+        solver.update();
+    }
+    passed = passed && solver.getPositionDownloads() == downloads + 1;
+    solver.update();
+    passed = passed && solver.getPositionDownloads() == downloads + 2;
+
+    TimeStepSettings settings;
+    settings.adaptive = true;
+    VSphSolver2D hostSolver(500);
+    DeviceVSphSolver2D deviceSolver(500);
+    hostSolver.setTimeStepSettings(settings);
+    deviceSolver.setTimeStepSettings(settings);
+
+    for (int i = 0; passed && i < 20; i++) {
+        hostSolver.update();
+        deviceSolver.update();
+        passed = hostSolver.getSubsteps() == deviceSolver.getSubsteps();
+
+        for (size_t j = 0; j < hostSolver.getPositions().size(); j++) {
+            passed = passed && (hostSolver.getPositions()[j] - deviceSolver.getPositions()[j]).norm() < ERROR_TOLERANCE;
+        }
+    }
+
+    printResult("DeviceVSphSolver2D", passed);
+}
+
+/**
+ * @brief Saves a checkpoint of DeviceVSphSolver2D halfway through the benchmark, and checks
+ * that a device solver restored from it, after running steps of its own, produces the rest of
+ * the benchmark.
+ * 
+ */
+void deviceCheckpointTest() {
+    const std::string checkpointFileName = "deviceCheckpointTest.ckpt";
+    DeviceVSphSolver2D solver(50*50);
+    bool passed = matchesBenchmark(solver, "VSphSolver2DData.csv", 5) &&
+        solver.saveCheckpoint(checkpointFileName);
+
+    DeviceVSphSolver2D restoredSolver(50*50);
+    restoredSolver.update();
+    passed = passed && restoredSolver.loadCheckpoint(checkpointFileName) &&
+        matchesBenchmark(restoredSolver, "VSphSolver2DData.csv", 10, 5);
+
+    std::remove(checkpointFileName.c_str());
+    printResult("DeviceVSphSolver2D Checkpoint", passed);
+}
+
+/**
+ * @brief Runs the PCISPH solver with a time step three times the one of the base solver and
+ * checks that the pressure correction keeps the predicted densities within the tolerance and
+ * the particles within the view.
+ * 
+ */
+void pciSphSolver2DTest() {
+    PciSphSolver2D solver(500);
+    PressureSolverSettings settings;
+    solver.setPressureSolverSettings(settings);
+    bool passed = solver.getTimeStepSize() >= 0.002;
+
+    for (int i = 0; passed && i < 100; i++) {
+        solver.update();
+        passed = solver.getPressureIterations() >= settings.minIterations &&
+            solver.getPressureIterations() < settings.maxIterations &&
+            solver.getDensityError() <= settings.densityErrorTolerance;
+
+        for (const Eigen::Vector2d& position : solver.getPositions()) {
+            passed = passed && position.allFinite() && position(0) > 0.0 && position(1) > 0.0 &&
+                position(0) < solver.getViewWidth() && position(1) < solver.getViewHeight();
+        }
+    }
+
+    printResult("PciSphSolver2D", passed);
+}
+
+/**
+ * @brief Checks that SphSolverCore2D in single precision computes the densities of a block of
+ * particles within ERROR_TOLERANCE of the double precision particle system data.
+ * 
+ */
+void floatSolverCore2DTest() {
+    SphParticleSystemData2D data;
+    double kernelRadius = data.getKernelRadius();
+
+    for (int i = 0; i < 20; i++) {
+        for (int j = 0; j < 20; j++) {
+            data.addParticle(Eigen::Vector2d(300.0 + 0.6 * kernelRadius * i, 300.0 + 0.6 * kernelRadius * j));
+        }
+    }
+
+    data.getNeighborhood()->setGridResolution(1200, 900, kernelRadius);
+    data.buildNeighborhood();
+    data.computeDensityPressure();
+
+    std::vector<Eigen::Vector2f> positions;
+    for (auto& position: data.getPositions()) {
+        positions.push_back(position.cast<float>());
+    }
+
+    std::vector<float> densities(positions.size());
+    std::vector<float> pressures(positions.size());
+    SphSolverCore2D<float> core(kernelRadius, data.getMass(), data.getViscosityConstant());
+    core.computeDensityPressure(*data.getNeighborhood(), positions, densities, pressures);
+
+    bool passed = true;
+    for (size_t i = 0; i < positions.size(); i++) {
+        double expectedDensity = data.getDensities()[i];
+        if (!(std::abs(densities[i] - expectedDensity) < ERROR_TOLERANCE * expectedDensity)) {
+            passed = false;
+        }
+    }
+
+    printResult("SphSolverCore2D float", passed);
+}
+
+/**
+ * @brief Checks the 3D variant: the 27-cell query of CellListNeighborhood3D must find the
+ * same neighbors as an all-pairs loop, and SphSolver3D must keep the particles finite and
+ * inside its box.
+ * 
+ */
+void sphSolver3DTest() {
+    const double kernelRadius = 16.0;
+    std::vector<Eigen::Vector3d> points;
+
+    srand(1);
+    for (int i = 0; i < 1000; i++) {
+        points.push_back(Eigen::Vector3d(160.0, 160.0, 160.0) + 40.0 * Eigen::Vector3d::Random());
+    }
+
+    CellListNeighborhood3D neighborhood;
+    neighborhood.setGridResolution(Eigen::Vector3d(320.0, 320.0, 320.0), kernelRadius);
+    neighborhood.setSortByIndex(true);
+    neighborhood.build(points);
+
+    bool passed = true;
+    for (size_t i = 0; i < points.size(); i++) {
+        std::vector<int> expected;
+        for (size_t j = 0; j < points.size(); j++) {
+            double r2 = (points[j] - points[i]).squaredNorm();
+            if (r2 >= EPS && r2 <= kernelRadius * kernelRadius) {
+                expected.push_back(j);
+            }
+        }
+
+        NeighborList2D neighbors = neighborhood.getNeighbors(i);
+        passed = passed && neighbors.size == (int) expected.size() &&
+            std::equal(expected.begin(), expected.end(), neighbors.indices);
+    }
+
+    srand(1);
+    SphSolver3D solver(1000);
+
+    for (int i = 0; passed && i < 200; i++) {
+        solver.update();
+
+        for (const Eigen::Vector3d& position : solver.getPositions()) {
+            passed = passed && position.allFinite() && (position.array() > 0.0).all() &&
+                position(0) < solver.getViewWidth() && position(1) < solver.getViewHeight() &&
+                position(2) < solver.getViewDepth();
+        }
+    }
+
+    printResult("SphSolver3D", passed);
+}
+
+/**
+ * @brief Writes the first updates of VSphSolver2D as a binary snapshot and checks, reading the
+ * frames backwards, that the positions match the benchmark on CSV file, that unknown fields
+ * are rejected and that reads past the frames, the fields or the particles fail.
+ * 
+ * @param testName: Name of the test printed with the result.
+ * @param queueDepth: Depth of the asynchronous output queue, 0 to write synchronously.
+ * @param outputSettings: Settings of the snapshot.
+ * @param tolerance: Largest distance of a read position to the benchmark.
+ */
+void snapshotOutputTest(const std::string& testName, int queueDepth,
+    const OutputSettings& outputSettings = OutputSettings(), double tolerance = ERROR_TOLERANCE) {
+    const std::string snapshotFileName = "VSphSolver2DTest.snap";
+    const int numberOfUpdates = 10;
+    const int numberOfFrames = numberOfUpdates / outputSettings.interval;
+    OutputSettings unknownField = outputSettings;
+    unknownField.fields.push_back("temperatures");
+    bool validSettings;
+
+    {
+        VSphSolver2D solver(50*50, snapshotFileName);
+        solver.setOutputFormat(OutputFormat::Binary);
+        validSettings = solver.setOutputSettings(outputSettings) && !solver.setOutputSettings(unknownField);
+        solver.setAsyncOutput(queueDepth);
+        for (int update = 0; update < numberOfUpdates; update++) {
+            solver.update();
+        }
+    }
+
+    // Compare the frames backwards, so each one is found by seeking instead of reading in order.
+    SnapshotReader reader(snapshotFileName);
     std::ifstream file("VSphSolver2DData.csv");
+    std::vector<CSVRow> rows;
+    for (auto& row: CSVRange(file)) {
+        if (rows.size() == numberOfUpdates) {
+            break;
+        }
+        rows.push_back(row);
+    }
+
+    bool passed = validSettings && reader.isOpen() && reader.getNumberOfFrames() == (size_t) numberOfFrames &&
+        reader.getFields().size() == outputSettings.fields.size();
+    int positionsField = reader.getFieldIndex("positions");
+
+    for (int frame = numberOfFrames - 1; passed && frame >= 0; frame--) {
+        const CSVRow& row = rows[frame * outputSettings.interval];
+
+        for (size_t i = 0; i < reader.getNumberOfParticles(); i++) {
+            Eigen::Vector2d expectedPosition = get2DVector(std::string(row[i]));
+            Eigen::Vector2d position;
+            if (!reader.getVector2d(frame, positionsField, i, position) ||
+                !((position - expectedPosition).norm() < tolerance)) {
+                passed = false;
+            }
+        }
+    }
+
+    // Values past the frames, the fields or the particles are reported instead of read.
+    double value;
+    passed = passed && !reader.getValue(numberOfFrames, positionsField, 0, 0, value) &&
+        !reader.getValue(0, reader.getFields().size(), 0, 0, value) &&
+        !reader.getValue(0, positionsField, reader.getNumberOfParticles(), 0, value);
+
+    std::remove(snapshotFileName.c_str());
+    printResult(testName, passed);
+}
+
+/**
+ * @brief Checks the vertices written for the renderer in each color mode, and that frames
+ * handed over through the triple buffer by another thread are always whole and in order.
+ * 
+ */
+void renderFramesTest() {
+    VSphSolver2D solver(500);
+
+    for (int i = 0; i < 10; i++) {
+        solver.update();
+    }
+
+    const size_t numberOfParticles = solver.getPositions().size();
+    std::vector<float> vertices(numberOfParticles * FLOATS_PER_VERTEX);
+    bool passed = writeFrame(solver, ColorMode::Uniform, vertices.data(), numberOfParticles + 10) == numberOfParticles &&
+        writeFrame(solver, ColorMode::Uniform, vertices.data(), 200) == 200;
+    writeFrame(solver, ColorMode::Uniform, vertices.data(), numberOfParticles);
+
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const float *vertex = vertices.data() + i * FLOATS_PER_VERTEX;
+        passed = passed && vertex[0] == (float) solver.getPositions()[i](0) &&
+            vertex[1] == (float) solver.getPositions()[i](1) && vertex[2] == 0.2f && vertex[4] == 1.f;
+    }
+
+    const std::vector<double>& densities = solver.getParticleSystemData()->getDensities();
+    int densest = std::max_element(densities.begin(), densities.end()) - densities.begin();
+    writeFrame(solver, ColorMode::Density, vertices.data(), numberOfParticles);
+
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        passed = passed && vertices[i * FLOATS_PER_VERTEX + 2] <= vertices[densest * FLOATS_PER_VERTEX + 2];
+    }
+
+    const std::vector<Eigen::Vector2d>& velocities = solver.getParticleSystemData()->getVelocities();
+    int fastest = std::max_element(velocities.begin(), velocities.end(),
+        [](const Eigen::Vector2d& a, const Eigen::Vector2d& b) { return a.norm() < b.norm(); }) - velocities.begin();
+    writeFrame(solver, ColorMode::Velocity, vertices.data(), numberOfParticles);
+    passed = passed && vertices[fastest * FLOATS_PER_VERTEX + 2] > 0.999f;
+
+    const int numberOfFrames = 20000;
+    FrameTripleBuffer frames;
+    std::vector<int> slots[3] = {std::vector<int>(64), std::vector<int>(64), std::vector<int>(64)};
+    std::thread producer([&]() {
+        for (int frame = 1; frame <= numberOfFrames; frame++) {
+            std::fill(slots[frames.getWriteSlot()].begin(), slots[frames.getWriteSlot()].end(), frame);
+            frames.publish();
+        }
+    });
+
+    int lastFrame = 0;
+
+    while (lastFrame < numberOfFrames) {
+        if (!frames.acquire()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const std::vector<int>& slot = slots[frames.getReadSlot()];
+        passed = passed && slot.front() > lastFrame &&
+            std::all_of(slot.begin(), slot.end(), [&](int frame) { return frame == slot.front(); });
+        lastFrame = slot.front();
+    }
+
+    producer.join();
+    printResult("GlutRenderer2D Frames", passed);
+}
+
+/**
+ * @brief Runs an ensemble of scenes with different parameters on two workers and checks that
+ * each one ends where the same scene run alone does, and that the binary output of a scene
+ * has one frame per update.
+ * 
+ */
+void ensembleRunnerTest() {
+    const std::string snapshotFileName = "ensembleRunnerTest.snap";
+    EnsembleRunner runner(2);
+    std::vector<EnsembleMember> members(5);
+
+    for (size_t i = 0; i < members.size(); i++) {
+        members[i].numberOfParticles = 200 + 100 * i;
+        members[i].numberOfUpdates = 10 + 5 * (i % 2);
+        members[i].stiffness = 0.04 + 0.02 * i;
+        members[i].surfaceTension = 0.0001 * (i + 1);
+        runner.addMember(members[i]);
+    }
+
+    members[0].fileName = snapshotFileName;
+    runner.addMember(members[0]);
+    runner.run();
+
+    bool passed = runner.getNumberOfWorkers() == 2 && runner.getNumberOfMembers() == (int) members.size() + 1;
+
+    for (size_t i = 0; passed && i < members.size(); i++) {
+        VSphSolver2D solver(members[i].numberOfParticles);
+        solver.getParticleSystemData()->setStiffness(members[i].stiffness);
+        solver.getParticleSystemData()->setSurfaceTension(members[i].surfaceTension);
+
+        for (int update = 0; update < members[i].numberOfUpdates; update++) {
+            solver.update();
+        }
+
+        const std::vector<Eigen::Vector2d>& positions = runner.getResult(i).positions;
+        passed = runner.getResult(i).finished && positions.size() == solver.getPositions().size();
+
+        for (size_t j = 0; passed && j < positions.size(); j++) {
+            passed = (positions[j] - solver.getPositions()[j]).norm() < ERROR_TOLERANCE;
+        }
+    }
+
+    SnapshotReader reader(snapshotFileName);
+    Eigen::Vector2d position;
+    passed = passed && reader.isOpen() && reader.getNumberOfFrames() == (size_t) members[0].numberOfUpdates &&
+        reader.getVector2d(reader.getNumberOfFrames() - 1, 0, 7, position) &&
+        (position - runner.getResult(0).positions[7]).norm() < ERROR_TOLERANCE;
+
+    std::remove(snapshotFileName.c_str());
+    printResult("EnsembleRunner", passed);
+}
+
+/**
+ * @brief Runs the solvers in the deterministic mode on one and on four threads. VSphSolver2D
+ * with symmetric pairs requested must still match the benchmark on four threads, and
+ * PciSphSolver2D must reproduce its positions and pressure iterations bit for bit.
+ * 
+ */
+void deterministicModeTest() {
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+
     VSphSolver2D solver(50*50);
+    solver.setSymmetricPairs(true);
+    solver.setDeterministic(true);
+    bool passed = solver.isDeterministic() && matchesBenchmark(solver, "VSphSolver2DData.csv", 20);
+
+    std::vector<Eigen::Vector2d> positions[2];
+    int pressureIterations[2] = {0, 0};
+
+    for (int run = 0; run < 2; run++) {
+        omp_set_num_threads(run == 0 ? 1 : 4);
+        srand(1);
+        PciSphSolver2D pciSolver(500);
+        pciSolver.setDeterministic(true);
 
-    for(auto& row: CSVRange(file)) {
+        for (int i = 0; i < 20; i++) {
+            pciSolver.update();
+            pressureIterations[run] += pciSolver.getPressureIterations();
+        }
+
+        positions[run] = pciSolver.getPositions();
+    }
+
+    passed = passed && positions[0] == positions[1] && pressureIterations[0] == pressureIterations[1];
+
+    double sums[2];
+    FixedOrderSum<double> fixedOrderSum;
+
+    for (int run = 0; run < 2; run++) {
+        omp_set_num_threads(run == 0 ? 1 : 3);
+        sums[run] = fixedOrderSum.sum(100000, [](size_t i) { return 1.0 / (i + 1); }, 0.0);
+    }
+
+    passed = passed && sums[0] == sums[1];
+    omp_set_num_threads(maxThreads);
+    printResult("Deterministic Mode", passed);
+}
+
+/**
+ * @brief Checks that the sampled distance field of a polygon collider stays within half a
+ * cell of the exact distance, and that fluid dropped on the polygon never enters it with the
+ * viscoelastic and the PCISPH solvers. The device solver must reject colliders, and the
+ * colliders built from invalid arguments must reject every lookup and every solver.
+ * 
+ */
+void collidersTest() {
+    const std::vector<Eigen::Vector2d> box = {{3.5, 1.0}, {4.5, 1.0}, {4.5, 1.5}, {3.5, 1.5}};
+    VSphSolver2D solver(500);
+    const double particleRadius = solver.getParticleSystemData()->getParticleRadius();
+    PolygonCollider2DPtr collider = std::make_shared<PolygonCollider2D>(box, particleRadius, 2.0 * particleRadius);
+    bool passed = true;
+
+    for (double x = 3.45; passed && x < 4.55; x += 0.0137) {
+        for (double y = 0.95; passed && y < 1.55; y += 0.0111) {
+            const Eigen::Vector2d position(x, y);
+            passed = std::abs(collider->getDistance(position) -
+                PolygonCollider2D::signedDistance(box, position)) < 0.5 * particleRadius;
+        }
+    }
+
+    double distance;
+    Eigen::Vector2d normal;
+    passed = passed && collider->lookup(Eigen::Vector2d(4.0, 1.52), distance, normal) &&
+        (normal - Eigen::Vector2d(0.0, 1.0)).norm() < ERROR_TOLERANCE &&
+        !collider->lookup(Eigen::Vector2d(5.0, 1.0), distance, normal);
+
+    const std::vector<SdfCollider2DPtr> invalidColliders = {
+        std::make_shared<SdfCollider2D>(Eigen::Vector2d(0.0, 0.0), 0.1, 1, 4, std::vector<double>(4, -1.0)),
+        std::make_shared<SdfCollider2D>(Eigen::Vector2d(0.0, 0.0), 0.1, 2, 2, std::vector<double>(3, -1.0)),
+        std::make_shared<SdfCollider2D>(Eigen::Vector2d(0.0, 0.0), 0.0, 2, 2, std::vector<double>(4, -1.0)),
+        std::make_shared<PolygonCollider2D>(std::vector<Eigen::Vector2d>(), particleRadius, 2.0 * particleRadius),
+        std::make_shared<PolygonCollider2D>(box, 0.0, 2.0 * particleRadius)};
+    passed = passed && collider->isValid() && !solver.addCollider(nullptr);
+
+    for (const SdfCollider2DPtr& invalidCollider : invalidColliders) {
+        passed = passed && !invalidCollider->isValid() && !solver.addCollider(invalidCollider) &&
+            !invalidCollider->lookup(Eigen::Vector2d(0.0, 0.0), distance, normal);
+    }
+
+    // The PCISPH scene is in pixels, so its obstacle sits on the floor where the block collapses.
+    const std::vector<Eigen::Vector2d> pciBox = {{500.0, 0.0}, {600.0, 0.0}, {600.0, 60.0}, {500.0, 60.0}};
+    PciSphSolver2D pciSolver(500);
+    const double pciParticleRadius = pciSolver.getParticleSystemData()->getParticleRadius();
+    PolygonCollider2DPtr pciCollider = std::make_shared<PolygonCollider2D>(pciBox, pciParticleRadius,
+        0.5 * pciParticleRadius);
+    DeviceVSphSolver2D deviceSolver(500);
+    passed = passed && solver.addCollider(collider) && pciSolver.addCollider(pciCollider) &&
+        !deviceSolver.addCollider(collider);
+
+    for (int i = 0; passed && i < 150; i++) {
         solver.update();
-        auto positions = solver.getPositions();
+        pciSolver.update();
 
-        for (int i = 0; i < positions.size(); i++) {
-            Eigen::Vector2d position = positions[i];
-            std::string expectedPositionStr = std::string(row[i]);
-            Eigen::Vector2d expectedPosition = get2DVector(expectedPositionStr);
+        for (const Eigen::Vector2d& position : solver.getPositions()) {
+            passed = passed && PolygonCollider2D::signedDistance(box, position) > 0.0;
+        }
 
-            if (!((position - expectedPosition).norm() < ERROR_TOLERANCE)) {
-                std::cout << "VSphSolver2D Test: FAILED!" << std::endl;
-                return;
-            }   
+        for (const Eigen::Vector2d& position : pciSolver.getPositions()) {
+            passed = passed && PolygonCollider2D::signedDistance(pciBox, position) > 0.0;
         }
     }
 
-    std::cout << "VSphSolver2D Test: PASSED!" << std::endl;
+    printResult("Colliders", passed);
+}
+
+/**
+ * @brief Streams the benchmark CSV and a delta compressed binary recording of the same run in
+ * parallel, and checks both against the rows parsed by CSVRow, frame by frame and backwards.
+ * 
+ */
+void recordingReaderTest() {
+    const std::string snapshotFileName = "recordingReaderTest.snap";
+    const int numberOfUpdates = 10;
+    const int maxThreads = omp_get_max_threads();
+
+    {
+        OutputSettings outputSettings;
+        outputSettings.compression = SnapshotCompression::Delta;
+        outputSettings.keyframeInterval = 4;
+        VSphSolver2D solver(50*50, snapshotFileName);
+        solver.setOutputFormat(OutputFormat::Binary);
+        solver.setOutputSettings(outputSettings);
+        for (int update = 0; update < numberOfUpdates; update++) {
+            solver.update();
+        }
+    }
+
+    std::ifstream file("VSphSolver2DData.csv");
+    std::vector<std::vector<Eigen::Vector2d>> rows;
+    for (auto& row: CSVRange(file)) {
+        if (rows.size() == numberOfUpdates) {
+            break;
+        }
+
+        rows.emplace_back();
+        for (size_t i = 0; i < row.size(); i++) {
+            rows.back().push_back(get2DVector(std::string(row[i])));
+        }
+    }
+
+    omp_set_num_threads(3);
+    RecordingReader csvReader("VSphSolver2DData.csv");
+    RecordingReader binaryReader(snapshotFileName);
+    bool passed = csvReader.isOpen() && csvReader.getFormat() == RecordingFormat::Csv &&
+        csvReader.getNumberOfFrames() == 500 && csvReader.getNumberOfParticles() == 50*50 &&
+        binaryReader.isOpen() && binaryReader.getFormat() == RecordingFormat::Binary &&
+        binaryReader.getNumberOfFrames() == numberOfUpdates;
+
+    std::vector<int> csvMatches(numberOfUpdates, 0), binaryMatches(numberOfUpdates, 0);
+
+    passed = passed && csvReader.forEachFrame([&](size_t frame, const std::vector<Eigen::Vector2d>& positions) {
+        csvMatches[frame] = positions == rows[frame];
+    }, 0, numberOfUpdates);
+
+    passed = passed && binaryReader.forEachFrame([&](size_t frame, const std::vector<Eigen::Vector2d>& positions) {
+        bool matches = positions.size() == rows[frame].size();
+        for (size_t i = 0; matches && i < positions.size(); i++) {
+            matches = (positions[i] - rows[frame][i]).norm() < ERROR_TOLERANCE;
+        }
+        binaryMatches[frame] = matches;
+    });
+
+    omp_set_num_threads(maxThreads);
+    passed = passed && std::count(csvMatches.begin(), csvMatches.end(), 1) == numberOfUpdates &&
+        std::count(binaryMatches.begin(), binaryMatches.end(), 1) == numberOfUpdates;
+
+    std::vector<Eigen::Vector2d> csvPositions, binaryPositions;
+    for (int frame = numberOfUpdates - 1; passed && frame >= 0; frame -= 3) {
+        passed = csvReader.readPositions(frame, csvPositions) && binaryReader.readPositions(frame, binaryPositions) &&
+            csvPositions == rows[frame] && (binaryPositions[7] - rows[frame][7]).norm() < ERROR_TOLERANCE;
+    }
+
+    passed = passed && !csvReader.readPositions(500, csvPositions) && csvPositions.empty();
+    std::remove(snapshotFileName.c_str());
+
+    // Single and half precision fields are converted whole, and must match the values read
+    // one by one.
+    for (SnapshotPrecision precision : {SnapshotPrecision::Single, SnapshotPrecision::Half}) {
+        {
+            OutputSettings outputSettings;
+            outputSettings.precision = precision;
+            VSphSolver2D solver(20*20, snapshotFileName);
+            solver.setOutputFormat(OutputFormat::Binary);
+            solver.setOutputSettings(outputSettings);
+            for (int update = 0; update < 3; update++) {
+                solver.update();
+            }
+        }
+
+        RecordingReader reader(snapshotFileName);
+        SnapshotReader snapshotReader(snapshotFileName);
+        passed = passed && reader.isOpen() && reader.getNumberOfFrames() == 3;
+
+        for (size_t frame = 0; passed && frame < reader.getNumberOfFrames(); frame++) {
+            passed = reader.readPositions(frame, binaryPositions) && binaryPositions.size() == 20*20;
+            for (size_t i = 0; passed && i < binaryPositions.size(); i++) {
+                Eigen::Vector2d position;
+                passed = snapshotReader.getVector2d(frame, snapshotReader.getFieldIndex("positions"), i, position) && position == binaryPositions[i];
+            }
+        }
+
+        std::remove(snapshotFileName.c_str());
+    }
+
+    printResult("RecordingReader", passed);
+}
+
+/**
+ * @brief Checks that the solvers restore the schedule of the caller after each update.
+ * 
+ */
+void loopScheduleTest() {
+    omp_sched_t kind;
+    int chunkSize;
+    omp_get_schedule(&kind, &chunkSize);
+    omp_set_schedule(omp_sched_static, 7);
+
+    VSphSolver2D solver(500);
+    solver.setLoopSchedule(LoopSchedule::Guided, 4);
+    solver.update();
+
+    omp_sched_t updatedKind;
+    int updatedChunkSize;
+    omp_get_schedule(&updatedKind, &updatedChunkSize);
+    omp_set_schedule(kind, chunkSize);
+    printResult("Loop Schedule", updatedKind == omp_sched_static && updatedChunkSize == 7);
+}
+
+/**
+ * @brief Checks that sorting the particles orders the cells at negative coordinates, and
+ * that a particle at an infinite coordinate is sorted after the finite ones.
+ * 
+ */
+void mortonOrderTest() {
+    SphParticleSystemData2D particleSystemData;
+    const double kernelRadius = particleSystemData.getKernelRadius();
+    particleSystemData.addParticle(Eigen::Vector2d(std::numeric_limits<double>::infinity(), 0.0));
+    for (int i = 1; i <= 4; i++) {
+        particleSystemData.addParticle(Eigen::Vector2d(-1.5 * i * kernelRadius, 0.0));
+    }
+
+    particleSystemData.sortParticles();
+    const std::vector<Eigen::Vector2d>& positions = particleSystemData.getPositions();
+    bool passed = particleSystemData.isReordered() && std::isinf(positions[4](0));
+
+    for (size_t i = 1; i < 4; i++) {
+        passed = passed && positions[i - 1](0) < positions[i](0);
+    }
+
+    printResult("Morton Order", passed);
 }
 
 int main(int argc, char **argv) {
     sphSolver2DTest();
     vSphSolver2DTest();
+    cellListNeighborhood2DTest();
+    hashNeighborhood2DTest();
+    symmetricPairsTest();
+    verletNeighborhood2DTest();
+    checkpointTest();
+    solverStatsTest();
+    gridNeighborhoodCapacityTest();
+    emittersAndSinksTest();
+    mixedPrecisionTest();
+    adaptiveTimeStepTest();
+    deviceVSphSolver2DTest();
+    deviceCheckpointTest();
+    pciSphSolver2DTest();
+    floatSolverCore2DTest();
+    sphSolver3DTest();
+    snapshotOutputTest("VSphSolver2D Binary Snapshot", 0);
+    snapshotOutputTest("VSphSolver2D Async Binary Snapshot", 2);
+
+    OutputSettings compressedOutput;
+    compressedOutput.fields = {"positions", "velocities", "densities"};
+    compressedOutput.interval = 2;
+    compressedOutput.precision = SnapshotPrecision::Single;
+    compressedOutput.compression = SnapshotCompression::Delta;
+    compressedOutput.keyframeInterval = 3;
+    snapshotOutputTest("VSphSolver2D Compressed Binary Snapshot", 0, compressedOutput, 1e-4);
+    renderFramesTest();
+    ensembleRunnerTest();
+    deterministicModeTest();
+    collidersTest();
+    recordingReaderTest();
+    loopScheduleTest();
+    mortonOrderTest();
     return 0;
 }
\ No newline at end of file
@@ -1,2 +1,2 @@
-g++ -fdiagnostics-color=always -g -D TEST -std=c++2a solversTest.cpp ../../src/*.cpp -o ../../out/solversTest -lglut -lGL -fopenmp
+g++ -fdiagnostics-color=always -O2 -g -std=c++2a solversTest.cpp ../../src/*.cpp -o ../../out/solversTest -lglut -lGL -fopenmp
 ../../out/solversTest
\ No newline at end of file
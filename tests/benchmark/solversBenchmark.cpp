@@ -0,0 +1,410 @@
+/**
+ * @file solversBenchmark.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the headless benchmark for the 2D Solvers. Sweeps solvers, particle
+ * counts, thread counts and neighborhoods, and reports the throughput and the time of each
+ * phase of the updates as JSON or CSV.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../../include/SphSolver2D.h"
+#include "../../include/VSphSolver2D.h"
+#include "../../include/PciSphSolver2D.h"
+#include "../../include/DeviceVSphSolver2D.h"
+#include "../../include/EnsembleRunner.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <omp.h>
+
+#ifndef SPH_INSTRUMENTATION
+    #error "The benchmark reads the phase timings of the solvers: compile with -D SPH_INSTRUMENTATION."
+#endif
+
+/**
+ * @brief Struct describing the sweep requested on the command line.
+ * 
+ */
+struct BenchmarkSettings {
+    std::vector<std::string> solvers = {"sph", "vsph"};
+    std::vector<int> particles = {1000, 2500, 5000};
+    std::vector<int> threads = {1};
+    std::vector<std::string> neighborhoods = {"grid", "celllist"};
+    std::string output = "none";
+    std::string timeStep = "fixed";
+    std::string format = "json";
+    std::string outputFileName = "";
+    int warmup = 10;
+    int steps = 100;
+    int members = 8;
+};
+
+/**
+ * @brief Struct describing the result of one configuration of the sweep.
+ * 
+ */
+struct BenchmarkResult {
+    std::string solver;
+    std::string neighborhood;
+    int requestedParticles;
+    int particles;
+    int particlesOutsideView;
+    int threads;
+    int steps;
+    double seconds;
+    SolverStats stats;
+};
+
+/**
+ * @brief Splits a comma separated list.
+ * 
+ * @param list: The list to be split.
+ * @return std::vector<std::string> representing the items of the list.
+ */
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        if (item != "") {
+            items.push_back(item);
+        }
+    }
+
+    return items;
+}
+
+/**
+ * @brief Splits a comma separated list of integers.
+ * 
+ * @param list: The list to be split.
+ * @return std::vector<int> representing the items of the list.
+ */
+std::vector<int> splitIntegers(const std::string& list) {
+    std::vector<int> items;
+
+    for (const std::string& item : split(list)) {
+        items.push_back(std::atoi(item.c_str()));
+    }
+
+    return items;
+}
+
+/**
+ * @brief Prints the usage of the benchmark.
+ * 
+ */
+void printUsage() {
+    std::cerr << "Usage: solversBenchmark [options]\n"
+        << "  --solvers sph,vsph,pcisph    solvers to run, devicevsph for the offload device\n"
+        << "                               and ensemble for independent vsph scenes, one per thread\n"
+        << "  --particles 1000,2500,5000   requested particle counts, such as 1000,10000,200000. The sph\n"
+        << "                               scene holds at most 1026 particles, and the blocks of the vsph\n"
+        << "                               and pcisph scenes leave the view beyond about 3000 and 12500\n"
+        << "  --threads 1,2,4              OpenMP thread counts\n"
+        << "  --neighborhoods grid,celllist,hash\n"
+        << "  --warmup 10                  updates run before timing\n"
+        << "  --steps 100                  updates timed\n"
+        << "  --members 8                  scenes of the ensemble solver\n"
+        << "  --output none|csv|binary     simulation output written while timing\n"
+        << "  --time-step fixed|adaptive   solver steps of the vsph updates\n"
+        << "  --format json|csv            format of the report\n"
+        << "  --file name                  file that receives the report, stdout by default\n";
+}
+
+/**
+ * @brief Reads the sweep from the command line.
+ * 
+ * @param argc: Number of arguments.
+ * @param argv: The arguments.
+ * @param settings: The settings that receive the sweep.
+ * @return true if every argument was valid.
+ * @return false otherwise.
+ */
+bool parseArguments(int argc, char **argv, BenchmarkSettings& settings) {
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+
+        if (option == "--help" || i + 1 == argc) {
+            return false;
+        }
+
+        const std::string value = argv[++i];
+
+        if (option == "--solvers") {
+            settings.solvers = split(value);
+        } else if (option == "--particles") {
+            settings.particles = splitIntegers(value);
+        } else if (option == "--threads") {
+            settings.threads = splitIntegers(value);
+        } else if (option == "--neighborhoods") {
+            settings.neighborhoods = split(value);
+        } else if (option == "--warmup") {
+            settings.warmup = std::atoi(value.c_str());
+        } else if (option == "--steps") {
+            settings.steps = std::atoi(value.c_str());
+        } else if (option == "--members") {
+            settings.members = std::atoi(value.c_str());
+        } else if (option == "--output") {
+            settings.output = value;
+        } else if (option == "--time-step") {
+            settings.timeStep = value;
+        } else if (option == "--format") {
+            settings.format = value;
+        } else if (option == "--file") {
+            settings.outputFileName = value;
+        } else {
+            return false;
+        }
+    }
+
+    return settings.steps > 0 && settings.members > 0;
+}
+
+/**
+ * @brief Runs an ensemble of independent VSphSolver2D scenes, one per worker thread, and
+ * measures the updates of all of them together. The neighborhoods and the phase timings are
+ * not used.
+ * 
+ * @param settings: The sweep.
+ * @param particles: Requested number of particles of each scene.
+ * @param threads: Number of scenes run at the same time.
+ * @return BenchmarkResult representing the measurements.
+ */
+BenchmarkResult runEnsemble(const BenchmarkSettings& settings, int particles, int threads) {
+    EnsembleRunner runner(threads);
+    EnsembleMember member;
+    member.numberOfParticles = particles;
+    member.numberOfUpdates = settings.warmup + settings.steps;
+    member.timeStepSettings.adaptive = settings.timeStep == "adaptive";
+
+    for (int i = 0; i < settings.members; i++) {
+        runner.addMember(member);
+    }
+
+    const double start = omp_get_wtime();
+    runner.run();
+
+    BenchmarkResult result;
+    result.seconds = omp_get_wtime() - start;
+    result.solver = "ensemble";
+    result.neighborhood = "grid";
+    result.requestedParticles = particles;
+    result.particles = runner.getResult(0).positions.size();
+    result.particlesOutsideView = 0;
+    result.threads = threads;
+    result.steps = settings.members * member.numberOfUpdates;
+    return result;
+}
+
+/**
+ * @brief Runs one configuration of the sweep.
+ * 
+ * @param settings: The sweep.
+ * @param solverName: Name of the solver, sph, vsph, devicevsph or pcisph.
+ * @param neighborhoodName: Name of the neighborhood, grid, celllist or hash.
+ * @param particles: Requested number of particles.
+ * @param threads: Number of OpenMP threads.
+ * @return BenchmarkResult representing the measurements.
+ */
+BenchmarkResult run(const BenchmarkSettings& settings, const std::string& solverName,
+    const std::string& neighborhoodName, int particles, int threads) {
+    if (solverName == "ensemble") {
+        return runEnsemble(settings, particles, threads);
+    }
+
+    NeighborhoodType neighborhoodType = NeighborhoodType::Grid;
+    if (neighborhoodName == "celllist") {
+        neighborhoodType = NeighborhoodType::CellList;
+    } else if (neighborhoodName == "hash") {
+        neighborhoodType = NeighborhoodType::Hash;
+    }
+    const std::string simulationFileName = settings.output == "none" ? "" : "solversBenchmark.out";
+
+    omp_set_num_threads(threads);
+    srand(1);
+
+    SphSolver2DPtr solver;
+    if (solverName == "vsph" || solverName == "devicevsph") {
+        VSphSolver2DPtr vsphSolver = solverName == "vsph" ?
+            std::make_shared<VSphSolver2D>(particles, simulationFileName, neighborhoodType) :
+            std::make_shared<DeviceVSphSolver2D>(particles, simulationFileName);
+        TimeStepSettings timeStepSettings;
+        timeStepSettings.adaptive = settings.timeStep == "adaptive";
+        vsphSolver->setTimeStepSettings(timeStepSettings);
+        solver = vsphSolver;
+    } else if (solverName == "pcisph") {
+        solver = std::make_shared<PciSphSolver2D>(particles, simulationFileName, neighborhoodType);
+    } else {
+        solver = std::make_shared<SphSolver2D>(particles, simulationFileName, neighborhoodType);
+    }
+
+    if (settings.output == "binary") {
+        solver->setOutputFormat(OutputFormat::Binary);
+    }
+
+    // The grids clamp the particles outside the view into their border cells, so their
+    // neighbor searches grow with the number of particles outside.
+    int particlesOutsideView = 0;
+    for (const Eigen::Vector2d& position : solver->getPositions()) {
+        if (position(0) < 0.0 || position(0) > solver->getViewWidth() ||
+            position(1) < 0.0 || position(1) > solver->getViewHeight()) {
+            particlesOutsideView++;
+        }
+    }
+
+    for (int i = 0; i < settings.warmup; i++) {
+        solver->update();
+    }
+
+    solver->resetStats();
+    const double start = omp_get_wtime();
+
+    for (int i = 0; i < settings.steps; i++) {
+        solver->update();
+    }
+
+    BenchmarkResult result;
+    result.seconds = omp_get_wtime() - start;
+    result.solver = solverName;
+    result.neighborhood = neighborhoodName;
+    result.requestedParticles = particles;
+    result.particles = solver->getPositions().size();
+    result.particlesOutsideView = particlesOutsideView;
+    result.threads = threads;
+    result.steps = settings.steps;
+    result.stats = solver->getStats();
+
+    solver.reset();
+    if (simulationFileName != "") {
+        std::remove(simulationFileName.c_str());
+    }
+
+    return result;
+}
+
+/**
+ * @brief Writes the results as a JSON array, one object per configuration.
+ * 
+ * @param stream: The stream to write to.
+ * @param results: The results.
+ */
+void writeJson(std::ostream& stream, const std::vector<BenchmarkResult>& results) {
+    stream << "[\n";
+
+    for (size_t k = 0; k < results.size(); k++) {
+        const BenchmarkResult& result = results[k];
+        const PhaseTimings& timings = result.stats.timings;
+
+        stream << "  {\"solver\": \"" << result.solver << "\", "
+            << "\"neighborhood\": \"" << result.neighborhood << "\", "
+            << "\"requested_particles\": " << result.requestedParticles << ", "
+            << "\"particles\": " << result.particles << ", "
+            << "\"particles_outside_view\": " << result.particlesOutsideView << ", "
+            << "\"threads\": " << result.threads << ", "
+            << "\"steps\": " << result.steps << ", "
+            << "\"seconds\": " << result.seconds << ", "
+            << "\"steps_per_second\": " << result.steps / result.seconds << ", "
+            << "\"particle_updates_per_second\": " << result.steps * result.particles / result.seconds << ", "
+            << "\"phases\": {"
+            << "\"neighbor_build\": " << timings.neighborBuild << ", "
+            << "\"density_pressure\": " << timings.densityPressure << ", "
+            << "\"forces\": " << timings.forces << ", "
+            << "\"integrate\": " << timings.integrate << ", "
+            << "\"boundary\": " << timings.boundary << ", "
+            << "\"output\": " << timings.output << "}, "
+            << "\"average_neighbors\": " << result.stats.averageNeighbors() << ", "
+            << "\"truncated_neighborhoods\": " << result.stats.truncatedNeighborhoods << ", "
+            << "\"neighbor_rebuilds\": " << result.stats.neighborRebuilds << ", "
+            << "\"solver_steps_per_update\": " << (double) result.stats.solverSteps / result.steps << ", "
+            << "\"pressure_iterations_per_step\": " << (result.stats.solverSteps > 0 ?
+                (double) result.stats.pressureIterations / result.stats.solverSteps : 0.0) << ", "
+            << "\"max_density_error\": " << result.stats.maxDensityError << "}"
+            << (k + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    stream << "]\n";
+}
+
+/**
+ * @brief Writes the results as CSV, with a header row and one row per configuration.
+ * 
+ * @param stream: The stream to write to.
+ * @param results: The results.
+ */
+void writeCsv(std::ostream& stream, const std::vector<BenchmarkResult>& results) {
+    stream << "solver,neighborhood,requested_particles,particles,particles_outside_view,threads,steps,seconds,"
+        << "steps_per_second,particle_updates_per_second,neighbor_build,density_pressure,"
+        << "forces,integrate,boundary,output,average_neighbors,truncated_neighborhoods,"
+        << "neighbor_rebuilds,solver_steps_per_update,pressure_iterations_per_step,max_density_error\n";
+
+    for (const BenchmarkResult& result : results) {
+        const PhaseTimings& timings = result.stats.timings;
+
+        stream << result.solver << "," << result.neighborhood << "," << result.requestedParticles << ","
+            << result.particles << "," << result.particlesOutsideView << "," << result.threads << ","
+            << result.steps << ","
+            << result.seconds << "," << result.steps / result.seconds << ","
+            << result.steps * result.particles / result.seconds << ","
+            << timings.neighborBuild << "," << timings.densityPressure << "," << timings.forces << ","
+            << timings.integrate << "," << timings.boundary << "," << timings.output << ","
+            << result.stats.averageNeighbors() << "," << result.stats.truncatedNeighborhoods << ","
+            << result.stats.neighborRebuilds << "," << (double) result.stats.solverSteps / result.steps << ","
+            << (result.stats.solverSteps > 0 ? (double) result.stats.pressureIterations / result.stats.solverSteps : 0.0) << ","
+            << result.stats.maxDensityError << "\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    BenchmarkSettings settings;
+
+    if (!parseArguments(argc, argv, settings)) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+
+    for (const std::string& solver : settings.solvers) {
+        for (const std::string& neighborhood : settings.neighborhoods) {
+            for (int particles : settings.particles) {
+                for (int threads : settings.threads) {
+                    results.push_back(run(settings, solver, neighborhood, particles, threads));
+                    std::cerr << solver << " " << neighborhood << " " << results.back().particles
+                        << " particles, " << threads << " threads: "
+                        << results.back().steps / results.back().seconds << " steps/s" << std::endl;
+
+                    if (results.back().particlesOutsideView > 0) {
+                        std::cerr << "  " << results.back().particlesOutsideView
+                            << " particles started outside the view" << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (settings.outputFileName != "") {
+        file.open(settings.outputFileName);
+    }
+    std::ostream& stream = settings.outputFileName != "" ? file : std::cout;
+
+    if (settings.format == "csv") {
+        writeCsv(stream, results);
+    } else {
+        writeJson(stream, results);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,2 @@
+g++ -fdiagnostics-color=always -O3 -march=native -std=c++2a -D SPH_INSTRUMENTATION solversBenchmark.cpp ../../src/*.cpp -o ../../out/solversBenchmark -lglut -lGL -fopenmp
+../../out/solversBenchmark "$@"
\ No newline at end of file
@@ -0,0 +1,27 @@
+/**
+ * @file VSphSolver2DVertexBufferRenderTest.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the manual test for the VSphSolver2D drawn from a vertex buffer,
+ * with the solver on its own thread.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../../include/VSphSolver2D.h"
+#include "../../include/GlutRenderer2D.h"
+
+int main(int argc, char **argv) {
+	RenderSettings settings;
+	settings.vertexBuffer = true;
+	settings.solverThread = true;
+	settings.colorMode = ColorMode::Velocity;
+
+	setRenderSettings(settings);
+	setSolver(std::make_shared<VSphSolver2D>(100*100));
+	loop(argc, argv);
+
+	return 0;
+}
\ No newline at end of file
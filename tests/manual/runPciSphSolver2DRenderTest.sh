@@ -0,0 +1,2 @@
+g++ -fdiagnostics-color=always -g -std=c++2a PciSphSolver2DRenderTest.cpp ../../src/*.cpp -o ../../out/PciSphSolver2DRenderTest -lglut -lGL -fopenmp
+../../out/PciSphSolver2DRenderTest
\ No newline at end of file
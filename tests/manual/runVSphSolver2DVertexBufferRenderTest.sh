@@ -0,0 +1,2 @@
+g++ -fdiagnostics-color=always -g -std=c++2a VSphSolver2DVertexBufferRenderTest.cpp ../../src/*.cpp -o ../../out/VSphSolver2DVertexBufferRenderTest -lglut -lGL -fopenmp
+../../out/VSphSolver2DVertexBufferRenderTest
\ No newline at end of file
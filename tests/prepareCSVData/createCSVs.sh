@@ -1,2 +1,2 @@
-g++ -fdiagnostics-color=always -g -D TEST -std=c++2a prepareCSVs.cpp ../../src/*.cpp -o ../../out/prepareCSVs -lglut -lGL -fopenmp
+g++ -fdiagnostics-color=always -g -std=c++2a prepareCSVs.cpp ../../src/*.cpp -o ../../out/prepareCSVs -lglut -lGL -fopenmp
 ../../out/prepareCSVs
\ No newline at end of file
@@ -35,6 +35,24 @@ void createSphSolver2DCsvData() {
     std::cout << "SphSolver2DData.csv created." << std::endl;
 }
 
+/**
+ * @brief Creates a CSV file with the benchmark data for SphSolver2D in mixed precision.
+ * 
+ */
+void createSphSolver2DMixedCsvData() {
+    srand(1);
+    SphSolver2D solver(500, "../automated/SphSolver2DMixedData.csv");
+    solver.setPrecision(SolverPrecision::Mixed);
+
+    std::cout << "Creating CSV data for SphSolver2D in mixed precision..." << std::endl;
+
+    for (int i = 0; i < NUMBER_OF_ITERATIONS; i++) {
+        solver.update();
+    }
+
+    std::cout << "SphSolver2DMixedData.csv created." << std::endl;
+}
+
 /**
  * @brief Creates a CSV file with the benchmark data for VSphSolver2D.
  * 
@@ -53,6 +71,7 @@ void createVSphSolver2DCsvData() {
 
 int main(int argc, char **argv) {
     createSphSolver2DCsvData();
+    createSphSolver2DMixedCsvData();
     createVSphSolver2DCsvData();
     
     return 0;
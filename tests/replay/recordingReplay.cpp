@@ -0,0 +1,259 @@
+/**
+ * @file recordingReplay.cpp
+ * @author Matheus Kerber Veturelli (matheuskveturelli@gmail.com)
+ * @brief Implementation of the replay tool for recorded runs. Streams the frames of a CSV or
+ * binary snapshot recording in parallel and reports the particle count, centroid and bounding
+ * box of each frame as CSV or JSON.
+ * @version 1.0
+ * @date 2022-06-17
+ * 
+ * @copyright MIT License 2022
+ * 
+ */
+
+#include "../../include/RecordingReader.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <omp.h>
+
+/**
+ * @brief Struct describing the replay requested on the command line.
+ * 
+ */
+struct ReplaySettings {
+    std::string recordingFileName = "";
+    std::string format = "csv";
+    std::string outputFileName = "";
+    size_t first = 0;
+    size_t last = SIZE_MAX;
+    size_t stride = 1;
+    int threads = 0;
+};
+
+/**
+ * @brief Struct describing the summary of one frame.
+ * 
+ */
+struct FrameSummary {
+    size_t frame = 0;
+    size_t particles = 0;
+    Eigen::Vector2d centroid = Eigen::Vector2d::Zero();
+    Eigen::Vector2d min = Eigen::Vector2d::Zero();
+    Eigen::Vector2d max = Eigen::Vector2d::Zero();
+};
+
+/**
+ * @brief Prints the usage of the replay tool.
+ * 
+ */
+void printUsage() {
+    std::cerr << "Usage: recordingReplay --recording name [options]\n"
+        << "  --recording name             CSV or binary snapshot file of the run\n"
+        << "  --first 0                    first frame replayed\n"
+        << "  --last 100                   frame after the last one replayed, every frame by default\n"
+        << "  --stride 1                   distance between two replayed frames\n"
+        << "  --threads 4                  OpenMP threads decoding frames, every hardware thread by default\n"
+        << "  --format csv|json            format of the report\n"
+        << "  --file name                  file that receives the report, stdout by default\n";
+}
+
+/**
+ * @brief Parses a whole argument as a number.
+ * 
+ * @tparam T: integer type of the number.
+ * @param value: The argument.
+ * @param number: Receives the number.
+ * @return true if the argument is a number of type T and nothing else.
+ * @return false otherwise.
+ */
+template <typename T>
+bool parseNumber(const std::string& value, T& number) {
+    const char *end = value.data() + value.size();
+    const std::from_chars_result result = std::from_chars(value.data(), end, number);
+    return !value.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * @brief Reads the replay from the command line.
+ * 
+ * @param argc: Number of arguments.
+ * @param argv: The arguments.
+ * @param settings: The settings that receive the replay.
+ * @return true if every argument was valid.
+ * @return false otherwise.
+ */
+bool parseArguments(int argc, char **argv, ReplaySettings& settings) {
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+
+        if (option == "--help" || i + 1 == argc) {
+            return false;
+        }
+
+        const std::string value = argv[++i];
+
+        if (option == "--recording") {
+            settings.recordingFileName = value;
+        } else if (option == "--first") {
+            if (!parseNumber(value, settings.first)) {
+                return false;
+            }
+        } else if (option == "--last") {
+            if (!parseNumber(value, settings.last)) {
+                return false;
+            }
+        } else if (option == "--stride") {
+            if (!parseNumber(value, settings.stride)) {
+                return false;
+            }
+        } else if (option == "--threads") {
+            if (!parseNumber(value, settings.threads)) {
+                return false;
+            }
+        } else if (option == "--format") {
+            if (value != "csv" && value != "json") {
+                return false;
+            }
+            settings.format = value;
+        } else if (option == "--file") {
+            settings.outputFileName = value;
+        } else {
+            return false;
+        }
+    }
+
+    return settings.recordingFileName != "" && settings.stride > 0;
+}
+
+/**
+ * @brief Summarizes the positions of one frame.
+ * 
+ * @param frame: Index of the frame.
+ * @param positions: The positions of the frame.
+ * @return FrameSummary representing the summary.
+ */
+FrameSummary summarize(size_t frame, const std::vector<Eigen::Vector2d>& positions) {
+    FrameSummary summary;
+    summary.frame = frame;
+    summary.particles = positions.size();
+
+    if (positions.empty()) {
+        return summary;
+    }
+
+    summary.min = Eigen::Vector2d::Constant(std::numeric_limits<double>::max());
+    summary.max = Eigen::Vector2d::Constant(std::numeric_limits<double>::lowest());
+
+    for (const Eigen::Vector2d& position : positions) {
+        summary.centroid += position;
+        summary.min = summary.min.cwiseMin(position);
+        summary.max = summary.max.cwiseMax(position);
+    }
+
+    summary.centroid /= positions.size();
+    return summary;
+}
+
+/**
+ * @brief Writes the summaries as a JSON array, one object per frame.
+ * 
+ * @param stream: The stream to write to.
+ * @param summaries: The summaries.
+ */
+void writeJson(std::ostream& stream, const std::vector<FrameSummary>& summaries) {
+    stream << "[\n";
+
+    for (size_t k = 0; k < summaries.size(); k++) {
+        const FrameSummary& summary = summaries[k];
+
+        stream << "  {\"frame\": " << summary.frame << ", "
+            << "\"particles\": " << summary.particles << ", "
+            << "\"centroid\": [" << summary.centroid(0) << ", " << summary.centroid(1) << "], "
+            << "\"min\": [" << summary.min(0) << ", " << summary.min(1) << "], "
+            << "\"max\": [" << summary.max(0) << ", " << summary.max(1) << "]}"
+            << (k + 1 < summaries.size() ? "," : "") << "\n";
+    }
+
+    stream << "]\n";
+}
+
+/**
+ * @brief Writes the summaries as CSV, with a header row and one row per frame.
+ * 
+ * @param stream: The stream to write to.
+ * @param summaries: The summaries.
+ */
+void writeCsv(std::ostream& stream, const std::vector<FrameSummary>& summaries) {
+    stream << "frame,particles,centroid_x,centroid_y,min_x,min_y,max_x,max_y\n";
+
+    for (const FrameSummary& summary : summaries) {
+        stream << summary.frame << "," << summary.particles << ","
+            << summary.centroid(0) << "," << summary.centroid(1) << ","
+            << summary.min(0) << "," << summary.min(1) << ","
+            << summary.max(0) << "," << summary.max(1) << "\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    ReplaySettings settings;
+
+    if (!parseArguments(argc, argv, settings)) {
+        printUsage();
+        return 1;
+    }
+
+    if (settings.threads > 0) {
+        omp_set_num_threads(settings.threads);
+    }
+
+    const double start = omp_get_wtime();
+    RecordingReader reader(settings.recordingFileName);
+
+    if (!reader.isOpen()) {
+        std::cerr << "Could not read " << settings.recordingFileName << std::endl;
+        return 1;
+    }
+
+    const size_t last = std::min(settings.last, reader.getNumberOfFrames());
+    const size_t count = settings.first < last ? (last - settings.first + settings.stride - 1) / settings.stride : 0;
+    std::vector<FrameSummary> summaries(count);
+
+    // Each frame writes only its own summary, so the visitor needs no synchronization.
+    const bool valid = reader.forEachFrame([&](size_t frame, const std::vector<Eigen::Vector2d>& positions) {
+        summaries[(frame - settings.first) / settings.stride] = summarize(frame, positions);
+    }, settings.first, last, settings.stride);
+
+    const double seconds = omp_get_wtime() - start;
+    size_t particles = 0;
+    for (const FrameSummary& summary : summaries) {
+        particles += summary.particles;
+    }
+
+    std::cerr << (reader.getFormat() == RecordingFormat::Csv ? "csv" : "binary") << " recording, "
+        << reader.getNumberOfFrames() << " frames: replayed " << count << " frames in " << seconds << " s, "
+        << particles / seconds << " particles/s" << std::endl;
+
+    if (!valid) {
+        std::cerr << "Some frames could not be read" << std::endl;
+    }
+
+    std::ofstream file;
+    if (settings.outputFileName != "") {
+        file.open(settings.outputFileName);
+    }
+    std::ostream& stream = settings.outputFileName != "" ? file : std::cout;
+
+    if (settings.format == "json") {
+        writeJson(stream, summaries);
+    } else {
+        writeCsv(stream, summaries);
+    }
+
+    return valid ? 0 : 1;
+}
\ No newline at end of file
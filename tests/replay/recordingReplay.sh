@@ -0,0 +1,2 @@
+g++ -fdiagnostics-color=always -O3 -march=native -std=c++2a recordingReplay.cpp -o ../../out/recordingReplay -fopenmp
+../../out/recordingReplay "$@"
\ No newline at end of file